@@ -0,0 +1,110 @@
+#ifndef ANIMATOR_H
+#define ANIMATOR_H
+
+#include <SFML/System.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace SoftyPoker {
+
+enum class Ease : std::uint8_t {
+    Linear,
+    InQuad,
+    OutQuad,
+    InOutQuad,
+    OutCubic,
+    OutBack      // overshoots a little before settling
+};
+
+// Maps linear progress t in [0, 1] onto the curve.
+float applyEase(Ease ease, float t);
+
+// Runs every tween of a state from one update per tick. A tween moves one
+// float from a start to an end value; positions, scales and colors are
+// animated a channel at a time, the owner copying the floats onto its
+// sprites after update(). Tweens are stored as parallel arrays and advanced
+// in one loop, so thousands of them cost little more than the writes.
+//
+// Tweens belong to a group, which is how they are cancelled, finished early
+// or looped together. Where tweens of a group write the same float, the one
+// added last wins. The floats must outlive their tweens; an Animator that is
+// a member of the object owning them, declared after them, takes care of that.
+class Animator {
+public:
+    using Group = std::uint32_t;
+    static constexpr Group NoGroup = 0;
+
+    Animator();
+
+    Group newGroup();
+
+    // Moves target from `from` to `to` over duration seconds, starting after
+    // delay seconds. Nothing is written to target before the tween starts.
+    void tween(float& target, float from, float to, float duration,
+               Ease ease = Ease::Linear, float delay = 0.0f, Group group = NoGroup);
+    void tween(sf::Vector2f& target, sf::Vector2f from, sf::Vector2f to, float duration,
+               Ease ease = Ease::Linear, float delay = 0.0f, Group group = NoGroup);
+
+    void update(sf::Time step);
+
+    // Restarts every tween of the group each period seconds, counted from
+    // when the group was added; looping tweens never finish on their own.
+    void repeat(Group group, float period);
+    // Jumps the group's tweens to their end values and removes them.
+    void finish(Group group);
+    void cancel(Group group);
+    void clear();
+
+    bool isRunning(Group group) const;
+    std::size_t size() const;
+
+private:
+    void removeFinished();
+
+    // One entry per tween in each array
+    std::vector<float*> targets;
+    std::vector<float> from;
+    std::vector<float> delta;
+    std::vector<float> delay;
+    std::vector<float> duration;
+    std::vector<float> elapsed;
+    std::vector<float> period;      // 0 when the tween does not loop
+    std::vector<Ease> ease;
+    std::vector<Group> groups;
+    std::vector<std::uint8_t> done;
+
+    Group lastGroup;
+    bool anyDone;
+};
+
+// Builds a group whose tweens play one after another:
+//
+//     Sequence(animator).then(alpha, 0, 255, 6).wait(2).then(alpha, 255, 0, 6).loop();
+//
+// with() starts a tween together with the step before it.
+class Sequence {
+public:
+    explicit Sequence(Animator& animator, float startDelay = 0.0f);
+
+    Sequence& then(float& target, float from, float to, float duration, Ease ease = Ease::Linear);
+    Sequence& then(sf::Vector2f& target, sf::Vector2f from, sf::Vector2f to, float duration, Ease ease = Ease::Linear);
+    Sequence& with(float& target, float from, float to, float duration, Ease ease = Ease::Linear);
+    Sequence& with(sf::Vector2f& target, sf::Vector2f from, sf::Vector2f to, float duration, Ease ease = Ease::Linear);
+    Sequence& wait(float seconds);
+    // Plays the sequence again from the start once it has ended, for good.
+    void loop();
+
+    Animator::Group getGroup() const;
+    // Seconds from the start of the sequence to the end of its last step.
+    float getDuration() const;
+
+private:
+    Animator& animator;
+    Animator::Group group;
+    float stepStart;
+    float cursor;
+};
+
+} // namespace SoftyPoker
+
+#endif // ANIMATOR_H
@@ -0,0 +1,108 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include "WorkStealingPool.h"
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace SoftyPoker {
+
+enum class AssetStatus { Pending, Ready, Failed };
+
+// Result of an asynchronous load. States keep the handle and check isReady()
+// each frame instead of blocking; get() is only valid once it is ready.
+template <typename T>
+class AssetSlot {
+public:
+    explicit AssetSlot(std::string name) : name(std::move(name)), status(AssetStatus::Pending) {}
+
+    bool isReady() const { return status.load(std::memory_order_acquire) == AssetStatus::Ready; }
+    bool hasFailed() const { return status.load(std::memory_order_acquire) == AssetStatus::Failed; }
+    bool isDone() const { return status.load(std::memory_order_acquire) != AssetStatus::Pending; }
+
+    const T& get() const { return *asset; }
+    std::shared_ptr<T> share() const { return asset; }
+    const std::string& getName() const { return name; }
+
+private:
+    friend class AssetLoader;
+
+    void finish(std::shared_ptr<T> loaded) {
+        asset = std::move(loaded);
+        status.store(asset ? AssetStatus::Ready : AssetStatus::Failed, std::memory_order_release);
+    }
+
+    std::string name;
+    std::shared_ptr<T> asset;
+    std::atomic<AssetStatus> status;
+};
+
+template <typename T>
+using AssetHandle = std::shared_ptr<AssetSlot<T>>;
+
+// Decodes assets (see AssetPack.h for names) on worker threads and hands back
+// handles right away. Textures, fonts and sound buffers go through the
+// ResourceCache: one already cached is ready at once, and asking again for
+// one still loading gets the same handle.
+// Textures are decoded to an sf::Image off-thread and then copied to the GPU
+// a few rows at a time from uploadPending(), which must run on the thread that
+// owns the window's GL context.
+class AssetLoader {
+public:
+    explicit AssetLoader(unsigned threadCount = 2);
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // A non-zero fitTo shrinks the image at decode time to the smallest size
+    // that still covers it (see coverSize), for images that are never shown
+    // larger than that. Smooth textures also get mipmaps.
+    AssetHandle<sf::Texture> loadTexture(const std::string& name, bool smooth = true, sf::Vector2u fitTo = sf::Vector2u());
+    AssetHandle<sf::Image> loadImage(const std::string& name);
+    AssetHandle<sf::Font> loadFont(const std::string& name);
+    AssetHandle<sf::SoundBuffer> loadSoundBuffer(const std::string& name);
+
+    // Runs any other blocking setup (opening music streams and the like) on a
+    // worker, counted in the progress like an asset.
+    void runTask(std::function<void()> task);
+
+    // Uploads decoded texture rows until the budget is used up; returns true
+    // once nothing is left to upload.
+    bool uploadPending(sf::Time budget);
+
+    float getProgress() const;
+    bool isIdle() const;
+
+private:
+    struct PendingUpload {
+        std::unique_ptr<sf::Image> image;
+        std::shared_ptr<sf::Texture> texture;
+        AssetHandle<sf::Texture> slot;
+        std::string key;
+        bool smooth;
+        unsigned nextRow;
+    };
+
+    template <typename T>
+    AssetHandle<T> decode(const std::string& name, std::function<std::shared_ptr<T>()> load);
+
+    void finishOne();
+
+    std::mutex uploadMutex;
+    std::deque<PendingUpload> uploads;
+    std::unordered_map<std::string, AssetHandle<sf::Texture>> pendingTextures;
+    std::atomic<int> requested;
+    std::atomic<int> finished;
+    WorkStealingPool workers;
+};
+
+} // namespace SoftyPoker
+
+#endif // ASSET_LOADER_H
@@ -0,0 +1,91 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include "PackFormat.h"
+#include "Utility.h"
+#include <SFML/Audio.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SoftyPoker {
+
+struct AssetView {
+    const void* data;
+    std::size_t size;
+};
+
+// Read-only view of a softypoker.pak built by tools/AssetPacker.cpp.
+// The file is memory-mapped once; stored entries are handed out as pointers
+// into the mapping, compressed ones are unpacked on first use and kept.
+// Views stay valid until the pack is closed, which matters for sf::Font and
+// sf::Music as both keep reading from the memory they were opened with.
+class AssetPack {
+public:
+    AssetPack();
+    ~AssetPack();
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    bool contains(const std::string& name) const;
+    bool read(const std::string& name, AssetView& view);
+    std::vector<std::string> list(const std::string& prefix) const;
+
+private:
+    const Pack::Entry* findEntry(const std::string& name) const;
+    std::string entryName(const Pack::Entry& entry) const;
+
+    const std::uint8_t* base;
+    std::size_t mappedSize;
+    void* fileHandle;
+    void* mappingHandle;
+    const Pack::Header* header;
+    const Pack::Entry* entries;
+    const char* names;
+
+    std::mutex unpackMutex;
+    std::unordered_map<const Pack::Entry*, std::unique_ptr<std::vector<std::uint8_t>>> unpacked;
+};
+
+// The game's pack, opened from softypoker.pak in the working directory on
+// first use. When there is no pack, the loaders below fall back to the loose
+// files under getAssetPath().
+AssetPack& assetPack();
+
+// Asset names are pack-relative paths such as "images/logo.png".
+template <typename T>
+bool loadAsset(T& resource, const std::string& name) {
+    AssetView view;
+    if (assetPack().read(name, view)) {
+        return resource.loadFromMemory(view.data, view.size);
+    }
+    return resource.loadFromFile(getAssetPath(name));
+}
+
+inline bool openAsset(sf::Music& music, const std::string& name) {
+    AssetView view;
+    if (assetPack().read(name, view)) {
+        return music.openFromMemory(view.data, view.size);
+    }
+    return music.openFromFile(getAssetPath(name));
+}
+
+// Names of all assets under a directory prefix, from the pack or the loose files.
+std::vector<std::string> listAssets(const std::string& prefix);
+
+// Copies an asset's encoded bytes (the PNG, not the pixels), from the pack
+// or a loose file, for callers that decode it again later.
+bool readAssetBytes(const std::string& name, std::vector<std::uint8_t>& bytes);
+
+} // namespace SoftyPoker
+
+#endif // ASSET_PACK_H
@@ -2,14 +2,40 @@
 #define BACKGROUND_HANDLER_H
 
 #include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
 
+// A full-screen background kept at about the size it is shown at rather
+// than the source resolution. Textures come from the ResourceCache, so a
+// state showing the background another one already fitted to this window
+// shares its texture. Once decoded here, the encoded file stays in memory,
+// a fraction of the decoded size, so a resize that needs a different size
+// re-decodes and resamples it without going back to disk. Textures are
+// smooth and mipmapped, so shrinking the window down to half the texture
+// size just picks a smaller mip level instead of resampling.
 class BackgroundHandler {
 public:
-    BackgroundHandler(const sf::Texture& texture);
-    void resize(sf::RenderWindow& window);
-    void draw(sf::RenderWindow& window);
+    // Fits the asset to the given target right away, from the cache if it can.
+    BackgroundHandler(const std::string& assetName, sf::RenderTarget& window);
+    // Starts from a texture the AssetLoader already fitted to the window.
+    BackgroundHandler(const std::string& assetName, std::shared_ptr<sf::Texture> texture);
+
+    BackgroundHandler(const BackgroundHandler&) = delete;
+    BackgroundHandler& operator=(const BackgroundHandler&) = delete;
+
+    void resize(sf::RenderTarget& window);
+    void draw(sf::RenderTarget& window);
 
 private:
+    void resample(sf::Vector2u targetSize);
+    std::shared_ptr<sf::Texture> decode(sf::Vector2u targetSize, std::size_t& bytes);
+
+    std::string assetName;
+    std::shared_ptr<const std::vector<std::uint8_t>> encoded;   // null until decoded here
+    sf::Vector2u sourceSize;     // zero until the source has been decoded here
+    std::shared_ptr<sf::Texture> texture;
     sf::Sprite sprite;
 };
 
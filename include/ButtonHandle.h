@@ -1,18 +1,37 @@
 #ifndef BUTTON_HANDLE_H
 #define BUTTON_HANDLE_H
 
+#include "InputCommand.h"
 #include <SFML/Graphics.hpp>
-#include <functional>
-#include <unordered_map>
+#include <array>
 
+// Maps keys, gamepad buttons and clicks on on-screen buttons to commands
+// through flat tables indexed by key, button and command, and queues them
+// with the time the input arrived. The state's tick drains the queue, so
+// input handling never runs game logic inside the event poll.
 class ButtonHandle {
 public:
     ButtonHandle();
-    void addButton(sf::Keyboard::Key key, std::function<void()> onClick);
-    void handleEvent(const sf::Event& event);
+    void bindKey(sf::Keyboard::Key key, SoftyPoker::Command command);
+    void bindJoystickButton(unsigned button, SoftyPoker::Command command);
+
+    // Clickable area of a command in the target's view coordinates; the
+    // state sets these as it lays out its buttons.
+    void setHitArea(SoftyPoker::Command command, const sf::FloatRect& area);
+    void clearHitAreas();
+
+    // Queues the command the event maps to, if any, and returns whether there was one.
+    bool handleEvent(const sf::Event& event, const sf::RenderTarget& target);
+    // Takes the oldest queued command; false once the queue is empty.
+    bool poll(SoftyPoker::TimedCommand& command);
 
 private:
-    std::unordered_map<sf::Keyboard::Key, std::function<void()>> buttonActions;
+    void queue(SoftyPoker::Command command);
+
+    std::array<SoftyPoker::Command, sf::Keyboard::KeyCount> keyCommands;
+    std::array<SoftyPoker::Command, sf::Joystick::ButtonCount> joystickCommands;
+    std::array<sf::FloatRect, SoftyPoker::NumCommands> hitAreas;
+    SoftyPoker::CommandQueue commands;
 };
 
 #endif // BUTTON_HANDLE_H
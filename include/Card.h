@@ -0,0 +1,52 @@
+#ifndef CARD_H
+#define CARD_H
+
+#include <cstdint>
+#include <string>
+
+namespace SoftyPoker {
+
+// A card is an index 0..51 laid out as rank * 4 + suit.
+// Rank 0 is a Two and 12 is an Ace; suits 0..3 are clubs, diamonds, hearts, spades
+// (the C/D/H/S letters used by Assets/images/cards).
+using Card = std::uint8_t;
+
+constexpr int NumRanks = 13;
+constexpr int NumSuits = 4;
+constexpr int NumCards = 52;
+
+// Joker Poker adds a joker as a 53rd card. It has no suit and ranks above the
+// ace, so in the double-up it beats every other card.
+constexpr Card Joker = 52;
+constexpr int MaxDeckSize = NumCards + 1;
+
+constexpr int cardRank(Card card) { return card >> 2; }
+constexpr int cardSuit(Card card) { return card & 3; }
+constexpr Card makeCard(int rank, int suit) { return static_cast<Card>(rank * 4 + suit); }
+
+// A set of cards as a 64-bit mask, bit n standing for card n.
+using HandMask = std::uint64_t;
+
+constexpr HandMask FullDeckMask = (HandMask(1) << NumCards) - 1;
+
+constexpr HandMask cardMask(Card card) { return HandMask(1) << card; }
+
+constexpr HandMask handMask(const Card* cards, int count) {
+    HandMask mask = 0;
+    for (int i = 0; i < count; ++i) {
+        mask |= cardMask(cards[i]);
+    }
+    return mask;
+}
+
+// Two-letter name as used by the card images, e.g. "AS" or "TD"; the joker is "BBLK".
+inline std::string cardName(Card card) {
+    if (card == Joker) {
+        return "BBLK";
+    }
+    return { "23456789TJQKA"[cardRank(card)], "CDHS"[cardSuit(card)] };
+}
+
+} // namespace SoftyPoker
+
+#endif // CARD_H
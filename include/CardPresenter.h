@@ -0,0 +1,77 @@
+#ifndef CARD_PRESENTER_H
+#define CARD_PRESENTER_H
+
+#include "Animator.h"
+#include "SoundManager.h"
+#include "SpriteBatch.h"
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <vector>
+
+namespace SoftyPoker {
+
+// The five card slots of the table and how cards move into them: a deal
+// slides the cards in from the shoe one after another and turns them face
+// up, a draw turns over the replacements, and held cards lift a little.
+// Everything runs on the animator from the simulation tick, and the deal
+// sounds go out on the tick their card starts to move.
+//
+// The presenter only changes how the cards look. The game has already moved
+// on when a transition starts, so input is never held back by one.
+class CardPresenter {
+public:
+    explicit CardPresenter(SoundManager& sound);
+
+    // Recomputes the slot rectangles, only when the size has changed.
+    void layout(sf::Vector2u windowSize);
+
+    void dealHand();
+    // Turns over the cards in replacedMask, then plays the result sound.
+    void drawCards(int replacedMask, SoundId result);
+    // Turns over the cards in mask without sliding them, e.g. the double-up card.
+    void revealCards(int mask);
+    void setHeld(int index, bool held);
+    // Ends a running deal or draw at once; the result sound still plays, the
+    // deal sounds still due do not. Returns false if nothing was running.
+    bool fastForward();
+    // Drops every transition and sound still due.
+    void reset();
+
+    void update(sf::Time step);
+    bool isDealing() const;
+    bool isAnimating() const;
+
+    // Where a card rests; hit areas and hold markers go here.
+    const sf::FloatRect& getSlot(int index) const;
+    // Adds the five cards to the batch; faces are atlas regions, shown once a card is turned over.
+    void addTo(SpriteBatch& batch, const std::array<int, 5>& faces, int backRegion) const;
+
+private:
+    struct PendingSound {
+        float delay;
+        SoundId id;
+    };
+
+    void schedule(float delay, SoundId id);
+    void dropLifts();
+
+    SoundManager& soundPlayer;
+    sf::Vector2u layoutSize;
+    float scale;
+    std::array<sf::FloatRect, 5> slots;
+
+    // Tween targets, in the 1280x720 reference layout so a resize during a
+    // transition keeps them in proportion
+    std::array<sf::Vector2f, 5> offsets;
+    std::array<float, 5> reveals;       // 0 shows the back, 1 the face, turning in between
+    std::array<float, 5> lifts;
+
+    std::vector<PendingSound> pendingSounds;
+    Animator::Group dealGroup;
+    std::array<Animator::Group, 5> holdGroups;
+    Animator animator;
+};
+
+} // namespace SoftyPoker
+
+#endif // CARD_PRESENTER_H
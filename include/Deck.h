@@ -0,0 +1,75 @@
+#ifndef DECK_H
+#define DECK_H
+
+#include "Card.h"
+#include "Random.h"
+#include <array>
+
+namespace SoftyPoker {
+
+// 52 cards, or 53 with the joker, dealt by a partial Fisher-Yates shuffle:
+// each draw swaps one random card from the undealt tail into place, so a
+// round costs one random number per card actually dealt. Any permutation is
+// a valid starting order, so starting a new round never reorders the deck.
+class Deck {
+public:
+    explicit Deck(int size = NumCards) : size(size), dealt(0) {
+        for (int card = 0; card < size; ++card) {
+            cards[card] = static_cast<Card>(card);
+        }
+    }
+
+    void reset() { dealt = 0; }
+
+    Card draw(CounterRng& rng) {
+        int pick = dealt + static_cast<int>(rng.uniform(static_cast<std::uint32_t>(size - dealt)));
+        Card card = cards[pick];
+        cards[pick] = cards[dealt];
+        cards[dealt++] = card;
+        return card;
+    }
+
+    // Takes specific cards out of the undealt part, e.g. cards already on the table.
+    void remove(HandMask mask) {
+        for (int i = dealt; i < size; ++i) {
+            if (mask & cardMask(cards[i])) {
+                Card card = cards[i];
+                cards[i] = cards[dealt];
+                cards[dealt++] = card;
+            }
+        }
+    }
+
+    int remaining() const { return size - dealt; }
+    HandMask dealtMask() const { return handMask(cards.data(), dealt); }
+
+    // The order the cards are in and how many of them are dealt, for snapshots.
+    const std::array<Card, MaxDeckSize>& getOrder() const { return cards; }
+    int getDealt() const { return dealt; }
+    // Puts back a state from getOrder() and getDealt(); false, leaving the
+    // deck as it was, unless order holds every card of this deck once.
+    bool restore(const std::array<Card, MaxDeckSize>& order, int dealtCount) {
+        HandMask seen = 0;
+        for (int i = 0; i < size; ++i) {
+            if (order[i] >= size || (seen & cardMask(order[i]))) {
+                return false;
+            }
+            seen |= cardMask(order[i]);
+        }
+        if (dealtCount < 0 || dealtCount > size) {
+            return false;
+        }
+        cards = order;
+        dealt = dealtCount;
+        return true;
+    }
+
+private:
+    std::array<Card, MaxDeckSize> cards;
+    int size;
+    int dealt;
+};
+
+} // namespace SoftyPoker
+
+#endif // DECK_H
@@ -0,0 +1,58 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <SFML/Graphics.hpp>
+
+namespace SoftyPoker {
+
+struct FrameSettings {
+    unsigned frameLimit = 60;                       // 0 for no cap
+    sf::Time tickStep = sf::seconds(1.0f / 60.0f);  // fixed simulation step
+    int maxTicksPerFrame = 5;                       // drop time beyond this after a stall
+    bool verticalSync = false;
+    bool renderOnDemand = true;                     // skip draw() when nothing changed
+    sf::Time unfocusedSleep = sf::milliseconds(100);
+};
+
+// Paces the main loop: simulation advances in fixed ticks from an
+// accumulator, frames are capped with sleep-then-yield, and while the window
+// is unfocused the loop only polls events a few times a second.
+class FrameScheduler {
+public:
+    explicit FrameScheduler(const FrameSettings& settings = FrameSettings());
+
+    void applyTo(sf::RenderWindow& window) const;
+
+    // Call for every window event before dispatching it.
+    void onEvent(const sf::Event& event);
+
+    // Starts a frame and returns how many fixed ticks are due.
+    int beginFrame();
+    sf::Time getTickStep() const;
+    sf::Time getFrameTime() const;
+
+    // True when this frame should be drawn: the state changed, an event asked
+    // for it, or on-demand rendering is off.
+    bool shouldRender(bool stateChanged);
+    void requestRedraw();
+
+    // Sleeps until the next frame is due.
+    void endFrame();
+
+    bool isPaused() const;
+    // Used instead of a frame while paused.
+    void idle();
+
+private:
+    FrameSettings settings;
+    sf::Clock clock;
+    sf::Time frameStart;
+    sf::Time frameTime;
+    sf::Time accumulator;
+    bool focused;
+    bool redrawRequested;
+};
+
+} // namespace SoftyPoker
+
+#endif // FRAME_SCHEDULER_H
@@ -0,0 +1,65 @@
+#ifndef GAME_SERVER_H
+#define GAME_SERVER_H
+
+#include "Net.h"
+#include "ServerProtocol.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace SoftyPoker {
+
+struct ServerOptions {
+    std::uint16_t port = DefaultServerPort;
+    unsigned shards = 0;             // event loops, one per core when 0
+    bool loopbackOnly = true;
+    int startingCredits = 20;        // per hand of the session
+    std::uint64_t seed = 0;          // the sessions' seeds are drawn from it; 0 picks one
+};
+
+struct ShardStats {
+    std::uint64_t sessions;          // open now
+    std::uint64_t sessionsOpened;
+    std::uint64_t actions;
+};
+
+// Hosts table sessions for remote clients with no window and no rendering:
+// each connection is a PokerGame driven through applyCommand, exactly as the
+// table and the replays drive it (see ServerProtocol.h for the messages).
+// Sessions are sharded over one event loop per core. An acceptor thread
+// hands each new connection to the loop with the fewest sessions, and from
+// then on only that loop touches it, so sessions need no locks. A client
+// that stops reading its replies is dropped rather than buffered for.
+class GameServer {
+public:
+    explicit GameServer(const ServerOptions& options);
+    // Stops, closing every session.
+    ~GameServer();
+
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    // Listens and starts the loops; false if the port could not be opened.
+    bool start();
+    void stop();
+
+    unsigned getShardCount() const;
+    std::vector<ShardStats> getStats() const;
+
+private:
+    struct Shard;
+
+    void acceptLoop();
+
+    ServerOptions options;
+    SocketHandle listener;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<bool> stopping;
+    std::thread acceptor;
+};
+
+} // namespace SoftyPoker
+
+#endif // GAME_SERVER_H
@@ -2,13 +2,38 @@
 #define GAMESTATE_H
 
 #include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// Every state the game can be in; StateManager keeps one factory per id.
+enum class StateId : std::uint8_t {
+    Loading,
+    Intro,
+    Table
+};
+
+constexpr std::size_t NumStateIds = 3;
 
 class GameState {
 public:
     GameState() = default;
-    virtual void update(sf::RenderWindow& window) = 0;
-    virtual void draw(sf::RenderWindow& window) = 0;
-    virtual void handleEvent(sf::Event& event, sf::RenderWindow& window) = 0;  // Update signature
+    // Advances the state by one fixed simulation step.
+    virtual void update(sf::RenderTarget& window, sf::Time step) = 0;
+    // Renders into the back buffer; the main loop adds overlays and calls display().
+    virtual void draw(sf::RenderTarget& window) = 0;
+    // Lets the main loop skip draw() while nothing on screen has changed.
+    virtual bool needsRedraw() const { return true; }
+    virtual void handleEvent(sf::Event& event, sf::RenderTarget& window) = 0;  // Update signature
+
+    // Called on the main thread when the state becomes the top of the stack,
+    // and just before it is popped or replaced. A state may be constructed on
+    // a loader thread, so anything audible or visible starts in onEnter().
+    virtual void onEnter() {}
+    virtual void onExit() {}
+    // Called when another state is pushed on top of this one, and when it is popped again.
+    virtual void onSuspend() {}
+    virtual void onResume() {}
+
     virtual ~GameState() = default;
 };
 
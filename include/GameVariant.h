@@ -0,0 +1,52 @@
+#ifndef GAME_VARIANT_H
+#define GAME_VARIANT_H
+
+#include "VariantEvaluator.h"
+#include <cstdint>
+#include <string>
+
+namespace SoftyPoker {
+
+enum class VariantId : std::uint8_t {
+    JacksOrBetter,
+    DeucesWild,
+    JokerPoker
+};
+
+constexpr int NumVariants = 3;
+
+// A variant as the game picks it at run time: its rules plus its own
+// compiled evaluator.
+struct GameVariant {
+    VariantId id;
+    const char* name;        // as written in softypoker.cfg
+    const char* title;
+    const VariantRules& rules;
+    Prize (*evaluate)(const Card* cards);
+
+    static const GameVariant& get(VariantId id);
+    static const GameVariant& standard();
+    // nullptr for an unknown name.
+    static const GameVariant* find(const std::string& name);
+};
+
+// Calls f with the evaluator type of a variant, so a hot loop can be
+// compiled once per variant and the variant picked once, outside the loop:
+//
+//     visitVariant(id, [&](auto evaluator) { ... decltype(evaluator)::evaluate(cards) ... });
+template <typename F>
+decltype(auto) visitVariant(VariantId id, F&& f) {
+    switch (id) {
+    case VariantId::DeucesWild:
+        return f(VariantEvaluator<DeucesWildRules>());
+    case VariantId::JokerPoker:
+        return f(VariantEvaluator<JokerPokerRules>());
+    case VariantId::JacksOrBetter:
+    default:
+        return f(VariantEvaluator<JacksOrBetterRules>());
+    }
+}
+
+} // namespace SoftyPoker
+
+#endif // GAME_VARIANT_H
@@ -0,0 +1,76 @@
+#ifndef HAND_EVALUATOR_H
+#define HAND_EVALUATOR_H
+
+#include "Card.h"
+#include <cstdint>
+
+namespace SoftyPoker {
+
+enum class HandCategory : std::uint8_t {
+    StraightFlush,
+    FourOfAKind,
+    FullHouse,
+    Flush,
+    Straight,
+    ThreeOfAKind,
+    TwoPair,
+    OnePair,
+    HighCard
+};
+
+// Lookup tables built at compile time in HandEvaluator.cpp.
+// Non-flush hands are keyed by the product of their rank primes and found through
+// a two-level perfect hash; flushes are keyed directly by their 13-bit rank mask.
+namespace HandTables {
+    constexpr int HashBits = 13;
+    constexpr int BucketBits = 11;
+
+    constexpr int NumHandRanks = 7462;
+
+    struct Data {
+        std::uint32_t rankPrime[NumCards];
+        std::uint16_t rankBit[NumCards];
+        std::uint16_t flushRank[1 << NumRanks];
+        std::uint16_t hashAdjust[1 << BucketBits];
+        std::uint16_t hashRank[1 << HashBits];
+        std::uint8_t categoryOf[NumHandRanks + 1];
+    };
+
+    extern const Data tables;
+
+    inline std::uint32_t hashSlot(std::uint32_t product) {
+        std::uint64_t h = product * 0x9E3779B97F4A7C15ull;
+        std::uint32_t bucket = static_cast<std::uint32_t>(h >> (64 - BucketBits));
+        std::uint32_t slot = static_cast<std::uint32_t>(h >> 20) & ((1u << HashBits) - 1);
+        return slot ^ tables.hashAdjust[bucket];
+    }
+}
+
+// Ranks 5-card hands into the 7462 poker equivalence classes:
+// 1 is a royal flush, 7462 is 7-5-4-3-2 offsuit, lower is better.
+class HandEvaluator {
+public:
+    static std::uint16_t evaluate(Card c0, Card c1, Card c2, Card c3, Card c4) {
+        const HandTables::Data& t = HandTables::tables;
+        std::uint32_t product = t.rankPrime[c0] * t.rankPrime[c1] * t.rankPrime[c2] * t.rankPrime[c3] * t.rankPrime[c4];
+        unsigned rankMask = t.rankBit[c0] | t.rankBit[c1] | t.rankBit[c2] | t.rankBit[c3] | t.rankBit[c4];
+        bool flush = (((c0 ^ c1) | (c0 ^ c2) | (c0 ^ c3) | (c0 ^ c4)) & 3) == 0;
+
+        // Both lookups are always made so the select compiles to a conditional move.
+        std::uint16_t flushValue = t.flushRank[rankMask];
+        std::uint16_t pairedValue = t.hashRank[HandTables::hashSlot(product)];
+        return flush ? flushValue : pairedValue;
+    }
+
+    static std::uint16_t evaluate(const Card* cards) {
+        return evaluate(cards[0], cards[1], cards[2], cards[3], cards[4]);
+    }
+
+    static HandCategory category(std::uint16_t rank) {
+        return static_cast<HandCategory>(HandTables::tables.categoryOf[rank]);
+    }
+};
+
+} // namespace SoftyPoker
+
+#endif // HAND_EVALUATOR_H
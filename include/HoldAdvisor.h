@@ -0,0 +1,68 @@
+#ifndef HOLD_ADVISOR_H
+#define HOLD_ADVISOR_H
+
+#include "Card.h"
+#include "GameVariant.h"
+#include "WorkStealingPool.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace SoftyPoker {
+
+constexpr int NumHoldPatterns = 32;
+
+// Bit i of a hold pattern keeps card i of the dealt hand.
+struct HoldAdvice {
+    std::array<double, NumHoldPatterns> expectedValue{};  // credits returned for the current bet
+    int bestHold = 0;
+};
+
+// Computes the exact expected value of all 32 hold patterns by enumerating
+// every draw from the unseen cards (47, or 48 with a joker), split into tasks
+// on a WorkStealingPool. Results are memoized per suit-canonical hand, so
+// repeat situations are instant; the memo is a fixed direct-mapped table
+// where a new hand only replaces the one hand sharing its slot.
+class HoldAdvisor {
+public:
+    explicit HoldAdvisor(WorkStealingPool& pool, const GameVariant& variant = GameVariant::standard());
+    HoldAdvisor(WorkStealingPool& pool, const GameVariant& variant, const Paytable& paytable);
+    ~HoldAdvisor();
+
+    // Starts (or replaces) the computation for a dealt hand.
+    void request(const std::array<Card, 5>& hand, int bet);
+    void cancel();
+    bool isReady() const;
+    // Returns false while the result is still being computed or was cancelled.
+    bool getAdvice(HoldAdvice& advice) const;
+    // Blocking convenience for tools that have no frame loop to poll from.
+    HoldAdvice solve(const std::array<Card, 5>& hand, int bet);
+
+private:
+    struct Job;
+    struct MemoEntry {
+        std::uint64_t key = 0;      // 0 for an empty slot; real keys hold the bet
+        HoldAdvice advice;
+    };
+    struct Shared {
+        std::mutex mutex;
+        std::vector<MemoEntry> memo;
+    };
+
+    static std::uint64_t canonicalKey(const std::array<Card, 5>& hand, int bet);
+    static std::size_t memoSlot(std::uint64_t key);
+    void schedule(const std::shared_ptr<Job>& job);
+
+    WorkStealingPool& pool;
+    const GameVariant& variant;
+    Paytable paytable;
+    std::shared_ptr<Shared> shared;
+    std::shared_ptr<Job> current;
+};
+
+} // namespace SoftyPoker
+
+#endif // HOLD_ADVISOR_H
@@ -0,0 +1,16 @@
+#ifndef HOLD_STRATEGY_H
+#define HOLD_STRATEGY_H
+
+#include "Card.h"
+#include <array>
+
+namespace SoftyPoker {
+
+// Returns the hold mask (bit i keeps card i) picked by a condensed 9/6
+// Jacks or Better strategy chart. Cheap enough for simulating billions of
+// hands; HoldAdvisor gives the exact answer when speed does not matter.
+int basicStrategyHold(const std::array<Card, 5>& hand);
+
+} // namespace SoftyPoker
+
+#endif // HOLD_STRATEGY_H
@@ -0,0 +1,71 @@
+#ifndef INPUT_COMMAND_H
+#define INPUT_COMMAND_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace SoftyPoker {
+
+// What the player asked for, whichever key, button or click it came from.
+enum class Command : std::uint8_t {
+    None,
+    Start,
+    Bet,
+    Deal,
+    Collect,
+    Double,
+    Low,
+    High,
+    Hold1,
+    Hold2,
+    Hold3,
+    Hold4,
+    Hold5
+};
+
+constexpr std::size_t NumCommands = 13;
+
+struct TimedCommand {
+    Command command;
+    std::int64_t timestamp;   // Profiler::now() when the input event arrived
+};
+
+// Fixed-size single-producer, single-consumer ring: the event loop pushes,
+// the simulation tick pops. Neither side locks or allocates; when the tick
+// falls a whole ring behind, new input is dropped rather than blocking.
+class CommandQueue {
+public:
+    static constexpr std::size_t Capacity = 64;
+
+    bool push(const TimedCommand& command) {
+        std::size_t tail = writeIndex.load(std::memory_order_relaxed);
+        if (tail - readIndex.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        slots[tail % Capacity] = command;
+        writeIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(TimedCommand& command) {
+        std::size_t head = readIndex.load(std::memory_order_relaxed);
+        if (head == writeIndex.load(std::memory_order_acquire)) {
+            return false;
+        }
+        command = slots[head % Capacity];
+        readIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<TimedCommand, Capacity> slots;
+    // On separate cache lines so producer and consumer do not share one
+    alignas(64) std::atomic<std::size_t> readIndex{0};
+    alignas(64) std::atomic<std::size_t> writeIndex{0};
+};
+
+} // namespace SoftyPoker
+
+#endif // INPUT_COMMAND_H
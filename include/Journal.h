@@ -0,0 +1,111 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "InputCommand.h"
+#include "PokerGame.h"
+#include "Session.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SoftyPoker {
+
+// Where the table keeps the journal of the session it is playing.
+extern const char* const JournalPath;
+
+// One fixed-size entry of the journal. A record is only taken as written if
+// its checksum and its sequence number (its position in the file) agree, so
+// a write torn by a power cut ends the journal instead of corrupting it.
+struct JournalRecord {
+    std::uint32_t sequence;
+    std::uint8_t type;
+    std::uint8_t command;      // the Command; the variant of a start, the slice of a snapshot
+    std::uint16_t bet;         // hands per round in a start
+    std::uint32_t tick;
+    std::int32_t credits;
+    std::uint64_t digest;      // session digest after the command; the seed in a start
+    std::int32_t win;
+    std::uint32_t checksum;
+};
+
+static_assert(sizeof(JournalRecord) == 32, "journal record layout changed");
+
+enum class JournalRecordType : std::uint8_t {
+    Start,       // a new session: seed, variant, hands and starting credits
+    Command,     // a command that changed the game, with the meters it left
+    Snapshot,    // one slice of a GameSnapshot taken right after a command
+    End          // the table closed normally; nothing to recover
+};
+
+// What recovery found: the session so far, and the game as its last command
+// left it, ready to carry on.
+struct JournalRecovery {
+    SessionLog log;
+    PokerGame game{ CounterRng() };
+    std::uint32_t records = 0;     // intact records; anything after them is dropped
+    std::uint32_t replayed = 0;    // commands replayed on top of the newest snapshot
+    int rounds = 0;                // of those, the ones that dealt a new hand
+};
+
+// Maps the journal at path and rebuilds the session it holds. Returns false
+// when there is nothing to carry on: no journal, a session that ended
+// normally, or one this build does not reproduce (which is reported).
+bool recoverJournal(const std::string& path, JournalRecovery& recovery);
+
+// Append-only journal of a live table session, so a crash or power cut
+// costs nobody their credits. Records are queued by the game thread and
+// written by a thread of the journal's own, which syncs once per batch of
+// whatever queued up while the last sync ran; queueing never waits on the
+// disk. Every SnapshotInterval rounds a snapshot of the game goes in too,
+// so recovery replays at most that many rounds however long the session.
+class Journal {
+public:
+    static constexpr int SnapshotInterval = 1000;
+
+    Journal();
+    // Writes out what is still queued.
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Replaces the file at path with a journal for a new session.
+    bool start(const std::string& path, const SessionLog& session);
+    // Carries on a recovered journal after its last intact record.
+    bool resume(const std::string& path, const JournalRecovery& recovery);
+    bool isOpen() const;
+
+    // Call after the command has been applied and added to the session digest.
+    void recordCommand(std::uint32_t tick, Command command, const PokerGame& game, std::uint64_t digest);
+    // Marks the session as closed normally and writes everything out.
+    void finish(std::uint32_t ticks, const PokerGame& game, std::uint64_t digest);
+    // Blocks until everything queued so far is on disk.
+    void flush();
+
+private:
+    void append(JournalRecord record);
+    void writeLoop();
+    void close();
+
+    std::uint32_t sequence;
+    int rounds;
+    std::intptr_t file;
+    bool syncDirectory;
+    std::string directory;
+
+    std::mutex mutex;
+    std::condition_variable wakeWriter;
+    std::condition_variable written;
+    std::vector<JournalRecord> queued;
+    std::uint32_t queuedUpTo;
+    std::uint32_t writtenUpTo;
+    bool stopping;
+    std::thread writer;
+};
+
+} // namespace SoftyPoker
+
+#endif // JOURNAL_H
@@ -0,0 +1,33 @@
+#ifndef LOADING_STATE_H
+#define LOADING_STATE_H
+
+#include <SFML/Graphics.hpp>
+#include <functional>
+#include "GameState.h"
+#include "AssetLoader.h"
+
+namespace SoftyPoker {
+
+// Shown while the loader works through its queue. Draws only shapes so it
+// needs no assets of its own, uploads finished textures a slice per frame,
+// and calls onLoaded once everything requested so far is done.
+class LoadingState : public GameState {
+public:
+    LoadingState(AssetLoader& loader, std::function<void()> onLoaded);
+
+    void update(sf::RenderTarget& window, sf::Time step) override;
+    void draw(sf::RenderTarget& window) override;
+    void handleEvent(sf::Event& event, sf::RenderTarget& window) override;
+
+private:
+    AssetLoader& loader;
+    std::function<void()> onLoaded;
+    bool finished;
+    float shownProgress;
+    sf::RectangleShape barFrame;
+    sf::RectangleShape barFill;
+};
+
+} // namespace SoftyPoker
+
+#endif // LOADING_STATE_H
@@ -0,0 +1,154 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Lowest level compiled in: 0 keeps LOG_DEBUG, 1 starts at LOG_INFO, 2 keeps
+// only LOG_ERROR. Calls below it expand to nothing, arguments included.
+#ifndef SOFTYPOKER_LOG_LEVEL
+#define SOFTYPOKER_LOG_LEVEL 0
+#endif
+
+namespace SoftyPoker {
+
+enum class LogLevel : std::uint8_t {
+    Debug,
+    Info,
+    Error
+};
+
+// One log line as the calling thread left it: the format string and the
+// arguments in binary, formatted later by the sink thread.
+struct LogRecord {
+    static constexpr std::size_t PayloadSize = 232;
+
+    const char* format;
+    std::int64_t time;          // system clock, nanoseconds
+    LogLevel level;
+    std::uint8_t argCount;
+    std::uint16_t used;
+    std::uint32_t thread;
+    std::array<std::uint8_t, PayloadSize> payload;
+};
+
+static_assert(sizeof(LogRecord) == 256, "log records no longer fill four cache lines");
+
+// Logging that keeps the caller away from the console and the disk. Each
+// thread writes its records into a lock-free ring of its own (a full ring
+// drops the line and counts it, it never waits), and one sink thread turns
+// them into text, in time order across threads, for the console and for a
+// log file that rotates at RotateBytes. Use the LOG_ macros; the format
+// must be a string literal, with {} for each argument in turn.
+class Log {
+public:
+    static constexpr std::size_t RingSize = 512;
+    static constexpr std::uint64_t RotateBytes = 4 << 20;
+    static constexpr int KeptFiles = 3;
+
+    // Also writes to directory/softypoker.log, moving full files to
+    // softypoker.1.log and so on. Without it lines only go to the console.
+    static void openFile(const std::string& directory);
+    static void setConsole(bool enabled);
+    // Blocks until everything logged before the call has been written.
+    static void flush();
+
+    template <typename... Args>
+    static void write(LogLevel level, const char* format, const Args&... args) {
+        LogRecord* record = claim();
+        if (!record) {
+            return;
+        }
+        record->format = format;
+        record->level = level;
+        record->argCount = static_cast<std::uint8_t>(sizeof...(Args));
+        record->used = 0;
+        (encode(*record, args), ...);
+        publish(level);
+    }
+
+private:
+    enum class ArgType : std::uint8_t {
+        Signed,
+        Unsigned,
+        Float,
+        Bool,
+        Char,
+        Text
+    };
+
+    static LogRecord* claim();
+    static void publish(LogLevel level);
+
+    static void put(LogRecord& record, ArgType type, const void* data, std::size_t size) {
+        std::size_t needed = 1 + size;
+        if (record.used + needed > LogRecord::PayloadSize) {
+            return;
+        }
+        record.payload[record.used] = static_cast<std::uint8_t>(type);
+        std::memcpy(record.payload.data() + record.used + 1, data, size);
+        record.used = static_cast<std::uint16_t>(record.used + needed);
+    }
+
+    // Text is copied, cut short to what fits, so temporaries are fine
+    static void putText(LogRecord& record, std::string_view text) {
+        std::size_t room = LogRecord::PayloadSize - record.used;
+        if (room < 3) {
+            return;
+        }
+        std::uint16_t length = static_cast<std::uint16_t>(std::min(text.size(), room - 3));
+        record.payload[record.used] = static_cast<std::uint8_t>(ArgType::Text);
+        std::memcpy(record.payload.data() + record.used + 1, &length, sizeof(length));
+        std::memcpy(record.payload.data() + record.used + 3, text.data(), length);
+        record.used = static_cast<std::uint16_t>(record.used + 3 + length);
+    }
+
+    template <typename T>
+    static void encode(LogRecord& record, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            put(record, ArgType::Bool, &value, 1);
+        } else if constexpr (std::is_same_v<T, char>) {
+            put(record, ArgType::Char, &value, 1);
+        } else if constexpr (std::is_enum_v<T>) {
+            encode(record, static_cast<std::underlying_type_t<T>>(value));
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            std::int64_t wide = value;
+            put(record, ArgType::Signed, &wide, sizeof(wide));
+        } else if constexpr (std::is_integral_v<T>) {
+            std::uint64_t wide = value;
+            put(record, ArgType::Unsigned, &wide, sizeof(wide));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            double wide = value;
+            put(record, ArgType::Float, &wide, sizeof(wide));
+        } else {
+            // Strings, string literals, string_views and char pointers
+            putText(record, std::string_view(value));
+        }
+    }
+
+    friend struct LogSink;
+};
+
+} // namespace SoftyPoker
+
+#if SOFTYPOKER_LOG_LEVEL <= 0
+#define LOG_DEBUG(...) ::SoftyPoker::Log::write(::SoftyPoker::LogLevel::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if SOFTYPOKER_LOG_LEVEL <= 1
+#define LOG_INFO(...) ::SoftyPoker::Log::write(::SoftyPoker::LogLevel::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#define LOG_ERROR(...) ::SoftyPoker::Log::write(::SoftyPoker::LogLevel::Error, __VA_ARGS__)
+
+#endif // LOG_H
@@ -0,0 +1,25 @@
+#ifndef MACHINE_CONFIG_H
+#define MACHINE_CONFIG_H
+
+#include "GameVariant.h"
+#include <string>
+
+namespace SoftyPoker {
+
+// Per-machine settings read at startup from softypoker.cfg in the working
+// directory: one "key = value" per line, # starts a comment.
+struct MachineConfig {
+    VariantId variant = VariantId::JacksOrBetter;
+    int hands = 1;        // 3, 10, 50 or 100 for multi-hand play
+    int cacheMegabytes = 256;   // what the ResourceCache keeps once nothing holds it
+    int frameCap = 60;          // frames per second, 0 for no cap
+    bool renderOnDemand = true; // only redraw when something changed
+    bool holdAdvice = true;     // tint the hold markers of the best holds
+};
+
+// A missing file gives the defaults; a bad line is reported and skipped.
+MachineConfig loadMachineConfig(const std::string& path = "softypoker.cfg");
+
+} // namespace SoftyPoker
+
+#endif // MACHINE_CONFIG_H
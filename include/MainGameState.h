@@ -2,32 +2,97 @@
 #define MAINGAMESTATE_H
 
 #include "GameState.h"
+#include "BackgroundHandler.h"
 #include "SoundManager.h"
 #include "ButtonHandle.h"
+#include "CardPresenter.h"
+#include "GameVariant.h"
+#include "HoldAdvisor.h"
+#include "Journal.h"
+#include "PokerGame.h"
+#include "Session.h"
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
+#include "WorkStealingPool.h"
+#include <array>
+#include <cstdint>
 
 namespace SoftyPoker {
     class MainGameState : public GameState {
     public:
-        MainGameState(SoundManager& sp, sf::RenderWindow& window, const std::string& backgroundPath);
-        void update(sf::RenderWindow& window) override;
-        void draw(sf::RenderWindow& window) override;
-        void handleEvent(sf::Event& event, sf::RenderWindow& window) override;
+        // hands > 1 plays that many hands a round, shown as a grid above the dealt hand.
+        MainGameState(SoundManager& sp, sf::RenderTarget& window, const std::string& backgroundName, std::uint64_t seed,
+                      const GameVariant& variant = GameVariant::standard(), int hands = 1);
+        ~MainGameState() override;
+        void update(sf::RenderTarget& window, sf::Time step) override;
+        void draw(sf::RenderTarget& window) override;
+        bool needsRedraw() const override;
+        void handleEvent(sf::Event& event, sf::RenderTarget& window) override;
+        void onEnter() override;
+        void onResume() override;
+
+        // Plays a recorded session back at the pace it was played, from a
+        // fresh game; input is ignored until it has finished. Call before
+        // the first update(). The log must be of this table's variant.
+        void startReplay(const SessionLog& log);
+        // Carries on a session recovered from the journal after a crash. Call
+        // before the first update(); the session must be of this table's variant.
+        void resumeSession(const JournalRecovery& recovery);
+        // Whether the session is journaled as it is played and written to
+        // sessions/ when the table closes; on by default.
+        void setKeepSession(bool keep);
+        // Whether the hold markers of the cards the advisor would keep are
+        // tinted once it has worked them out; on by default.
+        void setHoldAdvice(bool show);
 
     private:
         SoundManager& soundPlayer;
-        sf::Clock clock;
-        sf::Texture backgroundTexture;
-        sf::Sprite backgroundSprite;
+        bool dirty;
+        BackgroundHandler background;
         ButtonHandle buttonHandle;
+        std::uint32_t tick;
+        const GameVariant& variant;
+        PokerGame game;
+        SessionRecorder recorder;
+        Journal journal;
+        SessionLog replayLog;
+        std::size_t replayNext;
+        bool replaying;
+        bool keepSession;
+        bool holdAdvice;
+        int advisedHolds;               // hold pattern to tint, -1 until the advice is in
+        WorkStealingPool advisorPool;
+        HoldAdvisor advisor;
+        TextureAtlas atlas;
+        SpriteBatch tableBatch;
+        CardPresenter cards;
+
+        // Atlas region ids, resolved once after the atlas is built
+        std::array<int, MaxDeckSize> cardRegions;
+        std::array<int, 10> digitRegions;
+        std::array<int, NumPrizes> prizeRegions;
+        int cardBackRegion;
+        int heldRegion;
+        int holdRegion;
+        int creditsRegion;
+        int betRegion;
+        int dealRegion;
+        int collectRegion;
+        int doubleRegion;
+        int lowRegion;
+        int highRegion;
+        unsigned atlasCardHeight;    // height the card faces were packed at
+
+        // Packs the table art with the card faces fitted to windowSize.
+        void loadTableAtlas(sf::Vector2u windowSize);
+        void buildTableLayer(sf::Vector2u windowSize);
+        void addHandGrid(float scale, float right, bool revealed);
+        float addNumber(int value, sf::Vector2f position, float height);
 
+        bool execute(Command command);
+        void record(Command command);
+        void finishReplay();
         void startGame();
-        void bet();
-        void deal();
-        void collect();
-        void enterGamblingState();
-        void guessSmall();
-        void guessHigh();
-        void holdCard(int cardIndex);
     };
 }
 
@@ -0,0 +1,74 @@
+#ifndef MULTI_HAND_H
+#define MULTI_HAND_H
+
+#include "Card.h"
+#include "Deck.h"
+#include "GameVariant.h"
+#include "Random.h"
+#include <array>
+#include <cstdint>
+
+namespace SoftyPoker {
+
+// Triple, Ten, Fifty and Hundred Play: the held cards of the dealt hand are
+// copied into every hand and each hand draws its replacements from its own
+// copy of the rest of the deck.
+constexpr int MaxHands = 100;
+
+// The hand counts a machine offers: 1, or 3, 10, 50 or 100 for multi-hand play.
+constexpr bool isHandCount(int hands) {
+    return hands == 1 || hands == 3 || hands == 10 || hands == 50 || hands == MaxHands;
+}
+
+// How a round of hands is evaluated. The SIMD kernels work on 16 (SSE4.1)
+// or 32 (AVX2) hands per instruction; the best one the CPU has is picked
+// on first use.
+enum class HandKernel : std::uint8_t {
+    Scalar,
+    Sse41,
+    Avx2
+};
+
+const char* handKernelName(HandKernel kernel);
+bool handKernelSupported(HandKernel kernel);
+HandKernel activeHandKernel();
+// For benchmarks; an unsupported kernel is ignored.
+void setHandKernel(HandKernel kernel);
+
+// The hands of one multi-hand round, stored a card slot at a time (all the
+// first cards, then all the second cards, ...) so the kernels load the same
+// slot of many hands at once. Hand 0 is the hand the player dealt and held.
+class MultiHand {
+public:
+    // Lanes, rounded up to whole AVX2 registers
+    static constexpr int PaddedHands = (MaxHands + 31) / 32 * 32;
+
+    MultiHand();
+
+    // Hand 0 becomes base as drawn; hands 1..count-1 keep the held cards of
+    // base and replace the rest from their own copy of remaining, the deck as
+    // it was before base drew.
+    void draw(const std::array<Card, 5>& base, int heldMask, const Deck& remaining, CounterRng& rng, int count);
+    // Shows only the held cards in every hand, e.g. between deal and draw.
+    void clear();
+    void evaluate(const GameVariant& variant);
+
+    int getCount() const { return count; }
+    bool isDrawn() const { return drawn; }
+    Card getCard(int hand, int slot) const { return cards[slot][hand]; }
+    Prize getPrize(int hand) const { return static_cast<Prize>(prizes[hand]); }
+
+private:
+    alignas(32) std::array<std::array<Card, PaddedHands>, 5> cards;
+    alignas(32) std::array<std::uint8_t, PaddedHands> prizes;
+    int count;
+    bool drawn;
+};
+
+// Prizes of count hands given as five slot arrays of at least count cards,
+// padded to a multiple of 32. Runs on the active kernel.
+void evaluateHands(const GameVariant& variant, const Card* const slots[5], int count, std::uint8_t* prizes);
+
+} // namespace SoftyPoker
+
+#endif // MULTI_HAND_H
@@ -0,0 +1,76 @@
+#ifndef NET_H
+#define NET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SoftyPoker {
+
+// A TCP socket: a file descriptor, or a SOCKET on Windows.
+using SocketHandle = std::intptr_t;
+
+constexpr SocketHandle NoSocket = -1;
+
+// Starts the socket library where one has to be started (Windows); false if
+// it would not. Elsewhere it raises the open file limit as far as it goes,
+// since every session is a socket and the usual 1024 is too few.
+bool initSockets();
+
+// A non-blocking listening socket on port, on the loopback interface only
+// unless loopbackOnly is false. NoSocket on failure, which is reported.
+SocketHandle listenOn(std::uint16_t port, bool loopbackOnly = true);
+// The next waiting connection, non-blocking and with Nagle off, or NoSocket if there is none.
+SocketHandle acceptConnection(SocketHandle listener);
+// Connects (blocking), then makes the socket non-blocking with Nagle off.
+SocketHandle connectTo(const std::string& host, std::uint16_t port);
+void closeSocket(SocketHandle socket);
+
+// Bytes moved, 0 when the call would block, -1 when the peer closed or the socket failed.
+long receiveSome(SocketHandle socket, void* data, std::size_t size);
+long sendSome(SocketHandle socket, const void* data, std::size_t size);
+
+struct PollEvent {
+    std::uint64_t token;
+    bool readable;
+    bool writable;
+    bool failed;      // hung up or in error; reading will say which
+};
+
+// Readiness of many non-blocking sockets at once, level-triggered: epoll on
+// Linux, poll() elsewhere (WSAPoll on Windows). One thread per poller; each
+// socket is registered with a token that comes back in its events.
+class Poller {
+public:
+    Poller();
+    ~Poller();
+
+    Poller(const Poller&) = delete;
+    Poller& operator=(const Poller&) = delete;
+
+    bool add(SocketHandle socket, std::uint64_t token);
+    // Also reports the socket writable while set, for output that did not all go out at once.
+    void watchWritable(SocketHandle socket, std::uint64_t token, bool watch);
+    void remove(SocketHandle socket);
+    // Waits up to timeoutMs (-1: for ever) and fills events; returns how many.
+    int wait(std::vector<PollEvent>& events, int timeoutMs);
+
+private:
+#ifdef __linux__
+    int epoll;
+#else
+    struct Watched {
+        SocketHandle socket;
+        std::uint64_t token;
+        bool writable;
+    };
+    std::vector<Watched> watched;
+    std::unordered_map<SocketHandle, std::size_t> positions;
+#endif
+};
+
+} // namespace SoftyPoker
+
+#endif // NET_H
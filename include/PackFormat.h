@@ -0,0 +1,62 @@
+#ifndef PACK_FORMAT_H
+#define PACK_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SoftyPoker {
+
+// On-disk layout of softypoker.pak, shared by the packer tool and the runtime.
+//
+//   PackHeader | PackEntry[entryCount] | names | data...
+//
+// Entries are sorted by name so lookups can binary search the mapped table,
+// and every data block starts on a PackAlignment boundary. All integers are
+// little-endian; the pack is read in place, never parsed into a copy.
+namespace Pack {
+    constexpr char Magic[4] = { 'S', 'P', 'A', 'K' };
+    constexpr std::uint32_t Version = 1;
+    constexpr std::uint64_t Alignment = 64;
+
+    enum Compression : std::uint8_t {
+        Stored = 0,
+        Lz = 1
+    };
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        std::uint32_t namesSize;
+        std::uint64_t namesOffset;
+        std::uint64_t reserved;
+    };
+
+    struct Entry {
+        std::uint64_t offset;       // from the start of the file
+        std::uint64_t storedSize;   // bytes in the pack
+        std::uint64_t size;         // bytes once decompressed
+        std::uint32_t nameOffset;   // into the names block, not null terminated
+        std::uint16_t nameLength;
+        std::uint8_t compression;
+        std::uint8_t reserved;
+    };
+
+    static_assert(sizeof(Header) == 32, "pack header layout changed");
+    static_assert(sizeof(Entry) == 32, "pack entry layout changed");
+
+    constexpr std::uint64_t align(std::uint64_t offset) {
+        return (offset + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    // Byte-oriented LZ77 in the spirit of LZ4: sequences of literals followed
+    // by a back reference within the last 64 KB. Cheap enough to decode at
+    // load time; only worth it for uncompressed formats such as WAV and TTF.
+    std::vector<std::uint8_t> compress(const std::uint8_t* data, std::size_t size);
+    bool decompress(const std::uint8_t* data, std::size_t size, std::uint8_t* out, std::size_t outSize);
+}
+
+} // namespace SoftyPoker
+
+#endif // PACK_FORMAT_H
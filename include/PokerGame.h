@@ -0,0 +1,118 @@
+#ifndef POKER_GAME_H
+#define POKER_GAME_H
+
+#include "Card.h"
+#include "Deck.h"
+#include "GameVariant.h"
+#include "MultiHand.h"
+#include "PrizeTable.h"
+#include "Random.h"
+#include <array>
+#include <cstdint>
+
+namespace SoftyPoker {
+
+enum class GamePhase {
+    Betting,   // waiting for bets and the first deal
+    Dealt,     // five cards showing, holds can be toggled
+    Won,       // draw paid out, win can be collected or gambled
+    Gambling   // guessing low/high against the reference card
+};
+
+enum class GambleResult {
+    Lost,
+    Push,
+    Won
+};
+
+// Everything a PokerGame needs to carry on where another one stopped, as
+// plain bytes for the journal. The other hands of a multi-hand round are not
+// in it, so a snapshot is only complete before they have drawn.
+struct GameSnapshot {
+    std::uint64_t rngCounter;
+    std::int32_t credits;
+    std::int32_t win;
+    std::uint16_t bet;
+    std::uint8_t phase;
+    std::uint8_t handDealt;
+    std::uint8_t heldMask;
+    std::uint8_t prize;
+    std::uint8_t gambleCard;
+    std::uint8_t handCount;
+    std::uint8_t deckDealt;
+    std::array<Card, 5> hand;
+    std::array<Card, MaxDeckSize> deck;
+};
+
+// Rendering-free rules of a video poker machine: credits, betting,
+// deal/hold/draw, payout and the low/high double-up, for any GameVariant.
+// MainGameState drives it from key presses; headless tools drive it directly.
+//
+// With more than one hand the bet is per hand, every hand pays on its own
+// and the win is their total; the double-up is played on the total.
+
+class PokerGame {
+public:
+    explicit PokerGame(const CounterRng& rng, int startingCredits = 20,
+                       const GameVariant& variant = GameVariant::standard());
+    // Pays from paytable instead of the variant's own, e.g. to try out a table in the simulator.
+    PokerGame(const CounterRng& rng, int startingCredits, const GameVariant& variant, const Paytable& paytable);
+
+    // 1, or 3, 10, 50 or 100 for multi-hand play. Only between rounds, with nothing bet.
+    bool setHandCount(int count);
+
+    void insertCredits(int amount);
+    // Empties the credit meter and returns what was on it.
+    int cashOut();
+    // B: moves one credit per hand onto the bet, cycling back to 1 past MaxBet or the credits left.
+    bool bet();
+    // D: deals five fresh cards, or draws replacements for the unheld ones and pays out.
+    bool deal();
+    bool toggleHold(int index);
+    bool collect();
+    bool enterGamble();
+    GambleResult guess(bool high);
+
+    GamePhase getPhase() const { return phase; }
+    int getCredits() const { return credits; }
+    int getBet() const { return currentBet; }
+    int getWin() const { return win; }
+    // Prize of the dealt hand.
+    Prize getPrize() const { return prize; }
+    int getHandCount() const { return handCount; }
+    // Every hand of the last multi-hand draw, the dealt hand first.
+    const MultiHand& getHands() const { return hands; }
+    // False until the first deal; the last hand stays on show between rounds.
+    bool hasHand() const { return handDealt; }
+    const std::array<Card, 5>& getHand() const { return hand; }
+    int getHeldMask() const { return heldMask; }
+    bool isHeld(int index) const { return (heldMask >> index) & 1; }
+    Card getGambleCard() const { return gambleCard; }
+    const GameVariant& getVariant() const { return *variant; }
+
+    GameSnapshot snapshot() const;
+    // Takes over a snapshot of a game with the same seed and variant; false,
+    // changing nothing, if it does not describe one.
+    bool restore(const GameSnapshot& snapshot);
+
+private:
+    CounterRng rng;
+    const GameVariant* variant;
+    Paytable paytable;
+    Deck deck;
+    std::array<Card, 5> hand;
+    bool handDealt;
+    int heldMask;
+    GamePhase phase;
+    int credits;
+    int currentBet;
+    int win;
+    Prize prize;
+    Card gambleCard;
+    int handCount;
+    MultiHand hands;
+};
+
+} // namespace SoftyPoker
+
+#endif // POKER_GAME_H
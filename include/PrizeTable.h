@@ -0,0 +1,51 @@
+#ifndef PRIZE_TABLE_H
+#define PRIZE_TABLE_H
+
+#include <array>
+#include <cstdint>
+
+namespace SoftyPoker {
+
+// Every prize row of every variant. The first ten are the Jacks or Better
+// ladder, lowest to highest (Assets/images/table); rows the wild-card
+// variants add come after them, so the values of the first ten never change.
+enum class Prize : std::uint8_t {
+    None,
+    JacksOrBetter,
+    TwoPair,
+    ThreeOfAKind,
+    Straight,
+    Flush,
+    FullHouse,
+    FourOfAKind,
+    StraightFlush,
+    RoyalFlush,        // a natural royal in the wild-card variants
+    KingsOrBetter,
+    FiveOfAKind,
+    WildRoyalFlush,
+    FourDeuces
+};
+
+constexpr int NumPrizes = 14;
+constexpr int MaxBet = 5;
+
+// Credits paid per credit bet for each prize row; a royal flush at MaxBet
+// pays maxBetRoyalFlush instead.
+struct Paytable {
+    std::array<int, NumPrizes> multiplier;
+    int maxBetRoyalFlush;
+
+    int payout(Prize prize, int bet) const;
+};
+
+class PrizeTable {
+public:
+    // The 9/6 Jacks or Better table; the other variants are in VariantEvaluator.h.
+    static const Paytable& standard();
+    // Also the image name under Assets/images/table, where there is one.
+    static const char* name(Prize prize);
+};
+
+} // namespace SoftyPoker
+
+#endif // PRIZE_TABLE_H
@@ -0,0 +1,100 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SFML/System.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Set to 0 to compile every PROFILE_SCOPE out of the build.
+#ifndef SOFTYPOKER_PROFILE
+#define SOFTYPOKER_PROFILE 1
+#endif
+
+namespace SoftyPoker {
+
+// Timestamps are nanoseconds since the profiler was first used.
+struct ProfileEvent {
+    const char* name;
+    std::int64_t start;
+    std::int64_t duration;
+};
+
+struct FrameStats {
+    static constexpr std::size_t History = 240;
+
+    std::array<float, History> frameMs;   // ring, newest at (next - 1)
+    std::size_t next;
+    std::size_t count;
+    unsigned drawCalls;                   // in the last finished frame
+    std::int64_t textureBytes;
+    float inputLatencyMs;                 // input event to executed command, latest one
+};
+
+// Scoped timings go into a fixed ring per thread, so recording never locks
+// or allocates after a thread's first event; the newest RingSize events of
+// each thread are kept. Frame statistics belong to the main thread.
+class Profiler {
+public:
+    static constexpr std::size_t RingSize = 1 << 14;
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    static std::int64_t now();
+    // name must outlive the profiler, i.e. be a string literal.
+    static void record(const char* name, std::int64_t start, std::int64_t end);
+
+    static void countDrawCalls(unsigned count = 1);
+    static void trackTextureMemory(std::int64_t bytes);
+    // Records an input that arrived at inputTime and was acted on just now,
+    // both as a trace event and for the overlay.
+    static void recordInputLatency(std::int64_t inputTime);
+    static void endFrame(sf::Time frameTime);
+    static const FrameStats& getFrameStats();
+
+    // Writes everything still in the rings as Chrome trace JSON, for
+    // chrome://tracing or ui.perfetto.dev.
+    static bool exportChromeTrace(const std::string& path);
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : name(Profiler::isEnabled() ? name : nullptr),
+          start(this->name ? Profiler::now() : 0) {}
+
+    ~ProfileScope() {
+        if (name) {
+            Profiler::record(name, start, Profiler::now());
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    std::int64_t start;
+};
+
+// Draws and counts one draw call towards the overlay's total.
+template <typename Target, typename Drawable>
+void countedDraw(Target& target, const Drawable& drawable) {
+    target.draw(drawable);
+    Profiler::countDrawCalls();
+}
+
+} // namespace SoftyPoker
+
+#define SOFTYPOKER_PROFILE_JOIN2(a, b) a##b
+#define SOFTYPOKER_PROFILE_JOIN(a, b) SOFTYPOKER_PROFILE_JOIN2(a, b)
+
+#if SOFTYPOKER_PROFILE
+#define PROFILE_SCOPE(name) ::SoftyPoker::ProfileScope SOFTYPOKER_PROFILE_JOIN(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,30 @@
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include <SFML/Graphics.hpp>
+#include <memory>
+
+namespace SoftyPoker {
+
+// Frame-time graph and counters drawn over whatever state is showing.
+// F3 toggles it and F4 writes a Chrome trace; see handleEvent().
+class ProfilerOverlay {
+public:
+    ProfilerOverlay();
+
+    // Returns true if the event was one of the overlay's keys.
+    bool handleEvent(const sf::Event& event);
+    bool isVisible() const;
+    void draw(sf::RenderTarget& window);
+
+private:
+    bool visible;
+    std::shared_ptr<sf::Font> font;
+    sf::Text text;
+    sf::RectangleShape panel;
+    sf::VertexArray graph;
+};
+
+} // namespace SoftyPoker
+
+#endif // PROFILER_OVERLAY_H
@@ -0,0 +1,64 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+namespace SoftyPoker {
+
+// Counter-based generator: output n is a pure function of (key, n), so a
+// seed reproduces a sequence exactly, independent streams are just different
+// keys, and any position can be reached without stepping through the ones before it.
+class CounterRng {
+public:
+    explicit CounterRng(std::uint64_t seed = 0, std::uint64_t stream = 0)
+        : key(mix(seed ^ mix(stream + 0x632BE59BD9B4E019ull))), counter(0) {}
+
+    std::uint64_t next() {
+        return mix(key + ++counter * 0x9E3779B97F4A7C15ull);
+    }
+
+    // Unbiased integer in [0, bound) (Lemire's multiply-shift with rejection).
+    std::uint32_t uniform(std::uint32_t bound) {
+        std::uint64_t product = static_cast<std::uint64_t>(static_cast<std::uint32_t>(next())) * bound;
+        std::uint32_t low = static_cast<std::uint32_t>(product);
+        if (low < bound) {
+            std::uint32_t threshold = -bound % bound;
+            while (low < threshold) {
+                product = static_cast<std::uint64_t>(static_cast<std::uint32_t>(next())) * bound;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        return static_cast<std::uint32_t>(product >> 32);
+    }
+
+    std::uint64_t getCounter() const { return counter; }
+    void setCounter(std::uint64_t value) { counter = value; }
+
+    // UniformRandomBitGenerator, so it also plugs into <random> and <algorithm>.
+    using result_type = std::uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+    result_type operator()() { return next(); }
+
+private:
+    // splitmix64 finalizer
+    static std::uint64_t mix(std::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    std::uint64_t key;
+    std::uint64_t counter;
+};
+
+// 64 bits from std::random_device, for the seed of anything that deals cards.
+std::uint64_t randomSeed();
+
+// Generator for cosmetic picks (backgrounds, music). One per thread, each
+// seeded from randomSeed() when the thread first uses it.
+CounterRng& sharedRng();
+
+} // namespace SoftyPoker
+
+#endif // RANDOM_H
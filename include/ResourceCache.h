@@ -0,0 +1,139 @@
+#ifndef RESOURCE_CACHE_H
+#define RESOURCE_CACHE_H
+
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SoftyPoker {
+
+struct ResourceCacheStats {
+    std::uint64_t hits = 0;        // served from the cache, or from a load already under way
+    std::uint64_t misses = 0;      // loaded
+    std::uint64_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;         // everything cached, held or not
+    std::size_t heldBytes = 0;     // the part someone still holds a handle to
+    std::size_t budget = 0;
+};
+
+// Textures, fonts, sound buffers and encoded files shared by every state,
+// keyed by asset name (textures also by how they were decoded, see
+// textureKey). A handle is a plain shared_ptr, so whoever holds one keeps
+// the resource alive; asking for a key that is already cached, or already
+// being loaded, hands out the same object. Entries nobody holds stay cached
+// for the next state that wants them while the total is within budget, and
+// the least recently used go first when it is not. Held entries are never
+// evicted, so the total may run over budget while they are in use.
+class ResourceCache {
+public:
+    static constexpr std::size_t DefaultBudget = std::size_t(256) << 20;
+
+    template <typename T>
+    using Loader = std::function<std::shared_ptr<T>(std::size_t& bytes)>;
+
+    explicit ResourceCache(std::size_t budget = DefaultBudget);
+
+    ResourceCache(const ResourceCache&) = delete;
+    ResourceCache& operator=(const ResourceCache&) = delete;
+
+    // The cached resource for key, or what load returns (null on failure,
+    // which is not cached) with its size in bytes. A caller asking for a key
+    // another thread is loading waits for that load instead of starting its own.
+    template <typename T>
+    std::shared_ptr<T> acquire(const std::string& key, const Loader<T>& load) {
+        return std::static_pointer_cast<T>(acquireErased(key, [&load](std::size_t& bytes) {
+            return std::shared_ptr<void>(load(bytes));
+        }));
+    }
+
+    // The cached resource for key, or null without loading anything.
+    template <typename T>
+    std::shared_ptr<T> find(const std::string& key) {
+        return std::static_pointer_cast<T>(findErased(key));
+    }
+
+    // Adds a resource loaded elsewhere, such as a texture the AssetLoader
+    // uploaded a few rows at a time. An entry already under key is kept.
+    template <typename T>
+    std::shared_ptr<T> insert(const std::string& key, std::shared_ptr<T> resource, std::size_t bytes) {
+        return std::static_pointer_cast<T>(insertErased(key, std::move(resource), bytes));
+    }
+
+    std::shared_ptr<sf::Font> font(const std::string& name);
+    std::shared_ptr<sf::SoundBuffer> soundBuffer(const std::string& name);
+    // The asset's encoded bytes, for callers that decode it themselves.
+    std::shared_ptr<const std::vector<std::uint8_t>> encoded(const std::string& name);
+
+    // Textures decoded differently are different entries.
+    static std::string textureKey(const std::string& name, bool smooth, sf::Vector2u fitTo);
+
+    void setBudget(std::size_t bytes);
+    // Evicts unheld entries until the total is within budget. Runs after
+    // every load; call it too when a state lets go of its handles.
+    void trim();
+    // Drops every entry; held resources live on with their holders.
+    void clear();
+    // Drops the entries nobody holds whose key starts with prefix, whatever
+    // the budget. For assets only one state shows, once that state is gone.
+    void evict(const std::string& prefix);
+
+    ResourceCacheStats getStats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<void> resource;
+        std::size_t bytes = 0;
+        std::uint64_t lastUse = 0;
+        bool loading = false;
+    };
+
+    std::shared_ptr<void> acquireErased(const std::string& key, const Loader<void>& load);
+    std::shared_ptr<void> findErased(const std::string& key);
+    std::shared_ptr<void> insertErased(const std::string& key, std::shared_ptr<void> resource, std::size_t bytes);
+    void trimLocked();
+
+    mutable std::mutex mutex;
+    std::condition_variable loaded;
+    std::unordered_map<std::string, Entry> entries;
+    std::size_t budget;
+    std::size_t totalBytes;
+    std::uint64_t useCounter;
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t evictions;
+};
+
+// The process-wide cache, created on first use.
+ResourceCache& resourceCache();
+
+// Evicts the given key prefixes from the process-wide cache when it is
+// destroyed. Declared as the first member of a state, it goes after
+// everything else the state holds, so nothing still holds those entries.
+class CacheEviction {
+public:
+    explicit CacheEviction(std::vector<std::string> prefixes);
+    ~CacheEviction();
+
+    CacheEviction(const CacheEviction&) = delete;
+    CacheEviction& operator=(const CacheEviction&) = delete;
+
+private:
+    std::vector<std::string> prefixes;
+};
+
+// An empty texture of the given GPU size that reports itself to the
+// profiler's texture memory total for as long as it lives.
+std::shared_ptr<sf::Texture> makeTrackedTexture(long long bytes);
+
+} // namespace SoftyPoker
+
+#endif // RESOURCE_CACHE_H
@@ -0,0 +1,73 @@
+#ifndef SERVER_PROTOCOL_H
+#define SERVER_PROTOCOL_H
+
+#include "Card.h"
+#include <array>
+#include <cstdint>
+
+namespace SoftyPoker {
+
+// Wire format between softypoker-server and its clients: fixed-size
+// little-endian structs, written as they are. A connection is one table
+// session: the client says which game it sits down at, the server answers
+// with the session's seed, and from then on every ActionRequest gets one
+// ActionReply, in order. Requests may be sent before earlier replies arrive.
+
+constexpr std::uint16_t DefaultServerPort = 7777;
+constexpr std::uint16_t ProtocolVersion = 1;
+constexpr char ClientMagic[4] = { 'S', 'P', 'C', 'L' };
+constexpr char ServerMagic[4] = { 'S', 'P', 'S', 'V' };
+
+struct ClientHello {
+    char magic[4];
+    std::uint16_t version;
+    std::uint8_t variant;          // a VariantId
+    std::uint8_t reserved;
+    std::uint16_t hands;           // hands per round, see isHandCount
+    std::uint16_t reserved2;
+};
+
+struct ServerHello {
+    char magic[4];
+    std::uint16_t version;
+    std::uint8_t accepted;         // 0: the game asked for is not offered; the server closes
+    std::uint8_t reserved;
+    std::uint16_t shard;           // which of the server's cores hosts the session
+    std::uint16_t shards;
+    std::int32_t credits;          // starting credits
+    std::uint64_t seed;            // deals the session, as in a SessionLog
+};
+
+struct ActionRequest {
+    std::uint32_t sequence;        // echoed in the reply
+    std::uint8_t command;          // a Command
+    std::uint8_t reserved[3];
+};
+
+// The game as the command left it. digest is the session digest after the
+// command (see stateDigest), so a client running the same seed and commands
+// through its own PokerGame can check every reply.
+struct ActionReply {
+    std::uint64_t digest;
+    std::uint32_t sequence;
+    std::int32_t credits;
+    std::int32_t win;
+    std::uint16_t bet;
+    std::uint8_t applied;          // 0 when the command did nothing in this phase
+    std::uint8_t phase;            // a GamePhase
+    std::uint8_t heldMask;
+    std::uint8_t gambleCard;
+    std::uint8_t gambleResult;     // a GambleResult, for Low and High
+    std::uint8_t reserved;
+    std::array<Card, 5> hand;
+    std::uint8_t reserved2[7];
+};
+
+static_assert(sizeof(ClientHello) == 12, "client hello layout changed");
+static_assert(sizeof(ServerHello) == 24, "server hello layout changed");
+static_assert(sizeof(ActionRequest) == 8, "action request layout changed");
+static_assert(sizeof(ActionReply) == 40, "action reply layout changed");
+
+} // namespace SoftyPoker
+
+#endif // SERVER_PROTOCOL_H
@@ -0,0 +1,76 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "InputCommand.h"
+#include "PokerGame.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SoftyPoker {
+
+// One command that changed the game, and the simulation tick it ran on.
+struct SessionEvent {
+    std::uint32_t tick;
+    Command command;
+};
+
+// A table session as the seed it was dealt from plus the commands that were
+// carried out. PokerGame depends on nothing else, so playing the commands
+// back against the same seed reproduces every hand exactly; the recorded
+// outcome is kept alongside so a replay can prove it did.
+struct SessionLog {
+    std::uint64_t seed = 0;
+    int startingCredits = 20;
+    VariantId variant = VariantId::JacksOrBetter;
+    int hands = 1;                 // hands per round, see MultiHand
+    std::vector<SessionEvent> events;
+    std::uint32_t ticks = 0;       // length of the session
+    int finalCredits = 0;
+    std::uint64_t digest = 0;      // stateDigest folded over every event
+};
+
+// Carries a command out on the game, exactly as the table does. Returns
+// false when the command does nothing in the current phase; gambleResult is
+// only written for Low and High.
+bool applyCommand(PokerGame& game, Command command, GambleResult& gambleResult);
+
+// Folds everything observable about the game into a running digest.
+std::uint64_t stateDigest(std::uint64_t digest, const PokerGame& game);
+
+// What a session digest starts from, before any command.
+constexpr std::uint64_t SessionDigestSeed = 0xCBF29CE484222325ull;
+
+// Records the commands of a live session as they are applied.
+class SessionRecorder {
+public:
+    SessionRecorder(std::uint64_t seed, int startingCredits, VariantId variant = VariantId::JacksOrBetter, int hands = 1);
+    // Carries on recording a session rebuilt from the journal.
+    explicit SessionRecorder(const SessionLog& log);
+
+    void record(std::uint32_t tick, Command command, const PokerGame& game);
+    void finish(std::uint32_t ticks, const PokerGame& game);
+    const SessionLog& getLog() const;
+
+private:
+    SessionLog log;
+};
+
+struct ReplayResult {
+    bool matches;          // digest and final credits agree with the log
+    std::uint64_t digest;
+    int finalCredits;
+};
+
+// Plays a whole log back with no rendering, as fast as the rules run.
+ReplayResult replaySession(const SessionLog& log);
+
+// Compact little-endian file: a fixed header with the variant and hand
+// count, then per event the tick delta as a LEB128 varint and the command
+// byte. Files of any other format version are rejected.
+bool saveSession(const SessionLog& log, const std::string& path);
+bool loadSession(const std::string& path, SessionLog& log);
+
+} // namespace SoftyPoker
+
+#endif // SESSION_H
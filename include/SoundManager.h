@@ -2,25 +2,79 @@
 #define SOUNDMANAGER_H
 
 #include <SFML/Audio.hpp>
+#include <array>
+#include <cstdint>
+#include <future>
 #include <vector>
 #include <memory>
 #include <string>
 
+// Sound effects, one per file in Assets/sounds.
+enum class SoundId : std::uint8_t {
+    Bet,
+    Bet2,
+    Deal,
+    Held,
+    Unheld,
+    Count,
+    Prize,
+    Win,
+    Lose
+};
+
+constexpr std::size_t NumSoundIds = 9;
+
 class SoundManager {
 public:
     SoundManager();
     ~SoundManager();
 
+    // Builds the track catalog and opens the first track; only one stream is
+    // kept open, plus the prefetched next track and, while crossfading, the old one.
     void initializeMusic();
     void playRandomBackgroundMusic();
+    // Starts the prefetched track as the current one nears its end. Call once per frame.
+    void updateMusic(sf::Time elapsed);
+    // Pauses or resumes whatever music is playing, e.g. while the window is in the background.
+    void setMusicPaused(bool paused);
+    // Stops and closes every music stream, the prefetched one included, to
+    // give their file handles and buffers back. playRandomBackgroundMusic() starts over.
+    void stopMusic();
+    // Decodes every effect once; safe to run on a loader thread before play starts.
     void initializeGameSounds();
-    void playSound(const std::string& soundName);
+    // Starts an effect on a free voice, or steals the least important one.
+    // Allocation-free and bounded by MaxVoices, so it is fine to call in bursts.
+    void playSound(SoundId id);
 
 private:
-    std::vector<std::unique_ptr<sf::Music>> musicTracks;
-    sf::Music* currentMusic;
-    std::vector<sf::SoundBuffer> soundBuffers;
-    sf::Sound cardDealSound, heldSound, unheldSound, prizeSound, countSound, loseSound, winSound;
+    std::unique_ptr<sf::Music> openTrack(std::size_t index) const;
+    std::size_t pickNextTrack() const;
+    void prefetchNextTrack();
+    void startNextTrack();
+
+    std::vector<std::string> musicCatalog;
+    std::size_t currentTrack;
+    std::unique_ptr<sf::Music> currentMusic;
+    std::unique_ptr<sf::Music> fadingMusic;
+    std::future<std::unique_ptr<sf::Music>> nextMusic;
+    std::size_t nextTrack;
+    sf::Time fadeElapsed;
+    float musicVolume;
+    bool musicStarted;
+
+    struct Voice {
+        sf::Sound sound;
+        SoundId id = SoundId::Bet;
+        int priority = 0;
+        std::uint32_t startOrder = 0;
+    };
+
+    static constexpr std::size_t MaxVoices = 12;
+
+    std::array<std::shared_ptr<sf::SoundBuffer>, NumSoundIds> soundBuffers;   // from the ResourceCache
+    std::array<Voice, MaxVoices> voices;
+    std::uint32_t voiceCounter;
+    bool soundsLoaded;
 };
 
 #endif // SOUNDMANAGER_H
@@ -0,0 +1,27 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include "TextureAtlas.h"
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Collects textured quads from a TextureAtlas into one vertex array per
+// atlas page, so a whole layer costs one draw call per page.
+class SpriteBatch : public sf::Drawable {
+public:
+    explicit SpriteBatch(const TextureAtlas& atlas);
+
+    void clear();
+    void add(int region, sf::Vector2f position, sf::Vector2f size, sf::Color color = sf::Color::White);
+    // Keeps the region's aspect ratio and scales it to the given height.
+    void addScaled(int region, sf::Vector2f position, float height, sf::Color color = sf::Color::White);
+    float widthForHeight(int region, float height) const;
+
+private:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    const TextureAtlas& atlas;
+    std::vector<sf::VertexArray> pages;
+};
+
+#endif // SPRITE_BATCH_H
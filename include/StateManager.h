@@ -2,44 +2,71 @@
 #define STATEMANAGER_H
 
 #include "GameState.h"
-#include <unordered_map>
-#include <memory>
 #include <SFML/Graphics.hpp>
+#include <array>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
 
+// A stack of game states. Only the top state is updated, drawn and sees
+// events; the ones below it are suspended but keep their resources. Popping or
+// replacing a state destroys it, which is what gives its textures, fonts and
+// music back.
+//
+// push/pop/replace are deferred until the current update or event has been
+// dispatched, so a state can ask to leave from inside its own handlers.
 class StateManager {
-private:
-    std::unordered_map<std::string, std::unique_ptr<GameState>> states;
-    GameState* currentState = nullptr;
-
 public:
+    using Factory = std::function<std::unique_ptr<GameState>()>;
+
     StateManager() = default;
-    ~StateManager() = default;
-
-    void addState(const std::string& name, std::unique_ptr<GameState> state) {
-        states[name] = std::move(state);
-    }
-
-    void switchToState(const std::string& name) {
-        currentState = states[name].get();
-    }
-
-    void update(sf::RenderWindow& window) {
-        if (currentState) {
-            currentState->update(window);
-        }
-    }
-
-    void draw(sf::RenderWindow& window) {
-        if (currentState) {
-            currentState->draw(window);
-        }
-    }
-
-    void handleEvent(sf::Event& event, sf::RenderWindow& window) {  // Update to match new signature
-        if (currentState) {
-            currentState->handleEvent(event, window);
-        }
-    }
+    ~StateManager();
+
+    StateManager(const StateManager&) = delete;
+    StateManager& operator=(const StateManager&) = delete;
+
+    void registerState(StateId id, Factory factory);
+
+    // Starts constructing a state on a background thread (with its own GL
+    // context), so a later push or replace of it only has to wait for
+    // whatever is left of the construction.
+    void preload(StateId id);
+
+    void push(StateId id);
+    void pop();
+    void replace(StateId id);
+
+    bool isEmpty() const;
+
+    // True once after the top of the stack changed, so the new state gets drawn at least once.
+    bool takeSwitched();
+
+    void update(sf::RenderTarget& window, sf::Time step);
+    bool needsRedraw() const;
+    void draw(sf::RenderTarget& window);
+    void handleEvent(sf::Event& event, sf::RenderTarget& window);
+
+private:
+    enum class Change {
+        Push,
+        Pop,
+        Replace
+    };
+
+    struct PendingChange {
+        Change change;
+        StateId id;
+    };
+
+    std::unique_ptr<GameState> create(StateId id);
+    void applyPendingChanges();
+
+    std::array<Factory, NumStateIds> factories;
+    std::array<std::future<std::unique_ptr<GameState>>, NumStateIds> preloaded;
+    std::vector<std::unique_ptr<GameState>> stack;
+    std::vector<PendingChange> pending;
+    bool switched = false;
 };
 
 #endif // STATEMANAGER_H
@@ -2,11 +2,18 @@
 #define TEXT_SCROLL_H
 
 #include <SFML/Graphics.hpp>
+#include <string>
 
+// A single line of text scrolling right to left and wrapping around.
+// The glyph quads are built once, when the string, font or size changes;
+// scrolling only moves the transform and a color change rewrites vertex
+// colors, so a frame costs the same however long the text is and any number
+// of tickers can run side by side.
 class TextScroll : public sf::Drawable {
 public:
     TextScroll(const sf::Font& font, const std::string& textStr, float speed, float startY, float windowWidth);
 
+    void setString(const std::string& textStr);
     void setTextColor(const sf::Color& color);
     void enableSmoothColorTransition(bool enable);
     void update(sf::Time elapsed, sf::Time totalElapsed);
@@ -20,7 +27,16 @@ public:
 
 private:
     virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
-    sf::Text text;
+    void buildGlyphs();
+    void applyColor(const sf::Color& newColor);
+
+    const sf::Font* font;
+    sf::String string;
+    unsigned int characterSize;
+    sf::VertexArray glyphs;
+    sf::FloatRect bounds;
+    sf::Vector2f position;
+    sf::Color color;
     float speed;
     float windowWidth;
     bool enableColorTransition;
@@ -28,4 +44,3 @@ private:
 };
 
 #endif // TEXT_SCROLL_H
-
@@ -0,0 +1,52 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct AtlasRegion {
+    unsigned page;
+    sf::IntRect rect;
+};
+
+// Packs many small images into a few large textures at startup.
+// Images are queued with add(), packed by build(), and afterwards looked up
+// once by name; per-frame code keeps the integer region ids.
+class TextureAtlas {
+public:
+    explicit TextureAtlas(unsigned pageSize = 2048);
+    ~TextureAtlas();
+
+    // Loads the named asset; maxHeight > 0 downsamples it so it is at most that tall.
+    void add(const std::string& name, const std::string& assetName, unsigned maxHeight = 0);
+    void add(const std::string& name, const sf::Image& image);
+    // Packs everything added so far. Each page is cut down to the area its
+    // images cover, so a half-full page only costs the half it uses.
+    void build();
+    // Forgets every image and page, so the atlas can be filled again.
+    void clear();
+
+    int find(const std::string& name) const;
+    const AtlasRegion& getRegion(int id) const;
+    const sf::Texture& getPage(unsigned index) const;
+    unsigned getPageCount() const;
+
+private:
+    struct PendingImage {
+        int id;
+        sf::Image image;
+    };
+
+    void releasePages();
+
+    unsigned pageSize;
+    std::vector<PendingImage> pending;
+    std::vector<AtlasRegion> regions;
+    std::unordered_map<std::string, int> ids;
+    std::vector<std::unique_ptr<sf::Texture>> pages;
+};
+
+#endif // TEXTURE_ATLAS_H
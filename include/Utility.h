@@ -3,9 +3,30 @@
 
 #include <SFML/Graphics.hpp>
 #include <string>
+#include <vector>
 
-void resizeBackground(sf::RenderWindow& window, sf::Sprite& backgroundSprite, sf::Texture& backgroundTexture);
-
+// Location of a loose asset file, used when there is no asset pack.
 std::string getAssetPath(const std::string& relativePath);
 
+// Loose asset names under a directory prefix such as "images/backgrounds/".
+std::vector<std::string> listAssetFiles(const std::string& prefix);
+
+// GPU bytes held by a texture, assuming 32-bit RGBA; a mipmap chain adds a third.
+inline long long textureBytes(sf::Vector2u size, bool mipmapped = false) {
+    long long bytes = static_cast<long long>(size.x) * size.y * 4;
+    return mipmapped ? bytes * 4 / 3 : bytes;
+}
+
+inline long long textureBytes(const sf::Texture& texture, bool mipmapped = false) {
+    return textureBytes(texture.getSize(), mipmapped);
+}
+
+// Smallest size with the source's aspect ratio that still covers target,
+// never larger than the source itself: what a full-screen image needs to be
+// resampled to so it is never magnified.
+sf::Vector2u coverSize(sf::Vector2u source, sf::Vector2u target);
+
+// Box-filtered resize, for shrinking large source images at load time.
+sf::Image resampleImage(const sf::Image& source, unsigned width, unsigned height);
+
 #endif // UTILITY_H
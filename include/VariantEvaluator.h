@@ -0,0 +1,301 @@
+#ifndef VARIANT_EVALUATOR_H
+#define VARIANT_EVALUATOR_H
+
+#include "Card.h"
+#include "HandEvaluator.h"
+#include "PrizeTable.h"
+#include <array>
+#include <cstdint>
+
+namespace SoftyPoker {
+
+enum class WildCards : std::uint8_t {
+    None,
+    Deuces,      // the four twos
+    Joker        // one joker added to the deck
+};
+
+constexpr int MaxLadderRows = NumPrizes - 1;
+
+// Everything that makes one machine differ from another, known at compile time.
+struct VariantRules {
+    WildCards wild;
+    int deckSize;
+    int lowestPairRank;      // lowest paying pair, NumRanks when no pair pays
+    Prize pairPrize;
+    Paytable paytable;
+    int ladderRows;
+    std::array<Prize, MaxLadderRows> ladder;   // paying rows, lowest first
+};
+
+// 9/6 Jacks or Better, the Assets/images/table machine.
+inline constexpr VariantRules JacksOrBetterRules = {
+    WildCards::None, NumCards, 9, Prize::JacksOrBetter,
+    { { 0, 1, 2, 3, 4, 6, 9, 25, 50, 250, 0, 0, 0, 0 }, 4000 },
+    9, { Prize::JacksOrBetter, Prize::TwoPair, Prize::ThreeOfAKind, Prize::Straight, Prize::Flush,
+         Prize::FullHouse, Prize::FourOfAKind, Prize::StraightFlush, Prize::RoyalFlush }
+};
+
+// Full-pay Deuces Wild.
+inline constexpr VariantRules DeucesWildRules = {
+    WildCards::Deuces, NumCards, NumRanks, Prize::None,
+    { { 0, 0, 0, 1, 2, 2, 3, 5, 9, 250, 0, 15, 25, 200 }, 4000 },
+    10, { Prize::ThreeOfAKind, Prize::Straight, Prize::Flush, Prize::FullHouse, Prize::FourOfAKind,
+          Prize::StraightFlush, Prize::FiveOfAKind, Prize::WildRoyalFlush, Prize::FourDeuces, Prize::RoyalFlush }
+};
+
+// Kings-or-better Joker Poker, 20/7/5.
+inline constexpr VariantRules JokerPokerRules = {
+    WildCards::Joker, NumCards + 1, 11, Prize::KingsOrBetter,
+    { { 0, 0, 1, 2, 3, 5, 7, 20, 50, 250, 1, 200, 100, 0 }, 4000 },
+    11, { Prize::KingsOrBetter, Prize::TwoPair, Prize::ThreeOfAKind, Prize::Straight, Prize::Flush,
+          Prize::FullHouse, Prize::FourOfAKind, Prize::StraightFlush, Prize::WildRoyalFlush,
+          Prize::FiveOfAKind, Prize::RoyalFlush }
+};
+
+// Lookup tables built at compile time, one set per variant.
+//
+// A hand with wild cards is never expanded into substitutions. What a set
+// of wild cards can make out of the natural cards depends only on how many
+// wild cards there are, how the naturals pair up (the number of equal pairs
+// among them: 0 all different, 1 a pair, 2 two pair, 3 trips, 4 a full
+// house, 6 quads), and four yes/no facts: the naturals fit in one straight,
+// they fit in a royal, they share a suit, and the best pair they can make
+// pays. That is at most 5 x 11 x 16 cases, each resolved here once.
+namespace VariantTables {
+    constexpr int MaxWild = 4;
+    constexpr int MaxEqualPairs = 10;
+
+    enum Flag : std::uint8_t {
+        FitsStraight = 1,
+        FitsRoyal = 2,
+        Suited = 4,
+        PairPays = 8
+    };
+
+    // FitsStraight and FitsRoyal for every 13-bit mask of natural ranks.
+    struct RankMaskInfo {
+        std::uint8_t flags[1 << NumRanks];
+    };
+
+    constexpr RankMaskInfo buildRankMaskInfo() {
+        // Five-rank windows from the wheel (A-2-3-4-5) up to ten-to-ace
+        constexpr int windows[10] = { 0x100F, 0x001F, 0x003E, 0x007C, 0x00F8, 0x01F0, 0x03E0, 0x07C0, 0x0F80, 0x1F00 };
+        RankMaskInfo info{};
+        for (int mask = 0; mask < (1 << NumRanks); ++mask) {
+            std::uint8_t flags = 0;
+            for (int window : windows) {
+                if ((mask & ~window) == 0) {
+                    flags |= FitsStraight;
+                }
+            }
+            if ((mask & ~0x1F00) == 0) {
+                flags |= FitsRoyal;
+            }
+            info.flags[mask] = flags;
+        }
+        return info;
+    }
+
+    inline constexpr RankMaskInfo rankMaskInfo = buildRankMaskInfo();
+
+    // A hand's rank counts are the sum of its cards' count words: four bits
+    // per rank, lowest rank first, and the number of wild cards above them.
+    constexpr int WildShift = 4 * NumRanks;
+    constexpr int SuitShift = 16;
+    constexpr std::uint64_t LowBits = 0x1111111111111ull;      // bit 0 of each rank's count
+
+    struct Data {
+        std::uint64_t countWord[MaxDeckSize];
+        std::uint32_t maskBits[MaxDeckSize];      // rank bit, suit bit at SuitShift; 0 for a wild card
+        // Count bits that make a paying pair, by number of wild cards: two
+        // or more of a paying rank without one, any of a paying rank with one
+        std::uint64_t pairingBits[MaxWild + 1];
+        std::uint8_t prize[MaxWild + 1][MaxEqualPairs + 1][16];
+        std::uint8_t naturalPrize[HandTables::NumHandRanks + 1];   // by HandEvaluator rank
+    };
+
+    constexpr bool isWild(const VariantRules& rules, int card) {
+        return (rules.wild == WildCards::Deuces && card < NumCards && cardRank(static_cast<Card>(card)) == 0)
+            || (rules.wild == WildCards::Joker && card == Joker);
+    }
+
+    constexpr int pays(const VariantRules& rules, Prize prize) {
+        return rules.paytable.multiplier[static_cast<int>(prize)];
+    }
+
+    // Keeps whichever of two prizes pays more; on a tie the one higher on the ladder.
+    constexpr Prize better(const VariantRules& rules, Prize a, Prize b) {
+        if (pays(rules, a) != pays(rules, b)) {
+            return pays(rules, a) > pays(rules, b) ? a : b;
+        }
+        int rowA = -1;
+        int rowB = -1;
+        for (int row = 0; row < rules.ladderRows; ++row) {
+            rowA = rules.ladder[row] == a ? row : rowA;
+            rowB = rules.ladder[row] == b ? row : rowB;
+        }
+        return rowB > rowA ? b : a;
+    }
+
+    // The best paying hand for one case; None when the case cannot occur.
+    constexpr Prize resolve(const VariantRules& rules, int wild, int equalPairs, int flags) {
+        const int naturals = 5 - wild;
+        // Largest group of one rank among the naturals, from the equal pairs
+        int group = 0;
+        switch (equalPairs) {
+        case 0: group = naturals > 0 ? 1 : 0; break;
+        case 1: group = 2; break;
+        case 2: group = 2; break;     // two pair
+        case 3: group = 3; break;
+        case 4: group = 3; break;     // full house
+        case 6: group = 4; break;
+        default: return Prize::None;
+        }
+        if (naturals < 0 || group > naturals || (equalPairs == 2 && naturals < 4) || (equalPairs == 4 && naturals < 5)) {
+            return Prize::None;
+        }
+
+        Prize best = Prize::None;
+        int ofAKind = group + wild;
+        if (rules.wild == WildCards::Deuces && wild == 4) {
+            best = better(rules, best, Prize::FourDeuces);
+        }
+        if (ofAKind >= 5) {
+            best = better(rules, best, Prize::FiveOfAKind);
+        }
+        if (ofAKind >= 4) {
+            best = better(rules, best, Prize::FourOfAKind);
+        }
+        // A wild card turns two pair into a full house; a natural full house is one already
+        if ((equalPairs == 2 && wild == 1) || equalPairs == 4) {
+            best = better(rules, best, Prize::FullHouse);
+        }
+        if (ofAKind >= 3) {
+            best = better(rules, best, Prize::ThreeOfAKind);
+        }
+        if (equalPairs == 2 && wild == 0) {
+            best = better(rules, best, Prize::TwoPair);
+        }
+        if (ofAKind == 2 && (flags & PairPays)) {
+            best = better(rules, best, rules.pairPrize);
+        }
+        if (equalPairs == 0) {
+            bool straight = flags & FitsStraight;
+            bool flush = flags & Suited;
+            if (straight) {
+                best = better(rules, best, Prize::Straight);
+            }
+            if (flush) {
+                best = better(rules, best, Prize::Flush);
+            }
+            if (straight && flush) {
+                best = better(rules, best, Prize::StraightFlush);
+            }
+            if ((flags & FitsRoyal) && flush) {
+                best = better(rules, best, wild > 0 ? Prize::WildRoyalFlush : Prize::RoyalFlush);
+            }
+        }
+        return pays(rules, best) > 0 ? best : Prize::None;
+    }
+
+    // Prize for a HandEvaluator rank, for variants without wild cards. Pairs
+    // are ranked aces first, 220 ranks per pair rank.
+    constexpr Prize naturalPrize(const VariantRules& rules, int rank) {
+        Prize prize = Prize::None;
+        if (rank == 1) {
+            prize = Prize::RoyalFlush;
+        } else if (rank <= 10) {
+            prize = Prize::StraightFlush;
+        } else if (rank <= 166) {
+            prize = Prize::FourOfAKind;
+        } else if (rank <= 322) {
+            prize = Prize::FullHouse;
+        } else if (rank <= 1599) {
+            prize = Prize::Flush;
+        } else if (rank <= 1609) {
+            prize = Prize::Straight;
+        } else if (rank <= 2467) {
+            prize = Prize::ThreeOfAKind;
+        } else if (rank <= 3325) {
+            prize = Prize::TwoPair;
+        } else if (rank <= 6185 && NumRanks - 1 - (rank - 3326) / 220 >= rules.lowestPairRank) {
+            prize = rules.pairPrize;
+        }
+        return pays(rules, prize) > 0 ? prize : Prize::None;
+    }
+
+    constexpr Data build(const VariantRules& rules) {
+        Data data{};
+        for (int card = 0; card < MaxDeckSize; ++card) {
+            bool wild = isWild(rules, card);
+            bool natural = card < NumCards && !wild;
+            data.countWord[card] = wild ? 1ull << WildShift
+                                 : natural ? 1ull << (4 * cardRank(static_cast<Card>(card))) : 0;
+            data.maskBits[card] = natural ? (1u << cardRank(static_cast<Card>(card)))
+                                          | (1u << (SuitShift + cardSuit(static_cast<Card>(card)))) : 0;
+        }
+        for (int rank = rules.lowestPairRank; rank < NumRanks; ++rank) {
+            data.pairingBits[0] |= 0xEull << (4 * rank);
+            data.pairingBits[1] |= 0xFull << (4 * rank);
+        }
+        for (int wild = 0; wild <= MaxWild; ++wild) {
+            for (int equalPairs = 0; equalPairs <= MaxEqualPairs; ++equalPairs) {
+                for (int flags = 0; flags < 16; ++flags) {
+                    data.prize[wild][equalPairs][flags] = static_cast<std::uint8_t>(resolve(rules, wild, equalPairs, flags));
+                }
+            }
+        }
+        for (int rank = 1; rank <= HandTables::NumHandRanks; ++rank) {
+            data.naturalPrize[rank] = static_cast<std::uint8_t>(naturalPrize(rules, rank));
+        }
+        return data;
+    }
+}
+
+// Prize evaluation compiled for one variant. Without wild cards it is the
+// HandEvaluator rank mapped through the variant's prize table; with them it
+// is the case lookup above, with no branches on the cards either way.
+template <const VariantRules& Rules>
+class VariantEvaluator {
+public:
+    static constexpr VariantTables::Data tables = VariantTables::build(Rules);
+
+    static Prize evaluate(Card c0, Card c1, Card c2, Card c3, Card c4) {
+        const VariantTables::Data& t = tables;
+        if constexpr (Rules.wild == WildCards::None) {
+            return static_cast<Prize>(t.naturalPrize[HandEvaluator::evaluate(c0, c1, c2, c3, c4)]);
+        } else {
+            std::uint64_t counts = t.countWord[c0] + t.countWord[c1] + t.countWord[c2] + t.countWord[c3] + t.countWord[c4];
+            std::uint32_t bits = t.maskBits[c0] | t.maskBits[c1] | t.maskBits[c2] | t.maskBits[c3] | t.maskBits[c4];
+            unsigned ranks = bits & ((1u << NumRanks) - 1);
+            unsigned suits = bits >> VariantTables::SuitShift;
+            unsigned wild = static_cast<unsigned>(counts >> VariantTables::WildShift);
+
+            // One bit per rank held exactly twice, three times, four times
+            const std::uint64_t low = VariantTables::LowBits;
+            std::uint64_t twice = (counts >> 1) & ~counts & low;
+            std::uint64_t thrice = counts & (counts >> 1) & low;
+            std::uint64_t fourTimes = (counts >> 2) & low;
+            // The multiply adds up the rank bits into the top four bits
+            unsigned pairs = static_cast<unsigned>(((twice * low) >> 48) & 0xF);
+            unsigned equalPairs = pairs + 3 * (thrice != 0) + 6 * (fourTimes != 0);
+
+            // A paying pair is a paying rank held twice, or held once next to
+            // a wild card; one mask per wild count says which count bits
+            // those are, so no variant pays for the test with arithmetic
+            unsigned flags = VariantTables::rankMaskInfo.flags[ranks]
+                           | ((suits & (suits - 1)) == 0 ? VariantTables::Suited : 0)
+                           | ((counts & t.pairingBits[wild]) != 0 ? VariantTables::PairPays : 0);
+            return static_cast<Prize>(t.prize[wild][equalPairs][flags]);
+        }
+    }
+
+    static Prize evaluate(const Card* cards) {
+        return evaluate(cards[0], cards[1], cards[2], cards[3], cards[4]);
+    }
+};
+
+} // namespace SoftyPoker
+
+#endif // VARIANT_EVALUATOR_H
@@ -0,0 +1,51 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SoftyPoker {
+
+// Fixed set of worker threads, each with its own task deque.
+// Workers run their own tasks newest-first and steal the oldest task from
+// another worker when they run dry, so uneven jobs still spread across cores.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threadCount = std::thread::hardware_concurrency());
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(std::function<void()> task);
+    unsigned size() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void run(unsigned index);
+    bool takeTask(unsigned index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    // Only taken by a worker going to sleep and by a submit that finds one asleep
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<int> sleepers;
+    std::atomic<int> pendingTasks;
+    std::atomic<unsigned> nextWorker;
+    std::atomic<bool> stopping;
+};
+
+} // namespace SoftyPoker
+
+#endif // WORK_STEALING_POOL_H
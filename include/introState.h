@@ -2,46 +2,57 @@
 #define INTRO_STATE_H
 
 #include <SFML/Graphics.hpp>
+#include <functional>
+#include <memory>
 #include "GameState.h"
+#include "Animator.h"
+#include "AssetLoader.h"
 #include "SoundManager.h"
 #include "TextScroll.h"
-#include "LogoAnimation.h"
 #include "BackgroundHandler.h"
+#include "ResourceCache.h"
 
 namespace SoftyPoker {
 
+// Everything the intro needs, requested up front so it can load behind the loading screen.
+struct IntroAssets {
+    std::string backgroundName;
+    AssetHandle<sf::Texture> background;
+    AssetHandle<sf::Texture> logo;
+    AssetHandle<sf::Font> font;
+};
+
 class IntroState : public GameState {
 public:
-    IntroState(SoundManager& sp, sf::RenderWindow& window);
+    // onStart runs when the player presses S.
+    IntroState(SoundManager& sp, sf::RenderTarget& window, const IntroAssets& assets, std::function<void()> onStart);
 
-    void resizeElements(sf::RenderWindow& window);
-    void update(sf::RenderWindow& window) override;
-    void draw(sf::RenderWindow& window) override;
-    void handleEvent(sf::Event& event, sf::RenderWindow& window) override;
+    // Picks a random background and queues the intro's textures, font, music
+    // and sound effects, with the textures shrunk to what displaySize shows.
+    static IntroAssets requestAssets(AssetLoader& loader, SoundManager& sp, sf::Vector2u displaySize);
 
-private:
-    void animateLogo();
-    void scrollText(sf::RenderWindow& window, sf::Time elapsed);
+    void resizeElements(sf::RenderTarget& window);
+    void update(sf::RenderTarget& window, sf::Time step) override;
+    void draw(sf::RenderTarget& window) override;
+    void handleEvent(sf::Event& event, sf::RenderTarget& window) override;
+    void onEnter() override;
+    void onExit() override;
 
+private:
+    // First, so the intro's assets leave the cache after every member has let go
+    CacheEviction cacheEviction;
     SoundManager& soundPlayer;
-    sf::Font font;
+    std::function<void()> onStart;
+    std::shared_ptr<sf::Font> font;
+    std::shared_ptr<sf::Texture> logoTexture;
     TextScroll firstLine;
     TextScroll secondLine;
-    LogoAnimation logoAnimation;
     sf::Sprite logoSprite;
-    sf::Texture logoTexture;
-    sf::Sprite backgroundSprite;
-    sf::Texture backgroundTexture;
+    float logoAlpha;
     BackgroundHandler backgroundHandler;
-    std::vector<std::string> backgroundFiles;
-    sf::Clock clock;
-    sf::Clock fadeClock;
-    float fadeDuration;
-    float pauseDuration;
     sf::Time totalElapsed;
-    float firstLineSpeed;
-    float secondLineSpeed;
     sf::Text instructionText; // Add this line
+    Animator animator;
 };
 
 } // namespace SoftyPoker
@@ -0,0 +1,217 @@
+#include "Animator.h"
+#include <algorithm>
+
+namespace SoftyPoker {
+
+float applyEase(Ease ease, float t) {
+    switch (ease) {
+    case Ease::Linear:
+        return t;
+    case Ease::InQuad:
+        return t * t;
+    case Ease::OutQuad:
+        return t * (2.0f - t);
+    case Ease::InOutQuad:
+        return t < 0.5f ? 2.0f * t * t : -1.0f + (4.0f - 2.0f * t) * t;
+    case Ease::OutCubic: {
+        float u = t - 1.0f;
+        return u * u * u + 1.0f;
+    }
+    case Ease::OutBack: {
+        const float overshoot = 1.70158f;
+        float u = t - 1.0f;
+        return 1.0f + u * u * ((overshoot + 1.0f) * u + overshoot);
+    }
+    }
+    return t;
+}
+
+Animator::Animator()
+    : lastGroup(NoGroup),
+      anyDone(false) {}
+
+Animator::Group Animator::newGroup() {
+    return ++lastGroup;
+}
+
+void Animator::tween(float& target, float fromValue, float toValue, float seconds,
+                     Ease curve, float startDelay, Group group) {
+    targets.push_back(&target);
+    from.push_back(fromValue);
+    delta.push_back(toValue - fromValue);
+    delay.push_back(startDelay);
+    duration.push_back(seconds);
+    elapsed.push_back(0.0f);
+    period.push_back(0.0f);
+    ease.push_back(curve);
+    groups.push_back(group);
+    done.push_back(0);
+}
+
+void Animator::tween(sf::Vector2f& target, sf::Vector2f fromValue, sf::Vector2f toValue, float seconds,
+                     Ease curve, float startDelay, Group group) {
+    tween(target.x, fromValue.x, toValue.x, seconds, curve, startDelay, group);
+    tween(target.y, fromValue.y, toValue.y, seconds, curve, startDelay, group);
+}
+
+void Animator::update(sf::Time step) {
+    const float dt = step.asSeconds();
+    const std::size_t count = targets.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        float time = elapsed[i] + dt;
+        if (period[i] > 0.0f && time >= period[i]) {
+            time -= period[i];
+        }
+        elapsed[i] = time;
+
+        float local = time - delay[i];
+        if (local < 0.0f) {
+            continue;
+        }
+        float t = 1.0f;
+        if (local < duration[i]) {
+            t = local / duration[i];
+        } else if (period[i] == 0.0f) {
+            done[i] = 1;
+            anyDone = true;
+        }
+        *targets[i] = from[i] + delta[i] * applyEase(ease[i], t);
+    }
+    if (anyDone) {
+        removeFinished();
+    }
+}
+
+void Animator::repeat(Group group, float seconds) {
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        if (groups[i] == group) {
+            period[i] = seconds;
+        }
+    }
+}
+
+void Animator::finish(Group group) {
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        if (groups[i] == group) {
+            *targets[i] = from[i] + delta[i];
+            done[i] = 1;
+            anyDone = true;
+        }
+    }
+    removeFinished();
+}
+
+void Animator::cancel(Group group) {
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        if (groups[i] == group) {
+            done[i] = 1;
+            anyDone = true;
+        }
+    }
+    removeFinished();
+}
+
+void Animator::clear() {
+    targets.clear();
+    from.clear();
+    delta.clear();
+    delay.clear();
+    duration.clear();
+    elapsed.clear();
+    period.clear();
+    ease.clear();
+    groups.clear();
+    done.clear();
+    anyDone = false;
+}
+
+bool Animator::isRunning(Group group) const {
+    return std::find(groups.begin(), groups.end(), group) != groups.end();
+}
+
+std::size_t Animator::size() const {
+    return targets.size();
+}
+
+void Animator::removeFinished() {
+    // Compacts every array in the same pass, keeping the order tweens were
+    // added in so the last one added still wins
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        if (done[i]) {
+            continue;
+        }
+        if (kept != i) {
+            targets[kept] = targets[i];
+            from[kept] = from[i];
+            delta[kept] = delta[i];
+            delay[kept] = delay[i];
+            duration[kept] = duration[i];
+            elapsed[kept] = elapsed[i];
+            period[kept] = period[i];
+            ease[kept] = ease[i];
+            groups[kept] = groups[i];
+            done[kept] = 0;
+        }
+        ++kept;
+    }
+    targets.resize(kept);
+    from.resize(kept);
+    delta.resize(kept);
+    delay.resize(kept);
+    duration.resize(kept);
+    elapsed.resize(kept);
+    period.resize(kept);
+    ease.resize(kept);
+    groups.resize(kept);
+    done.resize(kept);
+    anyDone = false;
+}
+
+Sequence::Sequence(Animator& animator, float startDelay)
+    : animator(animator),
+      group(animator.newGroup()),
+      stepStart(startDelay),
+      cursor(startDelay) {}
+
+Sequence& Sequence::then(float& target, float from, float to, float duration, Ease ease) {
+    stepStart = cursor;
+    return with(target, from, to, duration, ease);
+}
+
+Sequence& Sequence::then(sf::Vector2f& target, sf::Vector2f from, sf::Vector2f to, float duration, Ease ease) {
+    stepStart = cursor;
+    return with(target, from, to, duration, ease);
+}
+
+Sequence& Sequence::with(float& target, float from, float to, float duration, Ease ease) {
+    animator.tween(target, from, to, duration, ease, stepStart, group);
+    cursor = std::max(cursor, stepStart + duration);
+    return *this;
+}
+
+Sequence& Sequence::with(sf::Vector2f& target, sf::Vector2f from, sf::Vector2f to, float duration, Ease ease) {
+    animator.tween(target, from, to, duration, ease, stepStart, group);
+    cursor = std::max(cursor, stepStart + duration);
+    return *this;
+}
+
+Sequence& Sequence::wait(float seconds) {
+    cursor += seconds;
+    stepStart = cursor;
+    return *this;
+}
+
+void Sequence::loop() {
+    animator.repeat(group, cursor);
+}
+
+Animator::Group Sequence::getGroup() const {
+    return group;
+}
+
+float Sequence::getDuration() const {
+    return cursor;
+}
+
+} // namespace SoftyPoker
@@ -0,0 +1,178 @@
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "Profiler.h"
+#include "ResourceCache.h"
+#include "Utility.h"
+#include "Log.h"
+#include <algorithm>
+
+namespace SoftyPoker {
+
+namespace {
+
+// Rows copied per Texture::update call; a 1920 wide strip is about 500 KB.
+constexpr unsigned UploadRows = 64;
+
+}
+
+AssetLoader::AssetLoader(unsigned threadCount)
+    : requested(0),
+      finished(0),
+      workers(std::max(1u, threadCount)) {
+}
+
+template <typename T>
+AssetHandle<T> AssetLoader::decode(const std::string& name, std::function<std::shared_ptr<T>()> load) {
+    auto slot = std::make_shared<AssetSlot<T>>(name);
+    requested.fetch_add(1, std::memory_order_relaxed);
+
+    workers.submit([this, slot, load]() {
+        PROFILE_SCOPE("AssetLoader::decode");
+        std::shared_ptr<T> asset = load();
+        if (!asset) {
+            LOG_DEBUG("Failed to load asset: {}", slot->getName());
+        }
+        slot->finish(std::move(asset));
+        finishOne();
+    });
+    return slot;
+}
+
+AssetHandle<sf::Texture> AssetLoader::loadTexture(const std::string& name, bool smooth, sf::Vector2u fitTo) {
+    std::string key = ResourceCache::textureKey(name, smooth, fitTo);
+    auto slot = std::make_shared<AssetSlot<sf::Texture>>(name);
+    if (std::shared_ptr<sf::Texture> cached = resourceCache().find<sf::Texture>(key)) {
+        slot->finish(std::move(cached));
+        return slot;
+    }
+    {
+        std::lock_guard<std::mutex> lock(uploadMutex);
+        auto pending = pendingTextures.find(key);
+        if (pending != pendingTextures.end()) {
+            return pending->second;
+        }
+        pendingTextures.emplace(key, slot);
+    }
+    requested.fetch_add(1, std::memory_order_relaxed);
+
+    workers.submit([this, slot, key, smooth, fitTo]() {
+        PROFILE_SCOPE("AssetLoader::decodeImage");
+        auto image = std::make_unique<sf::Image>();
+        if (!loadAsset(*image, slot->getName())) {
+            LOG_DEBUG("Failed to load asset: {}", slot->getName());
+            {
+                std::lock_guard<std::mutex> lock(uploadMutex);
+                pendingTextures.erase(key);
+            }
+            slot->finish(nullptr);
+            finishOne();
+            return;
+        }
+        if (fitTo.x > 0 && fitTo.y > 0) {
+            sf::Vector2u size = coverSize(image->getSize(), fitTo);
+            if (size != image->getSize()) {
+                PROFILE_SCOPE("AssetLoader::resample");
+                *image = resampleImage(*image, size.x, size.y);
+            }
+        }
+        std::lock_guard<std::mutex> lock(uploadMutex);
+        uploads.push_back({ std::move(image), nullptr, slot, key, smooth, 0 });
+    });
+    return slot;
+}
+
+// Images are only decoded to be turned into something else, so they are not cached
+AssetHandle<sf::Image> AssetLoader::loadImage(const std::string& name) {
+    return decode<sf::Image>(name, [name]() {
+        auto image = std::make_shared<sf::Image>();
+        if (!loadAsset(*image, name)) {
+            return std::shared_ptr<sf::Image>();
+        }
+        return image;
+    });
+}
+
+AssetHandle<sf::Font> AssetLoader::loadFont(const std::string& name) {
+    return decode<sf::Font>(name, [name]() { return resourceCache().font(name); });
+}
+
+AssetHandle<sf::SoundBuffer> AssetLoader::loadSoundBuffer(const std::string& name) {
+    return decode<sf::SoundBuffer>(name, [name]() { return resourceCache().soundBuffer(name); });
+}
+
+void AssetLoader::runTask(std::function<void()> task) {
+    requested.fetch_add(1, std::memory_order_relaxed);
+    workers.submit([this, task]() {
+        PROFILE_SCOPE("AssetLoader::runTask");
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOG_ERROR("{}", e.what());
+        }
+        finishOne();
+    });
+}
+
+bool AssetLoader::uploadPending(sf::Time budget) {
+    PROFILE_SCOPE("AssetLoader::uploadPending");
+    sf::Clock clock;
+    while (clock.getElapsedTime() < budget) {
+        std::unique_lock<std::mutex> lock(uploadMutex);
+        if (uploads.empty()) {
+            return true;
+        }
+        PendingUpload& upload = uploads.front();
+        lock.unlock();
+
+        // Only this thread touches the front entry; workers just append.
+        sf::Vector2u size = upload.image->getSize();
+        if (!upload.texture) {
+            upload.texture = makeTrackedTexture(textureBytes(size, upload.smooth));
+            if (!upload.texture->create(size.x, size.y)) {
+                upload.texture.reset();
+                upload.nextRow = size.y;
+            }
+        }
+
+        if (upload.nextRow < size.y) {
+            unsigned rows = std::min(UploadRows, size.y - upload.nextRow);
+            const sf::Uint8* pixels = upload.image->getPixelsPtr() + upload.nextRow * size.x * 4;
+            upload.texture->update(pixels, size.x, rows, 0, upload.nextRow);
+            upload.nextRow += rows;
+        }
+
+        if (upload.nextRow >= size.y) {
+            if (upload.texture) {
+                upload.texture->setSmooth(upload.smooth);
+                if (upload.smooth) {
+                    upload.texture->generateMipmap();
+                }
+                long long bytes = textureBytes(size, upload.smooth);
+                upload.texture = resourceCache().insert(upload.key, std::move(upload.texture), static_cast<std::size_t>(bytes));
+            }
+            upload.slot->finish(std::move(upload.texture));
+            lock.lock();
+            pendingTextures.erase(upload.key);
+            uploads.pop_front();
+            lock.unlock();
+            finishOne();
+        }
+    }
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    return uploads.empty();
+}
+
+float AssetLoader::getProgress() const {
+    int total = requested.load(std::memory_order_relaxed);
+    return total ? static_cast<float>(finished.load(std::memory_order_acquire)) / total : 1.0f;
+}
+
+bool AssetLoader::isIdle() const {
+    return finished.load(std::memory_order_acquire) == requested.load(std::memory_order_relaxed);
+}
+
+void AssetLoader::finishOne() {
+    finished.fetch_add(1, std::memory_order_release);
+}
+
+} // namespace SoftyPoker
@@ -0,0 +1,242 @@
+#include "AssetPack.h"
+#include "Log.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SoftyPoker {
+
+namespace {
+
+const char* DefaultPackPath = "softypoker.pak";
+
+}
+
+AssetPack::AssetPack()
+    : base(nullptr),
+      mappedSize(0),
+      fileHandle(nullptr),
+      mappingHandle(nullptr),
+      header(nullptr),
+      entries(nullptr),
+      names(nullptr) {}
+
+AssetPack::~AssetPack() {
+    close();
+}
+
+bool AssetPack::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    mappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+    base = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size <= 0) {
+        ::close(file);
+        return false;
+    }
+    mappedSize = static_cast<std::size_t>(info.st_size);
+    void* mapped = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping keeps the file alive on its own.
+    ::close(file);
+    base = mapped == MAP_FAILED ? nullptr : static_cast<const std::uint8_t*>(mapped);
+#endif
+
+    if (!base) {
+        close();
+        return false;
+    }
+
+    header = reinterpret_cast<const Pack::Header*>(base);
+    bool valid = mappedSize >= sizeof(Pack::Header);
+    std::uint64_t tableEnd = valid ? sizeof(Pack::Header) + std::uint64_t(header->entryCount) * sizeof(Pack::Entry) : 0;
+    valid = valid &&
+            std::memcmp(header->magic, Pack::Magic, sizeof(Pack::Magic)) == 0 &&
+            header->version == Pack::Version &&
+            tableEnd <= header->namesOffset &&
+            header->namesOffset + header->namesSize <= mappedSize;
+
+    if (valid) {
+        entries = reinterpret_cast<const Pack::Entry*>(base + sizeof(Pack::Header));
+        names = reinterpret_cast<const char*>(base + header->namesOffset);
+        for (std::uint32_t i = 0; i < header->entryCount && valid; ++i) {
+            const Pack::Entry& entry = entries[i];
+            valid = entry.offset + entry.storedSize <= mappedSize &&
+                    std::uint64_t(entry.nameOffset) + entry.nameLength <= header->namesSize &&
+                    entry.compression <= Pack::Lz;
+        }
+    }
+    if (!valid) {
+        LOG_DEBUG("Ignoring invalid asset pack: {}", path);
+        close();
+        return false;
+    }
+
+    LOG_DEBUG("Mapped asset pack {} ({} entries)", path, header->entryCount);
+    return true;
+}
+
+void AssetPack::close() {
+    unpacked.clear();
+#ifdef _WIN32
+    if (base) {
+        UnmapViewOfFile(base);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+#else
+    if (base) {
+        munmap(const_cast<std::uint8_t*>(base), mappedSize);
+    }
+#endif
+    base = nullptr;
+    mappedSize = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+    header = nullptr;
+    entries = nullptr;
+    names = nullptr;
+}
+
+bool AssetPack::isOpen() const {
+    return base != nullptr;
+}
+
+bool AssetPack::contains(const std::string& name) const {
+    return findEntry(name) != nullptr;
+}
+
+bool AssetPack::read(const std::string& name, AssetView& view) {
+    const Pack::Entry* entry = findEntry(name);
+    if (!entry) {
+        return false;
+    }
+    if (entry->compression == Pack::Stored) {
+        view = AssetView{ base + entry->offset, static_cast<std::size_t>(entry->size) };
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(unpackMutex);
+    auto& buffer = unpacked[entry];
+    if (!buffer) {
+        auto data = std::make_unique<std::vector<std::uint8_t>>(static_cast<std::size_t>(entry->size));
+        if (!Pack::decompress(base + entry->offset, static_cast<std::size_t>(entry->storedSize), data->data(), data->size())) {
+            LOG_DEBUG("Corrupt asset in pack: {}", name);
+            unpacked.erase(entry);
+            return false;
+        }
+        buffer = std::move(data);
+    }
+    view = AssetView{ buffer->data(), buffer->size() };
+    return true;
+}
+
+std::vector<std::string> AssetPack::list(const std::string& prefix) const {
+    std::vector<std::string> result;
+    if (!base) {
+        return result;
+    }
+    const Pack::Entry* end = entries + header->entryCount;
+    const Pack::Entry* first = std::lower_bound(entries, end, prefix, [this](const Pack::Entry& entry, const std::string& key) {
+        return entryName(entry) < key;
+    });
+    for (const Pack::Entry* entry = first; entry != end; ++entry) {
+        std::string name = entryName(*entry);
+        if (name.compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+        result.push_back(name);
+    }
+    return result;
+}
+
+const Pack::Entry* AssetPack::findEntry(const std::string& name) const {
+    if (!base) {
+        return nullptr;
+    }
+    const Pack::Entry* end = entries + header->entryCount;
+    const Pack::Entry* entry = std::lower_bound(entries, end, name, [this](const Pack::Entry& candidate, const std::string& key) {
+        return key.compare(0, std::string::npos, names + candidate.nameOffset, candidate.nameLength) > 0;
+    });
+    if (entry == end || name.compare(0, std::string::npos, names + entry->nameOffset, entry->nameLength) != 0) {
+        return nullptr;
+    }
+    return entry;
+}
+
+std::string AssetPack::entryName(const Pack::Entry& entry) const {
+    return std::string(names + entry.nameOffset, entry.nameLength);
+}
+
+AssetPack& assetPack() {
+    static AssetPack pack;
+    static std::once_flag opened;
+    std::call_once(opened, []() { pack.open(DefaultPackPath); });
+    return pack;
+}
+
+bool readAssetBytes(const std::string& name, std::vector<std::uint8_t>& bytes) {
+    AssetView view;
+    if (assetPack().read(name, view)) {
+        const std::uint8_t* data = static_cast<const std::uint8_t*>(view.data);
+        bytes.assign(data, data + view.size);
+        return true;
+    }
+    std::ifstream file(getAssetPath(name), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+std::vector<std::string> listAssets(const std::string& prefix) {
+    if (assetPack().isOpen()) {
+        return assetPack().list(prefix);
+    }
+    return listAssetFiles(prefix);
+}
+
+} // namespace SoftyPoker
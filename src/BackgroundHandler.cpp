@@ -1,24 +1,84 @@
 #include "BackgroundHandler.h"
+#include "Profiler.h"
+#include "ResourceCache.h"
+#include "Utility.h"
+#include "Log.h"
+#include <algorithm>
+#include <stdexcept>
 
-BackgroundHandler::BackgroundHandler(const sf::Texture& texture) {
-    sprite.setTexture(texture);
+BackgroundHandler::BackgroundHandler(const std::string& assetName, sf::RenderTarget& window)
+    : assetName(assetName) {
+    resample(window.getSize());
+    resize(window);
 }
 
-void BackgroundHandler::resize(sf::RenderWindow& window) {
-    float windowRatio = static_cast<float>(window.getSize().x) / window.getSize().y;
-    float textureRatio = static_cast<float>(sprite.getTexture()->getSize().x) / sprite.getTexture()->getSize().y;
-    float scale;
-    if (windowRatio > textureRatio) {
-        scale = static_cast<float>(window.getSize().x) / sprite.getTexture()->getSize().x;
-    } else {
-        scale = static_cast<float>(window.getSize().y) / sprite.getTexture()->getSize().y;
+BackgroundHandler::BackgroundHandler(const std::string& assetName, std::shared_ptr<sf::Texture> texture)
+    : assetName(assetName),
+      texture(std::move(texture)) {
+    sprite.setTexture(*this->texture, true);
+}
+
+void BackgroundHandler::resize(sf::RenderTarget& window) {
+    sf::Vector2u windowSize = window.getSize();
+    sf::Vector2u current = texture->getSize();
+
+    // Resample when the texture would be magnified and a larger one can be
+    // had from the source, or when even the mip levels are more than it needs.
+    float fit = std::max(static_cast<float>(windowSize.x) / current.x, static_cast<float>(windowSize.y) / current.y);
+    bool magnified = fit > 1.01f && (sourceSize.x == 0 || current != sourceSize);
+    bool oversized = fit < 0.5f;
+    if (magnified || oversized) {
+        resample(windowSize);
+        current = texture->getSize();
+        fit = std::max(static_cast<float>(windowSize.x) / current.x, static_cast<float>(windowSize.y) / current.y);
     }
-    sprite.setScale(scale, scale);
-    sf::Vector2f newSize(sprite.getTexture()->getSize().x * scale, sprite.getTexture()->getSize().y * scale);
-    sprite.setPosition((window.getSize().x - newSize.x) / 2, (window.getSize().y - newSize.y) / 2);
+
+    // Cover the window, cropping the overhang evenly on both sides
+    sprite.setScale(fit, fit);
+    sf::Vector2f newSize(current.x * fit, current.y * fit);
+    sprite.setPosition((windowSize.x - newSize.x) / 2, (windowSize.y - newSize.y) / 2);
 }
 
-void BackgroundHandler::draw(sf::RenderWindow& window) {
-    window.draw(sprite);
+void BackgroundHandler::draw(sf::RenderTarget& window) {
+    SoftyPoker::countedDraw(window, sprite);
 }
 
+void BackgroundHandler::resample(sf::Vector2u targetSize) {
+    PROFILE_SCOPE("BackgroundHandler::resample");
+    std::string key = SoftyPoker::ResourceCache::textureKey(assetName, true, targetSize);
+    texture = SoftyPoker::resourceCache().acquire<sf::Texture>(key, [this, targetSize](std::size_t& bytes) {
+        return decode(targetSize, bytes);
+    });
+    sprite.setTexture(*texture, true);
+}
+
+std::shared_ptr<sf::Texture> BackgroundHandler::decode(sf::Vector2u targetSize, std::size_t& bytes) {
+    if (!encoded) {
+        encoded = SoftyPoker::resourceCache().encoded(assetName);
+        if (!encoded) {
+            throw std::runtime_error("Failed to load background: " + assetName);
+        }
+    }
+    sf::Image image;
+    if (!image.loadFromMemory(encoded->data(), encoded->size())) {
+        throw std::runtime_error("Failed to decode background: " + assetName);
+    }
+    sourceSize = image.getSize();
+    sf::Vector2u size = coverSize(sourceSize, targetSize);
+    if (size != sourceSize) {
+        image = resampleImage(image, size.x, size.y);
+    }
+
+    long long textureSize = textureBytes(size, true);
+    std::shared_ptr<sf::Texture> resampled = SoftyPoker::makeTrackedTexture(textureSize);
+    if (!resampled->loadFromImage(image)) {
+        throw std::runtime_error("Failed to create background texture: " + assetName);
+    }
+    resampled->setSmooth(true);
+    resampled->generateMipmap();
+    bytes = static_cast<std::size_t>(textureSize);
+
+    LOG_DEBUG("Background {}: {}x{} source at {}x{} with mipmaps, {} KB of texture instead of {} KB",
+              assetName, sourceSize.x, sourceSize.y, size.x, size.y, textureSize / 1024, textureBytes(sourceSize) / 1024);
+    return resampled;
+}
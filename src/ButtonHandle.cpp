@@ -1,16 +1,75 @@
 #include "ButtonHandle.h"
+#include "Profiler.h"
+#include "Log.h"
 
-ButtonHandle::ButtonHandle() {}
+using SoftyPoker::Command;
 
-void ButtonHandle::addButton(sf::Keyboard::Key key, std::function<void()> onClick) {
-    buttonActions[key] = onClick;
+ButtonHandle::ButtonHandle() {
+    keyCommands.fill(Command::None);
+    joystickCommands.fill(Command::None);
 }
 
-void ButtonHandle::handleEvent(const sf::Event& event) {
-    if (event.type == sf::Event::KeyPressed) {
-        auto it = buttonActions.find(event.key.code);
-        if (it != buttonActions.end()) {
-            it->second();
+void ButtonHandle::bindKey(sf::Keyboard::Key key, Command command) {
+    if (key >= 0 && key < sf::Keyboard::KeyCount) {
+        keyCommands[key] = command;
+    }
+}
+
+void ButtonHandle::bindJoystickButton(unsigned button, Command command) {
+    if (button < sf::Joystick::ButtonCount) {
+        joystickCommands[button] = command;
+    }
+}
+
+void ButtonHandle::setHitArea(Command command, const sf::FloatRect& area) {
+    hitAreas[static_cast<std::size_t>(command)] = area;
+}
+
+void ButtonHandle::clearHitAreas() {
+    hitAreas.fill(sf::FloatRect());
+}
+
+bool ButtonHandle::handleEvent(const sf::Event& event, const sf::RenderTarget& target) {
+    Command command = Command::None;
+    switch (event.type) {
+    case sf::Event::KeyPressed:
+        if (event.key.code >= 0 && event.key.code < sf::Keyboard::KeyCount) {
+            command = keyCommands[event.key.code];
         }
+        break;
+    case sf::Event::JoystickButtonPressed:
+        if (event.joystickButton.button < sf::Joystick::ButtonCount) {
+            command = joystickCommands[event.joystickButton.button];
+        }
+        break;
+    case sf::Event::MouseButtonPressed:
+        if (event.mouseButton.button == sf::Mouse::Left) {
+            sf::Vector2f point = target.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
+            for (std::size_t i = 1; i < SoftyPoker::NumCommands; ++i) {
+                if (hitAreas[i].contains(point)) {
+                    command = static_cast<Command>(i);
+                    break;
+                }
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (command == Command::None) {
+        return false;
+    }
+    queue(command);
+    return true;
+}
+
+bool ButtonHandle::poll(SoftyPoker::TimedCommand& command) {
+    return commands.pop(command);
+}
+
+void ButtonHandle::queue(Command command) {
+    if (!commands.push(SoftyPoker::TimedCommand{ command, SoftyPoker::Profiler::now() })) {
+        LOG_ERROR("Input queue full, dropped a command");
     }
 }
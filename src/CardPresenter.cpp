@@ -0,0 +1,189 @@
+#include "CardPresenter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SoftyPoker {
+
+namespace {
+
+// Reference layout, 1280x720
+const float CardWidth = 184.0f;
+const float CardHeight = 265.0f;
+const float CardGap = 20.0f;
+const float CardsY = 380.0f;
+const float HeldLift = -14.0f;
+
+const float DealStagger = 0.1f;
+const float SlideSeconds = 0.22f;
+const float TurnSeconds = 0.14f;
+const float LiftSeconds = 0.12f;
+
+// The shoe sits above the middle slot, just off the top of the screen
+sf::Vector2f shoeOffset(int slot) {
+    return sf::Vector2f((2 - slot) * (CardWidth + CardGap), -(CardsY + CardHeight + 20.0f));
+}
+
+}
+
+CardPresenter::CardPresenter(SoundManager& sound)
+    : soundPlayer(sound),
+      layoutSize(0, 0),
+      scale(1.0f),
+      dealGroup(Animator::NoGroup) {
+    offsets.fill(sf::Vector2f(0.0f, 0.0f));
+    reveals.fill(1.0f);
+    lifts.fill(0.0f);
+    holdGroups.fill(Animator::NoGroup);
+    // A deal schedules five sounds and a draw at most six
+    pendingSounds.reserve(8);
+}
+
+void CardPresenter::layout(sf::Vector2u windowSize) {
+    if (windowSize == layoutSize) {
+        return;
+    }
+    layoutSize = windowSize;
+    scale = std::min(windowSize.x / 1280.0f, windowSize.y / 720.0f);
+
+    sf::Vector2f size(CardWidth * scale, CardHeight * scale);
+    float gap = CardGap * scale;
+    float left = (windowSize.x - (5 * size.x + 4 * gap)) / 2.0f;
+    for (int i = 0; i < 5; ++i) {
+        slots[i] = sf::FloatRect(sf::Vector2f(left + i * (size.x + gap), CardsY * scale), size);
+    }
+}
+
+void CardPresenter::dealHand() {
+    reset();
+    dealGroup = animator.newGroup();
+    for (int i = 0; i < 5; ++i) {
+        float start = i * DealStagger;
+        // Cards wait face down in the shoe until their turn
+        offsets[i] = shoeOffset(i);
+        reveals[i] = 0.0f;
+        animator.tween(offsets[i], shoeOffset(i), sf::Vector2f(0.0f, 0.0f), SlideSeconds, Ease::OutCubic, start, dealGroup);
+        animator.tween(reveals[i], 0.0f, 1.0f, TurnSeconds, Ease::Linear, start + SlideSeconds, dealGroup);
+        schedule(start, SoundId::Deal);
+    }
+}
+
+void CardPresenter::drawCards(int replacedMask, SoundId result) {
+    fastForward();
+    dropLifts();
+    dealGroup = animator.newGroup();
+    float start = 0.0f;
+    for (int i = 0; i < 5; ++i) {
+        if (!((replacedMask >> i) & 1)) {
+            continue;
+        }
+        reveals[i] = 0.0f;
+        animator.tween(reveals[i], 0.0f, 1.0f, TurnSeconds, Ease::Linear, start, dealGroup);
+        schedule(start, SoundId::Deal);
+        start += DealStagger;
+    }
+    // The result is heard once the last replacement is face up
+    float end = start > 0.0f ? start - DealStagger + TurnSeconds : 0.0f;
+    schedule(end, result);
+}
+
+void CardPresenter::revealCards(int mask) {
+    fastForward();
+    dealGroup = animator.newGroup();
+    for (int i = 0; i < 5; ++i) {
+        if ((mask >> i) & 1) {
+            reveals[i] = 0.0f;
+            animator.tween(reveals[i], 0.0f, 1.0f, TurnSeconds, Ease::Linear, 0.0f, dealGroup);
+        }
+    }
+    schedule(0.0f, SoundId::Deal);
+}
+
+void CardPresenter::setHeld(int index, bool held) {
+    animator.cancel(holdGroups[index]);
+    holdGroups[index] = animator.newGroup();
+    animator.tween(lifts[index], lifts[index], held ? HeldLift : 0.0f, LiftSeconds, Ease::OutBack, 0.0f, holdGroups[index]);
+}
+
+bool CardPresenter::fastForward() {
+    if (!animator.isRunning(dealGroup)) {
+        return false;
+    }
+    animator.finish(dealGroup);
+    for (const PendingSound& pending : pendingSounds) {
+        if (pending.id != SoundId::Deal) {
+            soundPlayer.playSound(pending.id);
+        }
+    }
+    pendingSounds.clear();
+    return true;
+}
+
+void CardPresenter::reset() {
+    animator.clear();
+    pendingSounds.clear();
+    offsets.fill(sf::Vector2f(0.0f, 0.0f));
+    reveals.fill(1.0f);
+    lifts.fill(0.0f);
+}
+
+void CardPresenter::update(sf::Time step) {
+    animator.update(step);
+
+    if (pendingSounds.empty()) {
+        return;
+    }
+    const float dt = step.asSeconds();
+    for (PendingSound& pending : pendingSounds) {
+        pending.delay -= dt;
+        if (pending.delay <= 0.0f) {
+            soundPlayer.playSound(pending.id);
+        }
+    }
+    pendingSounds.erase(std::remove_if(pendingSounds.begin(), pendingSounds.end(),
+                                       [](const PendingSound& pending) { return pending.delay <= 0.0f; }),
+                        pendingSounds.end());
+}
+
+bool CardPresenter::isDealing() const {
+    return animator.isRunning(dealGroup) || !pendingSounds.empty();
+}
+
+bool CardPresenter::isAnimating() const {
+    return animator.size() > 0 || !pendingSounds.empty();
+}
+
+const sf::FloatRect& CardPresenter::getSlot(int index) const {
+    return slots[index];
+}
+
+void CardPresenter::addTo(SpriteBatch& batch, const std::array<int, 5>& faces, int backRegion) const {
+    for (int i = 0; i < 5; ++i) {
+        const sf::FloatRect& slot = slots[i];
+        sf::Vector2f position(slot.left + offsets[i].x * scale, slot.top + (offsets[i].y + lifts[i]) * scale);
+        // Turning over narrows the back to nothing, then widens the face
+        float reveal = reveals[i];
+        int region = reveal < 0.5f ? backRegion : faces[i];
+        float width = slot.width * std::abs(2.0f * reveal - 1.0f);
+        batch.add(region, sf::Vector2f(position.x + (slot.width - width) / 2.0f, position.y),
+                  sf::Vector2f(width, slot.height));
+    }
+}
+
+void CardPresenter::schedule(float delay, SoundId id) {
+    // Sounds due now go out right away rather than a tick late
+    if (delay <= 0.0f) {
+        soundPlayer.playSound(id);
+        return;
+    }
+    pendingSounds.push_back(PendingSound{ delay, id });
+}
+
+void CardPresenter::dropLifts() {
+    for (int i = 0; i < 5; ++i) {
+        if (lifts[i] != 0.0f) {
+            setHeld(i, false);
+        }
+    }
+}
+
+} // namespace SoftyPoker
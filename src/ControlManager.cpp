@@ -9,9 +9,25 @@ ControlManager::~ControlManager() {
 }
 
 void ControlManager::handleInput(sf::Event& event, sf::RenderWindow& window) {  // Match declaration
+    // States only see a render target, so closing the window is handled here
+    if (event.type == sf::Event::Closed) {
+        window.close();
+        return;
+    }
     if (event.type == sf::Event::Resized) {
         sf::FloatRect visibleArea(0, 0, event.size.width, event.size.height);
         window.setView(sf::View(visibleArea));
     }
-    stateManager.handleEvent(event, window);
+    // States only act on these; mouse movement, key releases and the like
+    // would just cost a dispatch
+    switch (event.type) {
+    case sf::Event::Resized:
+    case sf::Event::KeyPressed:
+    case sf::Event::MouseButtonPressed:
+    case sf::Event::JoystickButtonPressed:
+        stateManager.handleEvent(event, window);
+        break;
+    default:
+        break;
+    }
 }
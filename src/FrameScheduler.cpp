@@ -0,0 +1,107 @@
+#include "FrameScheduler.h"
+#include <algorithm>
+#include <thread>
+
+namespace SoftyPoker {
+
+namespace {
+
+// sf::sleep can overshoot by about a millisecond, so the last stretch before
+// a deadline is spent yielding instead.
+const sf::Time SpinMargin = sf::milliseconds(2);
+
+}
+
+FrameScheduler::FrameScheduler(const FrameSettings& settings)
+    : settings(settings),
+      frameStart(sf::Time::Zero),
+      frameTime(sf::Time::Zero),
+      accumulator(sf::Time::Zero),
+      focused(true),
+      redrawRequested(true) {}
+
+void FrameScheduler::applyTo(sf::RenderWindow& window) const {
+    // The scheduler does its own capping; SFML's limiter would double-sleep.
+    window.setFramerateLimit(0);
+    window.setVerticalSyncEnabled(settings.verticalSync);
+}
+
+void FrameScheduler::onEvent(const sf::Event& event) {
+    switch (event.type) {
+    case sf::Event::LostFocus:
+        focused = false;
+        break;
+    case sf::Event::GainedFocus:
+        focused = true;
+        redrawRequested = true;
+        // Do not try to catch up on the time spent in the background
+        accumulator = sf::Time::Zero;
+        frameStart = clock.getElapsedTime();
+        break;
+    case sf::Event::Resized:
+        // The back buffer is stale after a resize even if no state changed
+        redrawRequested = true;
+        break;
+    default:
+        break;
+    }
+}
+
+int FrameScheduler::beginFrame() {
+    sf::Time now = clock.getElapsedTime();
+    frameTime = now - frameStart;
+    frameStart = now;
+
+    accumulator += frameTime;
+    int ticks = static_cast<int>(accumulator / settings.tickStep);
+    if (ticks > settings.maxTicksPerFrame) {
+        ticks = settings.maxTicksPerFrame;
+        accumulator = sf::Time::Zero;
+    } else {
+        accumulator -= settings.tickStep * static_cast<float>(ticks);
+    }
+    return ticks;
+}
+
+sf::Time FrameScheduler::getTickStep() const {
+    return settings.tickStep;
+}
+
+sf::Time FrameScheduler::getFrameTime() const {
+    return frameTime;
+}
+
+bool FrameScheduler::shouldRender(bool stateChanged) {
+    bool render = !settings.renderOnDemand || stateChanged || redrawRequested;
+    redrawRequested = false;
+    return render;
+}
+
+void FrameScheduler::requestRedraw() {
+    redrawRequested = true;
+}
+
+void FrameScheduler::endFrame() {
+    if (settings.frameLimit == 0) {
+        return;
+    }
+    sf::Time deadline = frameStart + sf::seconds(1.0f / settings.frameLimit);
+    sf::Time remaining = deadline - clock.getElapsedTime();
+    if (remaining > SpinMargin) {
+        sf::sleep(remaining - SpinMargin);
+    }
+    while (clock.getElapsedTime() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+bool FrameScheduler::isPaused() const {
+    return !focused;
+}
+
+void FrameScheduler::idle() {
+    sf::sleep(settings.unfocusedSleep);
+    frameStart = clock.getElapsedTime();
+}
+
+} // namespace SoftyPoker
@@ -0,0 +1,362 @@
+#include "GameServer.h"
+#include "GameVariant.h"
+#include "MultiHand.h"
+#include "PokerGame.h"
+#include "Random.h"
+#include "Session.h"
+#include "Log.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <optional>
+
+namespace SoftyPoker {
+
+namespace {
+
+// How long an idle loop sleeps before it looks for connections handed to it
+constexpr int IncomingCheckMs = 5;
+// Replies a client may leave unread before it is dropped
+constexpr std::size_t MaxPendingOutput = 64 * 1024;
+
+struct ServerSession {
+    SocketHandle socket = NoSocket;
+    std::optional<PokerGame> game;      // from the hello on
+    std::uint64_t digest = SessionDigestSeed;
+    std::array<std::uint8_t, 256> input;
+    std::size_t inputUsed = 0;
+    std::vector<std::uint8_t> output;
+    std::size_t outputSent = 0;
+    bool watchingWritable = false;
+    bool closeAfterOutput = false;
+};
+
+template <typename T>
+void append(std::vector<std::uint8_t>& output, const T& message) {
+    const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(&message);
+    output.insert(output.end(), bytes, bytes + sizeof(T));
+}
+
+}
+
+struct GameServer::Shard {
+    std::uint16_t index;
+    std::uint16_t count;
+    int startingCredits;
+    CounterRng seeds;
+    Poller poller;
+    std::vector<std::unique_ptr<ServerSession>> sessions;   // token - 1
+    std::vector<std::size_t> freeSlots;
+
+    std::mutex inboxMutex;
+    std::vector<SocketHandle> inbox;
+    std::atomic<bool> hasIncoming{ false };
+
+    std::atomic<std::uint64_t> open{ 0 };
+    std::atomic<std::uint64_t> opened{ 0 };
+    std::atomic<std::uint64_t> actions{ 0 };
+    std::thread thread;
+
+    Shard(std::uint16_t index, std::uint16_t count, int startingCredits, std::uint64_t seed)
+        : index(index),
+          count(count),
+          startingCredits(startingCredits),
+          seeds(seed, index) {
+    }
+
+    // Called by the acceptor
+    void hand(SocketHandle socket) {
+        open.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        inbox.push_back(socket);
+        hasIncoming.store(true, std::memory_order_release);
+    }
+
+    void run(const std::atomic<bool>& stopping) {
+        std::vector<PollEvent> events;
+        std::vector<SocketHandle> arrived;
+        while (!stopping.load(std::memory_order_relaxed)) {
+            poller.wait(events, IncomingCheckMs);
+            if (hasIncoming.exchange(false, std::memory_order_acquire)) {
+                {
+                    std::lock_guard<std::mutex> lock(inboxMutex);
+                    arrived.swap(inbox);
+                }
+                for (SocketHandle socket : arrived) {
+                    adopt(socket);
+                }
+                arrived.clear();
+            }
+            for (const PollEvent& event : events) {
+                std::size_t slot = static_cast<std::size_t>(event.token - 1);
+                if (slot < sessions.size() && sessions[slot]) {
+                    serve(slot, event);
+                }
+            }
+        }
+        for (std::size_t slot = 0; slot < sessions.size(); ++slot) {
+            if (sessions[slot]) {
+                close(slot);
+            }
+        }
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        for (SocketHandle socket : inbox) {
+            closeSocket(socket);
+            open.fetch_sub(1, std::memory_order_relaxed);
+        }
+        inbox.clear();
+    }
+
+    void adopt(SocketHandle socket) {
+        std::size_t slot = sessions.size();
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            sessions.emplace_back();
+        }
+        sessions[slot] = std::make_unique<ServerSession>();
+        sessions[slot]->socket = socket;
+        opened.fetch_add(1, std::memory_order_relaxed);
+        if (!poller.add(socket, slot + 1)) {
+            close(slot);
+        }
+    }
+
+    void close(std::size_t slot) {
+        poller.remove(sessions[slot]->socket);
+        closeSocket(sessions[slot]->socket);
+        sessions[slot].reset();
+        freeSlots.push_back(slot);
+        open.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void serve(std::size_t slot, const PollEvent& event) {
+        ServerSession& session = *sessions[slot];
+        if (event.readable || event.failed) {
+            for (;;) {
+                std::size_t room = session.input.size() - session.inputUsed;
+                long received = receiveSome(session.socket, session.input.data() + session.inputUsed, room);
+                if (received < 0) {
+                    close(slot);
+                    return;
+                }
+                if (received == 0) {
+                    break;
+                }
+                session.inputUsed += static_cast<std::size_t>(received);
+                handleInput(session);
+                // A short read emptied the socket; polling is level-triggered, so
+                // anything that arrives after it is reported again
+                if (session.closeAfterOutput || static_cast<std::size_t>(received) < room) {
+                    break;
+                }
+            }
+        }
+        if (!flush(slot)) {
+            close(slot);
+        }
+    }
+
+    // Carries out every complete message in the input
+    void handleInput(ServerSession& session) {
+        std::size_t offset = 0;
+        while (!session.closeAfterOutput) {
+            std::size_t available = session.inputUsed - offset;
+            const std::uint8_t* data = session.input.data() + offset;
+            if (!session.game) {
+                if (available < sizeof(ClientHello)) {
+                    break;
+                }
+                ClientHello hello;
+                std::memcpy(&hello, data, sizeof(hello));
+                offset += sizeof(hello);
+                greet(session, hello);
+            } else {
+                if (available < sizeof(ActionRequest)) {
+                    break;
+                }
+                ActionRequest request;
+                std::memcpy(&request, data, sizeof(request));
+                offset += sizeof(request);
+                act(session, request);
+            }
+        }
+        std::memmove(session.input.data(), session.input.data() + offset, session.inputUsed - offset);
+        session.inputUsed -= offset;
+    }
+
+    void greet(ServerSession& session, const ClientHello& hello) {
+        ServerHello reply = {};
+        std::memcpy(reply.magic, ServerMagic, sizeof(reply.magic));
+        reply.version = ProtocolVersion;
+        reply.shard = index;
+        reply.shards = count;
+
+        bool offered = std::memcmp(hello.magic, ClientMagic, sizeof(hello.magic)) == 0 &&
+                       hello.version == ProtocolVersion && hello.variant < NumVariants &&
+                       isHandCount(hello.hands);
+        if (offered) {
+            const GameVariant& variant = GameVariant::get(static_cast<VariantId>(hello.variant));
+            reply.seed = seeds.next();
+            reply.credits = startingCredits * hello.hands;
+            session.game.emplace(CounterRng(reply.seed), reply.credits, variant);
+            session.game->setHandCount(hello.hands);
+            reply.accepted = 1;
+        } else {
+            session.closeAfterOutput = true;
+        }
+        append(session.output, reply);
+    }
+
+    void act(ServerSession& session, const ActionRequest& request) {
+        PokerGame& game = *session.game;
+        GambleResult gambleResult = GambleResult::Push;
+        bool applied = applyCommand(game, static_cast<Command>(request.command), gambleResult);
+        if (applied) {
+            session.digest = stateDigest(session.digest, game);
+        }
+
+        ActionReply reply = {};
+        reply.digest = session.digest;
+        reply.sequence = request.sequence;
+        reply.credits = game.getCredits();
+        reply.win = game.getWin();
+        reply.bet = static_cast<std::uint16_t>(game.getBet());
+        reply.applied = applied ? 1 : 0;
+        reply.phase = static_cast<std::uint8_t>(game.getPhase());
+        reply.heldMask = static_cast<std::uint8_t>(game.getHeldMask());
+        reply.gambleCard = game.getGambleCard();
+        reply.gambleResult = static_cast<std::uint8_t>(gambleResult);
+        reply.hand = game.getHand();
+        append(session.output, reply);
+        actions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Sends what it can; false once the session should go
+    bool flush(std::size_t slot) {
+        ServerSession& session = *sessions[slot];
+        while (session.outputSent < session.output.size()) {
+            long sent = sendSome(session.socket, session.output.data() + session.outputSent,
+                                 session.output.size() - session.outputSent);
+            if (sent < 0) {
+                return false;
+            }
+            if (sent == 0) {
+                break;
+            }
+            session.outputSent += static_cast<std::size_t>(sent);
+        }
+        std::size_t pending = session.output.size() - session.outputSent;
+        if (pending == 0) {
+            session.output.clear();
+            session.outputSent = 0;
+            if (session.closeAfterOutput) {
+                return false;
+            }
+        } else if (pending > MaxPendingOutput) {
+            LOG_INFO("Dropping a client that does not read its replies");
+            return false;
+        }
+        bool watch = pending > 0;
+        if (watch != session.watchingWritable) {
+            poller.watchWritable(session.socket, slot + 1, watch);
+            session.watchingWritable = watch;
+        }
+        return true;
+    }
+};
+
+GameServer::GameServer(const ServerOptions& options)
+    : options(options),
+      listener(NoSocket),
+      stopping(false) {
+}
+
+GameServer::~GameServer() {
+    stop();
+}
+
+bool GameServer::start() {
+    if (listener != NoSocket) {
+        return true;
+    }
+    if (!initSockets()) {
+        LOG_ERROR("Could not start networking");
+        return false;
+    }
+    listener = listenOn(options.port, options.loopbackOnly);
+    if (listener == NoSocket) {
+        return false;
+    }
+
+    unsigned count = options.shards ? options.shards : std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t seed = options.seed ? options.seed : randomSeed();
+    stopping.store(false);
+    for (unsigned i = 0; i < count; ++i) {
+        shards.push_back(std::make_unique<Shard>(static_cast<std::uint16_t>(i), static_cast<std::uint16_t>(count),
+                                                 options.startingCredits, seed));
+    }
+    for (auto& shard : shards) {
+        Shard* loop = shard.get();
+        shard->thread = std::thread([this, loop]() { loop->run(stopping); });
+    }
+    acceptor = std::thread(&GameServer::acceptLoop, this);
+    LOG_INFO("Serving table sessions on port {} with {} event loops", options.port, count);
+    return true;
+}
+
+void GameServer::stop() {
+    if (listener == NoSocket) {
+        return;
+    }
+    stopping.store(true);
+    acceptor.join();
+    for (auto& shard : shards) {
+        shard->thread.join();
+    }
+    closeSocket(listener);
+    listener = NoSocket;
+}
+
+unsigned GameServer::getShardCount() const {
+    return static_cast<unsigned>(shards.size());
+}
+
+std::vector<ShardStats> GameServer::getStats() const {
+    std::vector<ShardStats> stats;
+    for (const auto& shard : shards) {
+        stats.push_back(ShardStats{ shard->open.load(std::memory_order_relaxed),
+                                    shard->opened.load(std::memory_order_relaxed),
+                                    shard->actions.load(std::memory_order_relaxed) });
+    }
+    return stats;
+}
+
+void GameServer::acceptLoop() {
+    Poller poller;
+    poller.add(listener, 0);
+    std::vector<PollEvent> events;
+    while (!stopping.load(std::memory_order_relaxed)) {
+        // Wakes now and then to notice stop()
+        if (poller.wait(events, 100) == 0) {
+            continue;
+        }
+        for (;;) {
+            SocketHandle socket = acceptConnection(listener);
+            if (socket == NoSocket) {
+                break;
+            }
+            Shard* quietest = shards.front().get();
+            for (auto& shard : shards) {
+                if (shard->open.load(std::memory_order_relaxed) < quietest->open.load(std::memory_order_relaxed)) {
+                    quietest = shard.get();
+                }
+            }
+            quietest->hand(socket);
+        }
+    }
+}
+
+} // namespace SoftyPoker
@@ -0,0 +1,36 @@
+#include "GameVariant.h"
+
+namespace SoftyPoker {
+
+namespace {
+
+// Indexed by VariantId
+const GameVariant variants[NumVariants] = {
+    { VariantId::JacksOrBetter, "jacks-or-better", "Jacks or Better", JacksOrBetterRules,
+      &VariantEvaluator<JacksOrBetterRules>::evaluate },
+    { VariantId::DeucesWild, "deuces-wild", "Deuces Wild", DeucesWildRules,
+      &VariantEvaluator<DeucesWildRules>::evaluate },
+    { VariantId::JokerPoker, "joker-poker", "Joker Poker", JokerPokerRules,
+      &VariantEvaluator<JokerPokerRules>::evaluate }
+};
+
+} // namespace
+
+const GameVariant& GameVariant::get(VariantId id) {
+    return variants[static_cast<int>(id)];
+}
+
+const GameVariant& GameVariant::standard() {
+    return get(VariantId::JacksOrBetter);
+}
+
+const GameVariant* GameVariant::find(const std::string& name) {
+    for (const GameVariant& variant : variants) {
+        if (name == variant.name) {
+            return &variant;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace SoftyPoker
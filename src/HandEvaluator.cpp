@@ -0,0 +1,239 @@
+#include "HandEvaluator.h"
+
+namespace SoftyPoker {
+
+namespace {
+
+constexpr std::uint32_t primes[NumRanks] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41 };
+
+// Straights from ace-high down to the wheel (A-2-3-4-5).
+constexpr int straightMasks[10] = { 0x1F00, 0x0F80, 0x07C0, 0x03E0, 0x01F0, 0x00F8, 0x007C, 0x003E, 0x001F, 0x100F };
+
+constexpr int NumPairedHands = 6175;   // distinct non-flush rank multisets
+constexpr int HashSize = 1 << HandTables::HashBits;
+constexpr int BucketCount = 1 << HandTables::BucketBits;
+
+constexpr int bitCount(int mask) {
+    int count = 0;
+    while (mask) {
+        mask &= mask - 1;
+        ++count;
+    }
+    return count;
+}
+
+constexpr bool isStraight(int mask) {
+    for (int straight : straightMasks) {
+        if (straight == mask) {
+            return true;
+        }
+    }
+    return false;
+}
+
+constexpr std::uint32_t maskProduct(int mask) {
+    std::uint32_t product = 1;
+    for (int rank = 0; rank < NumRanks; ++rank) {
+        if (mask & (1 << rank)) {
+            product *= primes[rank];
+        }
+    }
+    return product;
+}
+
+constexpr std::uint32_t bucketOf(std::uint32_t product) {
+    return static_cast<std::uint32_t>((product * 0x9E3779B97F4A7C15ull) >> (64 - HandTables::BucketBits));
+}
+
+constexpr std::uint32_t slotOf(std::uint32_t product) {
+    return static_cast<std::uint32_t>((product * 0x9E3779B97F4A7C15ull) >> 20) & (HashSize - 1);
+}
+
+struct PairedHands {
+    std::uint32_t product[NumPairedHands];
+    std::uint16_t rank[NumPairedHands];
+    int count;
+
+    constexpr void add(std::uint32_t p, std::uint16_t r) {
+        product[count] = p;
+        rank[count] = r;
+        ++count;
+    }
+};
+
+// Walks the hand classes from best to worst, in the same order as the
+// classic Cactus Kev ranking, so every rank value is assigned exactly once.
+constexpr HandTables::Data buildTables() {
+    HandTables::Data tables{};
+    PairedHands hands{};
+
+    for (int card = 0; card < NumCards; ++card) {
+        tables.rankPrime[card] = primes[cardRank(card)];
+        tables.rankBit[card] = static_cast<std::uint16_t>(1 << cardRank(card));
+    }
+
+    std::uint16_t rank = 1;
+    std::uint16_t categoryEnd[9] = {};
+
+    for (int mask : straightMasks) {
+        tables.flushRank[mask] = rank++;
+    }
+    categoryEnd[0] = rank;
+
+    for (int quad = NumRanks - 1; quad >= 0; --quad) {
+        for (int kicker = NumRanks - 1; kicker >= 0; --kicker) {
+            if (kicker != quad) {
+                std::uint32_t p = primes[quad];
+                hands.add(p * p * p * p * primes[kicker], rank++);
+            }
+        }
+    }
+    categoryEnd[1] = rank;
+
+    for (int trips = NumRanks - 1; trips >= 0; --trips) {
+        for (int pair = NumRanks - 1; pair >= 0; --pair) {
+            if (pair != trips) {
+                hands.add(primes[trips] * primes[trips] * primes[trips] * primes[pair] * primes[pair], rank++);
+            }
+        }
+    }
+    categoryEnd[2] = rank;
+
+    for (int mask = (1 << NumRanks) - 1; mask > 0; --mask) {
+        if (bitCount(mask) == 5 && !isStraight(mask)) {
+            tables.flushRank[mask] = rank++;
+        }
+    }
+    categoryEnd[3] = rank;
+
+    for (int mask : straightMasks) {
+        hands.add(maskProduct(mask), rank++);
+    }
+    categoryEnd[4] = rank;
+
+    for (int trips = NumRanks - 1; trips >= 0; --trips) {
+        for (int kickers = (1 << NumRanks) - 1; kickers > 0; --kickers) {
+            if (bitCount(kickers) == 2 && !(kickers & (1 << trips))) {
+                hands.add(primes[trips] * primes[trips] * primes[trips] * maskProduct(kickers), rank++);
+            }
+        }
+    }
+    categoryEnd[5] = rank;
+
+    for (int pairs = (1 << NumRanks) - 1; pairs > 0; --pairs) {
+        if (bitCount(pairs) != 2) {
+            continue;
+        }
+        for (int kicker = NumRanks - 1; kicker >= 0; --kicker) {
+            if (!(pairs & (1 << kicker))) {
+                std::uint32_t p = maskProduct(pairs);
+                hands.add(p * p * primes[kicker], rank++);
+            }
+        }
+    }
+    categoryEnd[6] = rank;
+
+    for (int pair = NumRanks - 1; pair >= 0; --pair) {
+        for (int kickers = (1 << NumRanks) - 1; kickers > 0; --kickers) {
+            if (bitCount(kickers) == 3 && !(kickers & (1 << pair))) {
+                hands.add(primes[pair] * primes[pair] * maskProduct(kickers), rank++);
+            }
+        }
+    }
+    categoryEnd[7] = rank;
+
+    for (int mask = (1 << NumRanks) - 1; mask > 0; --mask) {
+        if (bitCount(mask) == 5 && !isStraight(mask)) {
+            hands.add(maskProduct(mask), rank++);
+        }
+    }
+    categoryEnd[8] = rank;
+
+    std::uint8_t category = 0;
+    for (int r = 1; r <= HandTables::NumHandRanks; ++r) {
+        while (r >= categoryEnd[category]) {
+            ++category;
+        }
+        tables.categoryOf[r] = category;
+    }
+
+    // Hash-and-displace: place the fullest buckets first, then pick for each
+    // bucket the smallest xor adjustment that lands all its keys on free slots.
+    int bucketSize[BucketCount] = {};
+    int maxBucketSize = 0;
+    for (int i = 0; i < hands.count; ++i) {
+        int size = ++bucketSize[bucketOf(hands.product[i])];
+        if (size > maxBucketSize) {
+            maxBucketSize = size;
+        }
+    }
+    int bucketStart[BucketCount + 1] = {};
+    for (int b = 0; b < BucketCount; ++b) {
+        bucketStart[b + 1] = bucketStart[b] + bucketSize[b];
+    }
+    int members[NumPairedHands] = {};
+    int fill[BucketCount] = {};
+    for (int i = 0; i < hands.count; ++i) {
+        std::uint32_t b = bucketOf(hands.product[i]);
+        members[bucketStart[b] + fill[b]++] = i;
+    }
+
+    bool used[HashSize] = {};
+    for (int size = maxBucketSize; size > 0; --size) {
+        for (int b = 0; b < BucketCount; ++b) {
+            if (bucketSize[b] != size) {
+                continue;
+            }
+            for (std::uint32_t adjust = 0; adjust < HashSize; ++adjust) {
+                bool fits = true;
+                for (int m = 0; m < size && fits; ++m) {
+                    std::uint32_t slot = slotOf(hands.product[members[bucketStart[b] + m]]) ^ adjust;
+                    fits = !used[slot];
+                    for (int other = 0; other < m && fits; ++other) {
+                        fits = (slotOf(hands.product[members[bucketStart[b] + other]]) ^ adjust) != slot;
+                    }
+                }
+                if (fits) {
+                    for (int m = 0; m < size; ++m) {
+                        int hand = members[bucketStart[b] + m];
+                        std::uint32_t slot = slotOf(hands.product[hand]) ^ adjust;
+                        used[slot] = true;
+                        tables.hashRank[slot] = hands.rank[hand];
+                    }
+                    tables.hashAdjust[b] = static_cast<std::uint16_t>(adjust);
+                    break;
+                }
+            }
+        }
+    }
+
+    return tables;
+}
+
+} // namespace
+
+namespace HandTables {
+
+constexpr Data tables = buildTables();
+
+}
+
+namespace {
+
+constexpr bool allRanksAssigned() {
+    int flushes = 0;
+    for (std::uint16_t value : HandTables::tables.flushRank) {
+        flushes += value != 0;
+    }
+    int paired = 0;
+    for (std::uint16_t value : HandTables::tables.hashRank) {
+        paired += value != 0;
+    }
+    return flushes == 1287 && paired == NumPairedHands;
+}
+
+static_assert(allRanksAssigned(), "perfect hash failed to place every hand class");
+
+} // namespace
+
+} // namespace SoftyPoker
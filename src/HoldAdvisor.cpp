@@ -0,0 +1,253 @@
+#include "HoldAdvisor.h"
+#include <condition_variable>
+
+namespace SoftyPoker {
+
+namespace {
+
+constexpr int HandSize = 5;
+constexpr int MaxUnseen = MaxDeckSize - HandSize;
+
+// Patterns drawing at least this many cards are split into one task per first drawn card.
+constexpr int SplitDrawCount = 3;
+
+// Slots in the memo (about 4 MB). A long optimal-strategy run sees far
+// more distinct hands than that; each one only evicts its slot's hand.
+constexpr int MemoBits = 14;
+
+constexpr std::uint64_t choose(int n, int k) {
+    std::uint64_t result = 1;
+    for (int i = 1; i <= k; ++i) {
+        result = result * (n - k + i) / i;
+    }
+    return result;
+}
+
+int popCount(int mask) {
+    int count = 0;
+    for (; mask; mask &= mask - 1) {
+        ++count;
+    }
+    return count;
+}
+
+}
+
+struct HoldAdvisor::Job {
+    std::array<Card, HandSize> hand;
+    std::array<Card, MaxUnseen> unseen;
+    int unseenCount = 0;
+    VariantId variant = VariantId::JacksOrBetter;
+    std::array<std::uint32_t, NumPrizes> payByPrize;
+    std::array<std::atomic<std::uint64_t>, NumHoldPatterns> totals;
+    std::atomic<int> pendingTasks{0};
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> done{false};
+    std::uint64_t key = 0;
+    int bet = 0;
+    HoldAdvice advice;
+    std::shared_ptr<Shared> shared;
+    std::mutex doneMutex;
+    std::condition_variable doneSignal;
+
+    // Evaluator is the variant's VariantEvaluator, so the innermost loop is
+    // compiled once per variant rather than calling through a pointer.
+    template <typename Evaluator>
+    std::uint64_t sumDraws(Card* cards, const int* slots, int depth, int drawCount, int start) const {
+        if (depth == drawCount) {
+            return payByPrize[static_cast<int>(Evaluator::evaluate(cards))];
+        }
+        std::uint64_t sum = 0;
+        for (int i = start; i <= unseenCount - (drawCount - depth); ++i) {
+            if (depth == 1 && cancelled.load(std::memory_order_relaxed)) {
+                return 0;
+            }
+            cards[slots[depth]] = unseen[i];
+            sum += sumDraws<Evaluator>(cards, slots, depth + 1, drawCount, i + 1);
+        }
+        return sum;
+    }
+
+    // Sums the payouts of every draw for one hold pattern, optionally pinning
+    // the first drawn card to unseen[firstCard].
+    void runTask(int pattern, int firstCard) {
+        if (!cancelled.load(std::memory_order_relaxed)) {
+            Card cards[HandSize];
+            int slots[HandSize];
+            int drawCount = 0;
+            for (int i = 0; i < HandSize; ++i) {
+                cards[i] = hand[i];
+                if (!(pattern & (1 << i))) {
+                    slots[drawCount++] = i;
+                }
+            }
+
+            std::uint64_t sum = visitVariant(variant, [&](auto evaluator) {
+                using Evaluator = decltype(evaluator);
+                if (firstCard < 0) {
+                    return sumDraws<Evaluator>(cards, slots, 0, drawCount, 0);
+                }
+                cards[slots[0]] = unseen[firstCard];
+                return sumDraws<Evaluator>(cards, slots, 1, drawCount, firstCard + 1);
+            });
+            totals[pattern].fetch_add(sum, std::memory_order_relaxed);
+        }
+
+        if (pendingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            finish();
+        }
+    }
+
+    void finish() {
+        if (!cancelled.load()) {
+            double bestValue = -1.0;
+            for (int pattern = 0; pattern < NumHoldPatterns; ++pattern) {
+                int drawCount = HandSize - popCount(pattern);
+                double value = static_cast<double>(totals[pattern].load()) / choose(unseenCount, drawCount);
+                advice.expectedValue[pattern] = value;
+                if (value > bestValue) {
+                    bestValue = value;
+                    advice.bestHold = pattern;
+                }
+            }
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            MemoEntry& entry = shared->memo[memoSlot(key)];
+            entry.key = key;
+            entry.advice = advice;
+        }
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            done.store(true, std::memory_order_release);
+        }
+        doneSignal.notify_all();
+    }
+};
+
+HoldAdvisor::HoldAdvisor(WorkStealingPool& pool, const GameVariant& variant)
+    : HoldAdvisor(pool, variant, variant.rules.paytable) {}
+
+HoldAdvisor::HoldAdvisor(WorkStealingPool& pool, const GameVariant& variant, const Paytable& paytable)
+    : pool(pool), variant(variant), paytable(paytable), shared(std::make_shared<Shared>()) {
+    shared->memo.resize(std::size_t(1) << MemoBits);
+}
+
+HoldAdvisor::~HoldAdvisor() {
+    cancel();
+}
+
+std::uint64_t HoldAdvisor::canonicalKey(const std::array<Card, 5>& hand, int bet) {
+    // Relabel suits in order of first appearance; hold patterns are positional,
+    // so positions are kept and only the suit permutation is factored out.
+    int suitMap[NumSuits] = { -1, -1, -1, -1 };
+    int nextSuit = 0;
+    std::uint64_t key = static_cast<std::uint64_t>(bet);
+    for (Card card : hand) {
+        // The joker has no suit to relabel
+        if (card == Joker) {
+            key = (key << 6) | Joker;
+            continue;
+        }
+        int& suit = suitMap[cardSuit(card)];
+        if (suit < 0) {
+            suit = nextSuit++;
+        }
+        key = (key << 6) | makeCard(cardRank(card), suit);
+    }
+    return key;
+}
+
+std::size_t HoldAdvisor::memoSlot(std::uint64_t key) {
+    return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - MemoBits));
+}
+
+void HoldAdvisor::request(const std::array<Card, 5>& hand, int bet) {
+    cancel();
+
+    auto job = std::make_shared<Job>();
+    job->hand = hand;
+    job->bet = bet;
+    job->key = canonicalKey(hand, bet);
+    job->shared = shared;
+    current = job;
+
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        const MemoEntry& entry = shared->memo[memoSlot(job->key)];
+        if (entry.key == job->key) {
+            job->advice = entry.advice;
+            job->done = true;
+            return;
+        }
+    }
+    schedule(job);
+}
+
+void HoldAdvisor::schedule(const std::shared_ptr<Job>& job) {
+    HandMask dealt = handMask(job->hand.data(), HandSize);
+    int count = 0;
+    for (int card = 0; card < variant.rules.deckSize; ++card) {
+        if (!(dealt & cardMask(static_cast<Card>(card)))) {
+            job->unseen[count++] = static_cast<Card>(card);
+        }
+    }
+    job->unseenCount = count;
+    job->variant = variant.id;
+
+    for (int prize = 0; prize < NumPrizes; ++prize) {
+        job->payByPrize[prize] = static_cast<std::uint32_t>(paytable.payout(static_cast<Prize>(prize), job->bet));
+    }
+    for (auto& total : job->totals) {
+        total = 0;
+    }
+
+    int taskCount = 0;
+    for (int pattern = 0; pattern < NumHoldPatterns; ++pattern) {
+        int drawCount = HandSize - popCount(pattern);
+        taskCount += drawCount >= SplitDrawCount ? count - drawCount + 1 : 1;
+    }
+    job->pendingTasks = taskCount;
+
+    // Largest patterns first so the long tail of tiny ones fills in behind them.
+    for (int pattern = 0; pattern < NumHoldPatterns; ++pattern) {
+        int drawCount = HandSize - popCount(pattern);
+        if (drawCount >= SplitDrawCount) {
+            for (int first = 0; first <= count - drawCount; ++first) {
+                pool.submit([job, pattern, first]() { job->runTask(pattern, first); });
+            }
+        }
+    }
+    for (int pattern = 0; pattern < NumHoldPatterns; ++pattern) {
+        if (HandSize - popCount(pattern) < SplitDrawCount) {
+            pool.submit([job, pattern]() { job->runTask(pattern, -1); });
+        }
+    }
+}
+
+void HoldAdvisor::cancel() {
+    if (current) {
+        current->cancelled = true;
+        current.reset();
+    }
+}
+
+bool HoldAdvisor::isReady() const {
+    return current && current->done.load(std::memory_order_acquire) && !current->cancelled.load();
+}
+
+bool HoldAdvisor::getAdvice(HoldAdvice& advice) const {
+    if (!isReady()) {
+        return false;
+    }
+    advice = current->advice;
+    return true;
+}
+
+HoldAdvice HoldAdvisor::solve(const std::array<Card, 5>& hand, int bet) {
+    request(hand, bet);
+    std::shared_ptr<Job> job = current;
+    std::unique_lock<std::mutex> lock(job->doneMutex);
+    job->doneSignal.wait(lock, [&job]() { return job->done.load(); });
+    return job->advice;
+}
+
+} // namespace SoftyPoker
@@ -0,0 +1,158 @@
+#include "HoldStrategy.h"
+#include "HandEvaluator.h"
+
+namespace SoftyPoker {
+
+namespace {
+
+constexpr int AllCards = 0x1F;
+constexpr int Ten = 8;
+constexpr int Jack = 9;
+constexpr int Ace = 12;
+
+int popCount(int mask) {
+    int count = 0;
+    for (; mask; mask &= mask - 1) {
+        ++count;
+    }
+    return count;
+}
+
+struct HandShape {
+    int suitCards[NumSuits] = {};   // positions holding each suit
+    int rankCards[NumRanks] = {};   // positions holding each rank
+    int highCards = 0;              // positions holding jacks or better
+
+    explicit HandShape(const std::array<Card, 5>& hand) {
+        for (int i = 0; i < 5; ++i) {
+            suitCards[cardSuit(hand[i])] |= 1 << i;
+            rankCards[cardRank(hand[i])] |= 1 << i;
+            if (cardRank(hand[i]) >= Jack) {
+                highCards |= 1 << i;
+            }
+        }
+    }
+
+    int cardsOfRanks(int low, int high) const {
+        int mask = 0;
+        for (int rank = low; rank <= high; ++rank) {
+            mask |= rankCards[rank];
+        }
+        return mask;
+    }
+
+    // Positions inside the five-rank window starting at low (low = -1 is the wheel).
+    int straightWindow(int low) const {
+        return low < 0 ? cardsOfRanks(0, 3) | rankCards[Ace] : cardsOfRanks(low, low + 4);
+    }
+
+    int bestSuited(int cards, int count) const {
+        for (int suit = 0; suit < NumSuits; ++suit) {
+            if (popCount(suitCards[suit] & cards) == count) {
+                return suitCards[suit] & cards;
+            }
+        }
+        return 0;
+    }
+
+    int straightFlushDraw(int count) const {
+        for (int low = NumRanks - 5; low >= -1; --low) {
+            int suited = bestSuited(straightWindow(low), count);
+            if (suited) {
+                return suited;
+            }
+        }
+        return 0;
+    }
+
+    int pairs() const {
+        int mask = 0;
+        for (int cards : rankCards) {
+            if (popCount(cards) == 2) {
+                mask |= cards;
+            }
+        }
+        return mask;
+    }
+
+    // Four distinct consecutive ranks that can be completed at either end.
+    int outsideStraightDraw() const {
+        for (int low = 1; low + 3 < Ace; ++low) {
+            int run = 0;
+            for (int rank = low; rank < low + 4; ++rank) {
+                if (!rankCards[rank]) {
+                    run = 0;
+                    break;
+                }
+                run |= rankCards[rank] & -rankCards[rank];
+            }
+            if (run) {
+                return run;
+            }
+        }
+        return 0;
+    }
+};
+
+}
+
+int basicStrategyHold(const std::array<Card, 5>& hand) {
+    HandShape shape(hand);
+    HandCategory category = HandEvaluator::category(HandEvaluator::evaluate(hand.data()));
+    int royalCards = shape.cardsOfRanks(Ten, Ace);
+
+    if (category == HandCategory::StraightFlush || category == HandCategory::FourOfAKind
+        || category == HandCategory::FullHouse) {
+        return AllCards;
+    }
+    if (int royalDraw = shape.bestSuited(royalCards, 4)) {
+        return royalDraw;
+    }
+    if (category == HandCategory::Flush || category == HandCategory::Straight) {
+        return AllCards;
+    }
+    if (category == HandCategory::ThreeOfAKind) {
+        for (int cards : shape.rankCards) {
+            if (popCount(cards) == 3) {
+                return cards;
+            }
+        }
+    }
+    if (int straightFlushDraw = shape.straightFlushDraw(4)) {
+        return straightFlushDraw;
+    }
+    int pairs = shape.pairs();
+    if (category == HandCategory::TwoPair) {
+        return pairs;
+    }
+    if (pairs & shape.highCards) {
+        return pairs;
+    }
+    if (int royalDraw = shape.bestSuited(royalCards, 3)) {
+        return royalDraw;
+    }
+    if (int flushDraw = shape.bestSuited(AllCards, 4)) {
+        return flushDraw;
+    }
+    if (pairs) {
+        return pairs;
+    }
+    if (int straightDraw = shape.outsideStraightDraw()) {
+        return straightDraw;
+    }
+    if (int suitedHigh = shape.bestSuited(shape.highCards, 2)) {
+        return suitedHigh;
+    }
+    if (int straightFlushDraw = shape.straightFlushDraw(3)) {
+        return straightFlushDraw;
+    }
+
+    // Keep the two lowest high cards; they leave the most straight draws open.
+    int kept = 0;
+    for (int rank = Jack; rank <= Ace && popCount(kept) < 2; ++rank) {
+        kept |= shape.rankCards[rank];
+    }
+    return kept;
+}
+
+} // namespace SoftyPoker
@@ -1,77 +1,80 @@
 #include "IntroState.h"
 #include "Utility.h"
-#include <iostream>
+#include "AssetPack.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "Log.h"
+#include <stdexcept>
 #include <vector>
-#include <random>
 
 namespace SoftyPoker {
 
-IntroState::IntroState(SoundManager& sp, sf::RenderWindow& window)
-    : soundPlayer(sp),
-      font(),
-      firstLine(TextScroll(font, "Hello and welcome to SoftyPoker project intro. Starting in 2025 with the help from AI, using SFML2, Code::Blocks and many other open-source great goodies. SoftyPoker is a fun project to help learn and create together.", 100.0f, window.getSize().y / 1.2f, window.getSize().x)),
-      secondLine(TextScroll(font, "Softy Projects  2025 by T.E. & E.M. is licensed under a Creative Commons Attribution 4.0 International License (CC BY 4.0). This includes all sub-projects such as SoftyPoker.", 200.0f, window.getSize().y / 1.1f, window.getSize().x)),
-      logoAnimation(logoTexture, 12.0f),
-      backgroundHandler(backgroundTexture),
-      fadeDuration(6.0f),
-      pauseDuration(2.0f),
-      totalElapsed(sf::Time::Zero),
-      firstLineSpeed(140.0f),
-      secondLineSpeed(200.0f) {
+namespace {
 
-    firstLine.setTextColor(sf::Color(144, 238, 144));
-    secondLine.setTextColor(sf::Color(144, 238, 144));
-
-    // Initialize instructionText
-    instructionText.setFont(font);
-    instructionText.setString("S to Start Game...Not YET !!!");
-    instructionText.setCharacterSize(50);
-    instructionText.setFillColor(sf::Color(173, 216, 230)); // Set the color to light blue
-
-
-    backgroundFiles = {
-    getAssetPath("images/backgrounds/image1.png"),
-    getAssetPath("images/backgrounds/image2.png"),
-    getAssetPath("images/backgrounds/image3.png"),
-    getAssetPath("images/backgrounds/image4.png"),
-    getAssetPath("images/backgrounds/image5.png"),
-    getAssetPath("images/backgrounds/image6.png"),
-    getAssetPath("images/backgrounds/image7.png")
-};
+template <typename T>
+std::shared_ptr<T> loadedAsset(const AssetHandle<T>& handle, const std::string& what) {
+    if (!handle || !handle->isReady()) {
+        throw std::runtime_error("Failed to load " + what);
+    }
+    return handle->share();
+}
 
+}
 
+IntroAssets IntroState::requestAssets(AssetLoader& loader, SoundManager& sp, sf::Vector2u displaySize) {
+    std::vector<std::string> backgroundFiles = listAssets("images/backgrounds/");
+    if (backgroundFiles.empty()) {
+        throw std::runtime_error("No background images found");
+    }
 
+    IntroAssets assets;
+    assets.backgroundName = backgroundFiles[sharedRng().uniform(backgroundFiles.size())];
+    LOG_DEBUG("Loading background texture: {}", assets.backgroundName);
+
+    assets.background = loader.loadTexture(assets.backgroundName, true, displaySize);
+    // The logo is never wider or taller than a fifth of the window
+    assets.logo = loader.loadTexture("images/logo.png", true, sf::Vector2u(displaySize.x / 5, displaySize.y / 5));
+    assets.font = loader.loadFont("fonts/arialnbi.ttf");
+    loader.runTask([&sp]() { sp.initializeMusic(); });
+    loader.runTask([&sp]() { sp.initializeGameSounds(); });
+    return assets;
+}
 
+IntroState::IntroState(SoundManager& sp, sf::RenderTarget& window, const IntroAssets& assets, std::function<void()> onStart)
+    // The logo, and the background and font sizes only the intro used, go
+    // with it; whatever the table still holds stays
+    : cacheEviction({ "texture:images/logo.png", "texture:" + assets.backgroundName,
+                      "encoded:" + assets.backgroundName, "font:fonts/arialnbi.ttf" }),
+      soundPlayer(sp),
+      onStart(std::move(onStart)),
+      font(loadedAsset(assets.font, "font")),
+      logoTexture(loadedAsset(assets.logo, "logo texture")),
+      firstLine(TextScroll(*font, "Hello and welcome to SoftyPoker project intro. Starting in 2025 with the help from AI, using SFML2, Code::Blocks and many other open-source great goodies. SoftyPoker is a fun project to help learn and create together.", 240.0f, window.getSize().y / 1.2f, window.getSize().x)),
+      secondLine(TextScroll(*font, "Softy Projects  2025 by T.E. & E.M. is licensed under a Creative Commons Attribution 4.0 International License (CC BY 4.0). This includes all sub-projects such as SoftyPoker.", 400.0f, window.getSize().y / 1.1f, window.getSize().x)),
+      logoAlpha(0.0f),
+      backgroundHandler(assets.backgroundName, loadedAsset(assets.background, "background texture: " + assets.backgroundName)),
+      totalElapsed(sf::Time::Zero) {
 
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::uniform_int_distribution<> dis(0, backgroundFiles.size() - 1);
-    int index = dis(g);
+    firstLine.setTextColor(sf::Color(144, 238, 144));
+    secondLine.setTextColor(sf::Color(144, 238, 144));
 
-    std::string selectedFile = backgroundFiles[index];
-    std::cout << "[Debug] Loading background texture: " << selectedFile << std::endl;
+    // Initialize instructionText
+    instructionText.setFont(*font);
+    instructionText.setString("S to Start Game");
+    instructionText.setCharacterSize(50);
+    instructionText.setFillColor(sf::Color(173, 216, 230)); // Set the color to light blue
 
-    if (!backgroundTexture.loadFromFile(selectedFile)) {
-        throw std::runtime_error("Failed to load background texture: " + selectedFile);
-    } else {
-        std::cout << "[Debug] Successfully loaded background texture: " << selectedFile << std::endl;
-    }
-    backgroundSprite.setTexture(backgroundTexture);
 
-    if (!logoTexture.loadFromFile(getAssetPath("images/logo.png"))) {
-        throw std::runtime_error("Failed to load logo texture");
-    } else {
-        std::cout << "[Debug] Successfully loaded logo texture" << std::endl;
-    }
-    logoSprite.setTexture(logoTexture);
+    logoSprite.setTexture(*logoTexture);
     logoSprite.setScale(0.2f, 0.2f);
+    logoSprite.setColor(sf::Color(255, 255, 255, 0));
 
-    if (!font.loadFromFile(getAssetPath("fonts/arialnbi.ttf"))) {
-        throw std::runtime_error("Failed to load font");
-    }
-
-    soundPlayer.initializeMusic();
-    soundPlayer.playRandomBackgroundMusic();
+    // The logo fades in, stays for a moment, fades out and starts over
+    Sequence(animator)
+        .then(logoAlpha, 0.0f, 255.0f, 6.0f)
+        .wait(2.0f)
+        .then(logoAlpha, 255.0f, 0.0f, 6.0f)
+        .loop();
 
     secondLine.enableSmoothColorTransition(true);
     secondLine.setColorFadeSpeed(0.1f);
@@ -79,20 +82,20 @@ IntroState::IntroState(SoundManager& sp, sf::RenderWindow& window)
     resizeElements(window);
 }
 
-void IntroState::resizeElements(sf::RenderWindow& window) {
-    ::resizeBackground(window, backgroundSprite, backgroundTexture);
+void IntroState::resizeElements(sf::RenderTarget& window) {
+    backgroundHandler.resize(window);
 
     float windowWidth = window.getSize().x;
     float windowHeight = window.getSize().y;
 
-    float logoAspectRatio = logoTexture.getSize().x / static_cast<float>(logoTexture.getSize().y);
+    float logoAspectRatio = logoTexture->getSize().x / static_cast<float>(logoTexture->getSize().y);
     float logoWidth = windowWidth * 0.2f;
     float logoHeight = logoWidth / logoAspectRatio;
     if (logoHeight > windowHeight * 0.2f) {
         logoHeight = windowHeight * 0.2f;
         logoWidth = logoHeight * logoAspectRatio;
     }
-    logoSprite.setScale(logoWidth / logoTexture.getSize().x, logoHeight / logoTexture.getSize().y);
+    logoSprite.setScale(logoWidth / logoTexture->getSize().x, logoHeight / logoTexture->getSize().y);
     logoSprite.setPosition(10.0f, windowHeight - logoHeight - 10.0f);
 
     firstLine.setCharacterSize(static_cast<unsigned int>(32 * (windowWidth / 1280.f)));
@@ -108,70 +111,43 @@ void IntroState::resizeElements(sf::RenderWindow& window) {
     instructionText.setPosition(10.0f, 10.0f);
 }
 
-void IntroState::update(sf::RenderWindow& window) {
-    sf::Time elapsed = clock.restart();
-    totalElapsed += elapsed;
-    logoAnimation.update(elapsed);
-    firstLine.update(elapsed, totalElapsed);
-    secondLine.update(elapsed, totalElapsed);
-    scrollText(window, elapsed);
-    animateLogo();
+void IntroState::update(sf::RenderTarget& window, sf::Time step) {
+    totalElapsed += step;
+    animator.update(step);
+    logoSprite.setColor(sf::Color(255, 255, 255, static_cast<sf::Uint8>(logoAlpha)));
+    firstLine.update(step, totalElapsed);
+    secondLine.update(step, totalElapsed);
 }
 
-void IntroState::draw(sf::RenderWindow& window) {
+void IntroState::draw(sf::RenderTarget& window) {
     window.clear();
-    window.draw(backgroundSprite);
-    window.draw(firstLine);
-    window.draw(logoSprite);
-    window.draw(secondLine);
-    window.draw(instructionText); // Draw the instructionText
-    window.display();
+    backgroundHandler.draw(window);
+    countedDraw(window, firstLine);
+    countedDraw(window, logoSprite);
+    countedDraw(window, secondLine);
+    countedDraw(window, instructionText); // Draw the instructionText
 }
 
-void IntroState::handleEvent(sf::Event& event, sf::RenderWindow& window) {
-    if (event.type == sf::Event::Closed) {
-        window.close();
-    }
+void IntroState::handleEvent(sf::Event& event, sf::RenderTarget& window) {
     if (event.type == sf::Event::Resized) {
         sf::View view = window.getView();
         view.setSize(event.size.width, event.size.height);
         window.setView(view);
         resizeElements(window);
     }
-}
-
-void IntroState::animateLogo() {
-    float fadeElapsed = fadeClock.getElapsedTime().asSeconds();
-    float totalDuration = fadeDuration * 2 + pauseDuration;
-    float cycleProgress = std::fmod(fadeElapsed, totalDuration) / totalDuration;
-
-    if (cycleProgress < fadeDuration / totalDuration) {
-        float fadeProgress = cycleProgress / (fadeDuration / totalDuration);
-        sf::Uint8 alpha = static_cast<sf::Uint8>(255 * fadeProgress);
-        logoSprite.setColor(sf::Color(255, 255, 255, alpha));
-    } else if (cycleProgress < (fadeDuration + pauseDuration) / totalDuration) {
-        logoSprite.setColor(sf::Color(255, 255, 255, 255));
-    } else {
-        float fadeProgress = (cycleProgress - (fadeDuration + pauseDuration) / totalDuration) / (fadeDuration / totalDuration);
-        sf::Uint8 alpha = static_cast<sf::Uint8>(255 * (1.0f - fadeProgress));
-        logoSprite.setColor(sf::Color(255, 255, 255, alpha));
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::S && onStart) {
+        onStart();
     }
 }
 
-void IntroState::scrollText(sf::RenderWindow& window, sf::Time elapsed) {
-    sf::Vector2f firstLinePos = firstLine.getPosition();
-    firstLinePos.x -= firstLineSpeed * elapsed.asSeconds();
-    if (firstLinePos.x + firstLine.getLocalBounds().width < 0) {
-        firstLinePos.x = window.getSize().x;
-    }
-    firstLine.setPosition(firstLinePos);
+void IntroState::onEnter() {
+    soundPlayer.playRandomBackgroundMusic();
+}
 
-    sf::Vector2f secondLinePos = secondLine.getPosition();
-    secondLinePos.x -= secondLineSpeed * elapsed.asSeconds();
-    if (secondLinePos.x + secondLine.getLocalBounds().width < 0) {
-        secondLinePos.x = window.getSize().x;
-    }
-    secondLine.setPosition(secondLinePos);
+void IntroState::onExit() {
+    // The table has no music of its own; closing the streams here frees them
+    // together with the rest of the intro.
+    soundPlayer.stopMusic();
 }
 
 } // namespace SoftyPoker
@@ -0,0 +1,511 @@
+#include "Journal.h"
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SoftyPoker {
+
+const char* const JournalPath = "sessions/journal.spj";
+
+namespace {
+
+// In the win field of a start record: "SPJ" and the format version
+constexpr std::int32_t FormatTag = 0x014A5053;
+
+const std::intptr_t NoFile = -1;
+
+// A snapshot goes into the 20 bytes from tick to win of consecutive records
+constexpr std::size_t SliceOffset = offsetof(JournalRecord, tick);
+constexpr std::size_t SliceSize = offsetof(JournalRecord, checksum) - SliceOffset;
+constexpr int SnapshotSlices = static_cast<int>((sizeof(GameSnapshot) + SliceSize - 1) / SliceSize);
+
+static_assert(SliceSize == 20, "snapshot slices no longer fill a record");
+
+// Multiply-xorshift over the 28 bytes before the checksum
+std::uint32_t checksum(const JournalRecord& record) {
+    std::uint64_t words[4];
+    std::memcpy(words, &record, sizeof(words));
+    words[3] &= 0xFFFFFFFFull;
+    std::uint64_t hash = 0x243F6A8885A308D3ull;
+    for (std::uint64_t word : words) {
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 29;
+    }
+    return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+}
+
+JournalRecord makeRecord(JournalRecordType type) {
+    JournalRecord record = {};
+    record.type = static_cast<std::uint8_t>(type);
+    return record;
+}
+
+// Read-only mapping of a whole file, closed when it goes out of scope.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) : base(nullptr), size(0) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        LARGE_INTEGER fileSize;
+        HANDLE mapping = nullptr;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        }
+        if (mapping) {
+            base = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            size = base ? static_cast<std::size_t>(fileSize.QuadPart) : 0;
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+#else
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0) {
+            return;
+        }
+        struct stat info;
+        if (fstat(file, &info) == 0 && info.st_size > 0) {
+            void* mapped = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapped != MAP_FAILED) {
+                base = static_cast<const std::uint8_t*>(mapped);
+                size = static_cast<std::size_t>(info.st_size);
+                // Read front to back once
+                madvise(mapped, size, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(file);
+#endif
+    }
+
+    ~MappedFile() {
+        if (!base) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+#else
+        munmap(const_cast<std::uint8_t*>(base), size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::uint8_t* base;
+    std::size_t size;
+};
+
+bool writeAll(std::intptr_t file, const void* data, std::size_t size) {
+#ifdef _WIN32
+    DWORD written = 0;
+    return WriteFile(reinterpret_cast<HANDLE>(file), data, static_cast<DWORD>(size), &written, nullptr) && written == size;
+#else
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(static_cast<int>(file), bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+#endif
+}
+
+bool syncFile(std::intptr_t file) {
+#ifdef _WIN32
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(file)) != 0;
+#elif defined(__APPLE__)
+    return fsync(static_cast<int>(file)) == 0;
+#else
+    // The file only grows, so the data and its new length are all there is to sync
+    return fdatasync(static_cast<int>(file)) == 0;
+#endif
+}
+
+// A new journal file only survives a power cut once its directory entry does
+void syncDirectoryOf(const std::string& directory) {
+#ifndef _WIN32
+    int handle = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+    if (handle >= 0) {
+        fsync(handle);
+        ::close(handle);
+    }
+#else
+    (void)directory;
+#endif
+}
+
+// Opens for appending after the first keep bytes, cutting off the rest.
+std::intptr_t openForAppend(const std::string& path, bool create, std::uint64_t keep) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NoFile;
+    }
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(keep);
+    if (!SetFilePointerEx(file, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+        CloseHandle(file);
+        return NoFile;
+    }
+    return reinterpret_cast<std::intptr_t>(file);
+#else
+    int file = ::open(path.c_str(), O_WRONLY | (create ? O_CREAT | O_TRUNC : 0), 0644);
+    if (file < 0) {
+        return NoFile;
+    }
+    if (ftruncate(file, static_cast<off_t>(keep)) != 0 || lseek(file, 0, SEEK_END) < 0) {
+        ::close(file);
+        return NoFile;
+    }
+    return file;
+#endif
+}
+
+void closeFile(std::intptr_t file) {
+#ifdef _WIN32
+    CloseHandle(reinterpret_cast<HANDLE>(file));
+#else
+    ::close(static_cast<int>(file));
+#endif
+}
+
+}
+
+namespace {
+
+enum class Recovered {
+    Nothing,
+    Resumable,
+    Unusable
+};
+
+Recovered rebuildSession(const std::string& path, JournalRecovery& recovery) {
+    auto started = std::chrono::steady_clock::now();
+    MappedFile mapped(path);
+    const std::size_t count = mapped.size / sizeof(JournalRecord);
+    if (count == 0) {
+        return Recovered::Nothing;
+    }
+    // The mapping is page aligned, so the records can be read in place
+    const JournalRecord* records = reinterpret_cast<const JournalRecord*>(mapped.base);
+
+    auto intact = [&](std::size_t index) {
+        const JournalRecord& record = records[index];
+        return record.sequence == index && record.checksum == checksum(record) &&
+               record.type <= static_cast<std::uint8_t>(JournalRecordType::End);
+    };
+    const JournalRecord& start = records[0];
+    if (!intact(0) || start.type != static_cast<std::uint8_t>(JournalRecordType::Start) || start.win != FormatTag ||
+        start.command >= NumVariants || !isHandCount(start.bet)) {
+        LOG_ERROR("Ignoring unreadable journal: {}", path);
+        return Recovered::Unusable;
+    }
+
+    SessionLog& log = recovery.log;
+    log = SessionLog();
+    log.seed = start.digest;
+    log.startingCredits = start.credits;
+    log.variant = static_cast<VariantId>(start.command);
+    log.hands = start.bet;
+    log.digest = SessionDigestSeed;
+    log.finalCredits = start.credits;
+    log.events.reserve(count);
+
+    // One pass over the intact records: the events, and the newest complete
+    // snapshot with the number of events before it
+    std::size_t end = 1;
+    std::size_t snapshotAt = 0;
+    std::size_t eventsAtSnapshot = 0;
+    std::size_t lastCommand = 0;
+    for (; end < count && intact(end); ++end) {
+        const JournalRecord& record = records[end];
+        switch (static_cast<JournalRecordType>(record.type)) {
+        case JournalRecordType::Command:
+            log.events.push_back(SessionEvent{ record.tick, static_cast<Command>(record.command) });
+            lastCommand = end;
+            break;
+        case JournalRecordType::Snapshot:
+            // Complete once its last slice is in, right behind the command it follows
+            if (record.command == SnapshotSlices - 1 && end >= static_cast<std::size_t>(SnapshotSlices) &&
+                lastCommand == end - SnapshotSlices) {
+                snapshotAt = end + 1 - SnapshotSlices;
+                eventsAtSnapshot = log.events.size();
+            }
+            break;
+        case JournalRecordType::End:
+            return Recovered::Nothing;
+        case JournalRecordType::Start:
+            LOG_ERROR("Journal has a second start at record {}: {}", end, path);
+            return Recovered::Unusable;
+        }
+    }
+
+    const GameVariant& variant = GameVariant::get(log.variant);
+    PokerGame game(CounterRng(log.seed), log.startingCredits, variant);
+    game.setHandCount(log.hands);
+    std::size_t next = 0;
+    if (snapshotAt != 0) {
+        GameSnapshot snapshot = {};
+        std::uint8_t* bytes = reinterpret_cast<std::uint8_t*>(&snapshot);
+        for (int slice = 0; slice < SnapshotSlices; ++slice) {
+            const std::uint8_t* source = reinterpret_cast<const std::uint8_t*>(&records[snapshotAt + slice]) + SliceOffset;
+            std::size_t offset = slice * SliceSize;
+            std::memcpy(bytes + offset, source, std::min(SliceSize, sizeof(GameSnapshot) - offset));
+        }
+        if (game.restore(snapshot)) {
+            const JournalRecord& command = records[snapshotAt - 1];
+            log.digest = command.digest;
+            next = eventsAtSnapshot;
+        } else {
+            // Fall back on replaying the session from its start
+            game = PokerGame(CounterRng(log.seed), log.startingCredits, variant);
+            game.setHandCount(log.hands);
+        }
+    }
+
+    GambleResult gambleResult = GambleResult::Push;
+    recovery.rounds = 0;
+    for (std::size_t i = next; i < log.events.size(); ++i) {
+        if (!applyCommand(game, log.events[i].command, gambleResult)) {
+            LOG_ERROR("Journal command {} does nothing in this build: {}", i, path);
+            return Recovered::Unusable;
+        }
+        log.digest = stateDigest(log.digest, game);
+        if (log.events[i].command == Command::Deal && game.getPhase() == GamePhase::Dealt) {
+            ++recovery.rounds;
+        }
+    }
+    if (lastCommand != 0) {
+        const JournalRecord& last = records[lastCommand];
+        if (last.digest != log.digest || last.credits != game.getCredits()) {
+            LOG_ERROR("Journal does not replay to the credits it recorded: {}", path);
+            return Recovered::Unusable;
+        }
+        log.ticks = last.tick;
+    }
+    log.finalCredits = game.getCredits();
+
+    recovery.game = game;
+    recovery.records = static_cast<std::uint32_t>(end);
+    recovery.replayed = static_cast<std::uint32_t>(log.events.size() - next);
+
+    [[maybe_unused]] double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    LOG_INFO("Recovered session from {}: {} commands, {} replayed, {} credits in {} ms", path, log.events.size(),
+             recovery.replayed, game.getCredits(), ms);
+    if (end < count || mapped.size % sizeof(JournalRecord) != 0) {
+        LOG_INFO("Dropped {} torn or damaged bytes at the end of {}", mapped.size - end * sizeof(JournalRecord), path);
+    }
+    return Recovered::Resumable;
+}
+
+}
+
+bool recoverJournal(const std::string& path, JournalRecovery& recovery) {
+    Recovered result = rebuildSession(path, recovery);
+    if (result == Recovered::Unusable) {
+        // The next session would overwrite it, and it holds somebody's credits
+        std::string kept = path + ".unrecovered";
+        std::error_code error;
+        std::filesystem::rename(path, kept, error);
+        LOG_ERROR("Journal kept as {}", kept);
+    }
+    return result == Recovered::Resumable;
+}
+
+Journal::Journal()
+    : sequence(0),
+      rounds(0),
+      file(NoFile),
+      syncDirectory(false),
+      queuedUpTo(0),
+      writtenUpTo(0),
+      stopping(false) {}
+
+Journal::~Journal() {
+    close();
+}
+
+bool Journal::start(const std::string& path, const SessionLog& session) {
+    close();
+    file = openForAppend(path, true, 0);
+    if (file == NoFile) {
+        LOG_ERROR("Could not create journal: {}", path);
+        return false;
+    }
+    sequence = 0;
+    queuedUpTo = writtenUpTo = 0;
+    rounds = 0;
+    syncDirectory = true;
+    directory = std::filesystem::path(path).parent_path().string();
+    stopping = false;
+    writer = std::thread(&Journal::writeLoop, this);
+
+    JournalRecord record = makeRecord(JournalRecordType::Start);
+    record.command = static_cast<std::uint8_t>(session.variant);
+    record.bet = static_cast<std::uint16_t>(session.hands);
+    record.credits = session.startingCredits;
+    record.digest = session.seed;
+    record.win = FormatTag;
+    append(record);
+    return true;
+}
+
+bool Journal::resume(const std::string& path, const JournalRecovery& recovery) {
+    close();
+    // Drops the torn tail, if any, so new records follow the last intact one
+    file = openForAppend(path, false, std::uint64_t(recovery.records) * sizeof(JournalRecord));
+    if (file == NoFile) {
+        LOG_ERROR("Could not reopen journal: {}", path);
+        return false;
+    }
+    sequence = queuedUpTo = writtenUpTo = recovery.records;
+    rounds = recovery.rounds;
+    syncDirectory = false;
+    stopping = false;
+    writer = std::thread(&Journal::writeLoop, this);
+    return true;
+}
+
+bool Journal::isOpen() const {
+    return file != NoFile;
+}
+
+void Journal::recordCommand(std::uint32_t tick, Command command, const PokerGame& game, std::uint64_t digest) {
+    if (file == NoFile) {
+        return;
+    }
+    JournalRecord record = makeRecord(JournalRecordType::Command);
+    record.command = static_cast<std::uint8_t>(command);
+    record.bet = static_cast<std::uint16_t>(game.getBet());
+    record.tick = tick;
+    record.credits = game.getCredits();
+    record.digest = digest;
+    record.win = game.getWin();
+    append(record);
+
+    // Right after a deal the other hands have not drawn yet, so the snapshot is complete
+    if (command != Command::Deal || game.getPhase() != GamePhase::Dealt || ++rounds < SnapshotInterval) {
+        return;
+    }
+    rounds = 0;
+    GameSnapshot snapshot = game.snapshot();
+    const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(&snapshot);
+    for (int slice = 0; slice < SnapshotSlices; ++slice) {
+        JournalRecord part = makeRecord(JournalRecordType::Snapshot);
+        part.command = static_cast<std::uint8_t>(slice);
+        std::size_t offset = slice * SliceSize;
+        std::memcpy(reinterpret_cast<std::uint8_t*>(&part) + SliceOffset, bytes + offset,
+                    std::min(SliceSize, sizeof(GameSnapshot) - offset));
+        append(part);
+    }
+}
+
+void Journal::finish(std::uint32_t ticks, const PokerGame& game, std::uint64_t digest) {
+    if (file == NoFile) {
+        return;
+    }
+    JournalRecord record = makeRecord(JournalRecordType::End);
+    record.tick = ticks;
+    record.credits = game.getCredits();
+    record.digest = digest;
+    append(record);
+    close();
+}
+
+void Journal::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this]() { return writtenUpTo >= queuedUpTo || file == NoFile; });
+}
+
+void Journal::append(JournalRecord record) {
+    record.sequence = sequence++;
+    record.checksum = checksum(record);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.push_back(record);
+        queuedUpTo = sequence;
+    }
+    wakeWriter.notify_one();
+}
+
+// Group commit: everything queued while the last batch was being synced
+// goes out with one write and one sync.
+void Journal::writeLoop() {
+    std::vector<JournalRecord> batch;
+    bool failed = false;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wakeWriter.wait(lock, [this]() { return !queued.empty() || stopping; });
+        if (queued.empty()) {
+            break;
+        }
+        batch.swap(queued);
+        std::uint32_t batchEnd = queuedUpTo;
+        lock.unlock();
+
+        bool ok = writeAll(file, batch.data(), batch.size() * sizeof(JournalRecord)) && syncFile(file);
+        if (ok && syncDirectory) {
+            syncDirectoryOf(directory);
+            syncDirectory = false;
+        }
+        if (!ok && !failed) {
+            LOG_ERROR("Could not write the journal; credits since are not crash-safe");
+        }
+        failed = failed || !ok;
+        batch.clear();
+
+        lock.lock();
+        writtenUpTo = batchEnd;
+        written.notify_all();
+    }
+}
+
+void Journal::close() {
+    if (file == NoFile) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWriter.notify_one();
+    writer.join();
+    closeFile(file);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        file = NoFile;
+        queued.clear();
+    }
+    written.notify_all();
+}
+
+} // namespace SoftyPoker
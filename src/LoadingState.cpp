@@ -0,0 +1,63 @@
+#include "LoadingState.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace SoftyPoker {
+
+namespace {
+
+// GPU upload time allowed per frame, leaving room for the bar to keep moving.
+const sf::Time UploadBudget = sf::milliseconds(4);
+
+}
+
+LoadingState::LoadingState(AssetLoader& loader, std::function<void()> onLoaded)
+    : loader(loader),
+      onLoaded(std::move(onLoaded)),
+      finished(false),
+      shownProgress(0.0f) {
+    barFrame.setFillColor(sf::Color::Transparent);
+    barFrame.setOutlineColor(sf::Color(173, 216, 230));
+    barFrame.setOutlineThickness(2.0f);
+    barFill.setFillColor(sf::Color(144, 238, 144));
+}
+
+void LoadingState::update(sf::RenderTarget& window, sf::Time step) {
+    loader.uploadPending(UploadBudget);
+
+    // Ease the bar towards the real progress so a burst of finished files
+    // does not make it jump.
+    float target = loader.getProgress();
+    shownProgress += (target - shownProgress) * std::min(1.0f, step.asSeconds() * 10.0f);
+
+    if (!finished && loader.isIdle()) {
+        finished = true;
+        onLoaded();
+    }
+}
+
+void LoadingState::draw(sf::RenderTarget& window) {
+    float windowWidth = window.getSize().x;
+    float windowHeight = window.getSize().y;
+    sf::Vector2f barSize(windowWidth * 0.4f, windowHeight * 0.02f);
+    sf::Vector2f barPosition((windowWidth - barSize.x) / 2, windowHeight * 0.75f);
+
+    barFrame.setSize(barSize);
+    barFrame.setPosition(barPosition);
+    barFill.setSize(sf::Vector2f(barSize.x * shownProgress, barSize.y));
+    barFill.setPosition(barPosition);
+
+    window.clear();
+    countedDraw(window, barFrame);
+    countedDraw(window, barFill);
+}
+
+void LoadingState::handleEvent(sf::Event& event, sf::RenderTarget& window) {
+    if (event.type == sf::Event::Resized) {
+        sf::View view = window.getView();
+        view.setSize(event.size.width, event.size.height);
+        window.setView(view);
+    }
+}
+
+} // namespace SoftyPoker
@@ -0,0 +1,365 @@
+#include "Log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SoftyPoker {
+
+namespace {
+
+// One producer, the thread that owns it, and one consumer, the sink
+struct ThreadRing {
+    std::uint32_t threadId;
+    std::unique_ptr<LogRecord[]> records;
+    std::atomic<std::uint64_t> head;
+    std::atomic<std::uint64_t> tail;
+    std::atomic<std::uint64_t> dropped;
+    std::atomic<bool> retired;      // the thread has ended; dropped once drained
+};
+
+struct Line {
+    std::int64_t time;
+    LogLevel level;
+    std::uint32_t thread;
+    std::string text;
+};
+
+const char* levelTag(LogLevel level) {
+    switch (level) {
+    case LogLevel::Debug:
+        return "[Debug] ";
+    case LogLevel::Info:
+        return "[Info] ";
+    case LogLevel::Error:
+        return "[Error] ";
+    }
+    return "";
+}
+
+thread_local ThreadRing* currentRing = nullptr;
+
+// Retires the thread's ring when the thread ends
+struct RingRetire {
+    ~RingRetire() {
+        currentRing->retired.store(true, std::memory_order_release);
+        currentRing = nullptr;
+    }
+};
+
+std::int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}
+
+// Owns the rings and the thread that empties them. Created on first use and
+// never destroyed, so threads may log until the very end; an exit handler
+// writes out what is left.
+struct LogSink {
+    // Lines wait at most this long unless an error or a flush wakes the sink
+    static constexpr std::chrono::milliseconds Interval{ 50 };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable flushed;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    std::uint32_t nextThreadId = 1;
+    std::uint64_t flushRequested = 0;
+    std::uint64_t flushDone = 0;
+    std::atomic<bool> urgent{ false };
+    bool stopping = false;
+    bool console = true;
+    std::string directory;
+    std::thread thread;
+
+    // Sink thread only
+    std::vector<Line> lines;
+    std::ofstream file;
+    std::string openDirectory;
+    std::uint64_t fileBytes = 0;
+
+    LogSink() {
+        thread = std::thread(&LogSink::run, this);
+        std::atexit([]() { instance().stop(); });
+    }
+
+    static LogSink& instance() {
+        static LogSink* sink = new LogSink();
+        return *sink;
+    }
+
+    ThreadRing& registerThread() {
+        auto ring = std::make_unique<ThreadRing>();
+        ring->records = std::make_unique<LogRecord[]>(Log::RingSize);
+        ring->head.store(0, std::memory_order_relaxed);
+        ring->tail.store(0, std::memory_order_relaxed);
+        ring->dropped.store(0, std::memory_order_relaxed);
+        ring->retired.store(false, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex);
+        ring->threadId = nextThreadId++;
+        rings.push_back(std::move(ring));
+        return *rings.back();
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                return;
+            }
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+
+    void run() {
+        std::vector<ThreadRing*> current;
+        std::vector<ThreadRing*> finished;
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait_for(lock, Interval, [this]() {
+                return stopping || flushRequested > flushDone || urgent.load(std::memory_order_relaxed);
+            });
+            urgent.store(false, std::memory_order_relaxed);
+            std::uint64_t request = flushRequested;
+            bool last = stopping;
+            current.clear();
+            finished.clear();
+            for (const auto& ring : rings) {
+                current.push_back(ring.get());
+                // Retired before this pass, so the pass takes its last lines
+                if (ring->retired.load(std::memory_order_acquire)) {
+                    finished.push_back(ring.get());
+                }
+            }
+            std::string target = directory;
+            bool toConsole = console;
+            lock.unlock();
+
+            if (target != openDirectory) {
+                openLogFile(target);
+            }
+            drain(current, toConsole);
+
+            lock.lock();
+            if (!finished.empty()) {
+                rings.erase(std::remove_if(rings.begin(), rings.end(), [&finished](const std::unique_ptr<ThreadRing>& ring) {
+                    return std::find(finished.begin(), finished.end(), ring.get()) != finished.end();
+                }), rings.end());
+            }
+            flushDone = request;
+            flushed.notify_all();
+            if (last) {
+                return;
+            }
+        }
+    }
+
+    void drain(const std::vector<ThreadRing*>& current, bool toConsole) {
+        for (ThreadRing* ring : current) {
+            std::uint64_t head = ring->head.load(std::memory_order_acquire);
+            for (std::uint64_t i = ring->tail.load(std::memory_order_relaxed); i < head; ++i) {
+                const LogRecord& record = ring->records[i % Log::RingSize];
+                lines.push_back(Line{ record.time, record.level, record.thread, format(record) });
+            }
+            ring->tail.store(head, std::memory_order_release);
+            if (std::uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed)) {
+                lines.push_back(Line{ now(), LogLevel::Error, ring->threadId,
+                                      "Log ring full, dropped " + std::to_string(dropped) + " lines" });
+            }
+        }
+        if (lines.empty()) {
+            return;
+        }
+        // Each ring is in order already; this merges the threads
+        std::stable_sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) { return a.time < b.time; });
+
+        for (const Line& line : lines) {
+            if (toConsole) {
+                std::ostream& out = line.level == LogLevel::Error ? std::cerr : std::cout;
+                out << levelTag(line.level) << line.text << '\n';
+            }
+            if (file.is_open()) {
+                writeToFile(line);
+            }
+        }
+        if (toConsole) {
+            std::cout.flush();
+            std::cerr.flush();
+        }
+        if (file.is_open()) {
+            file.flush();
+        }
+        lines.clear();
+    }
+
+    static std::string format(const LogRecord& record) {
+        std::string text;
+        std::size_t offset = 0;
+        int argsLeft = record.argCount;
+        for (const char* c = record.format; *c; ++c) {
+            if (c[0] == '{' && c[1] == '}' && argsLeft > 0 && offset < record.used) {
+                offset = appendArg(text, record, offset);
+                --argsLeft;
+                ++c;
+            } else {
+                text += *c;
+            }
+        }
+        return text;
+    }
+
+    static std::size_t appendArg(std::string& text, const LogRecord& record, std::size_t offset) {
+        const std::uint8_t* data = record.payload.data() + offset + 1;
+        switch (static_cast<Log::ArgType>(record.payload[offset])) {
+        case Log::ArgType::Signed: {
+            std::int64_t value;
+            std::memcpy(&value, data, sizeof(value));
+            text += std::to_string(value);
+            return offset + 1 + sizeof(value);
+        }
+        case Log::ArgType::Unsigned: {
+            std::uint64_t value;
+            std::memcpy(&value, data, sizeof(value));
+            text += std::to_string(value);
+            return offset + 1 + sizeof(value);
+        }
+        case Log::ArgType::Float: {
+            double value;
+            std::memcpy(&value, data, sizeof(value));
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%g", value);
+            text += buffer;
+            return offset + 1 + sizeof(value);
+        }
+        case Log::ArgType::Bool:
+            text += data[0] ? "true" : "false";
+            return offset + 2;
+        case Log::ArgType::Char:
+            text += static_cast<char>(data[0]);
+            return offset + 2;
+        case Log::ArgType::Text: {
+            std::uint16_t length;
+            std::memcpy(&length, data, sizeof(length));
+            text.append(reinterpret_cast<const char*>(data + sizeof(length)), length);
+            return offset + 1 + sizeof(length) + length;
+        }
+        }
+        return record.used;
+    }
+
+    void openLogFile(const std::string& target) {
+        file.close();
+        openDirectory = target;
+        if (target.empty()) {
+            return;
+        }
+        std::error_code error;
+        std::filesystem::create_directories(target, error);
+        std::string path = logPath(0);
+        fileBytes = std::filesystem::exists(path, error) ? std::filesystem::file_size(path, error) : 0;
+        file.open(path, std::ios::app);
+        if (!file) {
+            std::cerr << "[Error] Could not open log file: " << path << std::endl;
+        }
+    }
+
+    std::string logPath(int index) const {
+        return openDirectory + (index == 0 ? "/softypoker.log" : "/softypoker." + std::to_string(index) + ".log");
+    }
+
+    void writeToFile(const Line& line) {
+        char stamp[32];
+        std::time_t seconds = static_cast<std::time_t>(line.time / 1000000000);
+        std::size_t length = std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&seconds));
+        std::snprintf(stamp + length, sizeof(stamp) - length, ".%03d", static_cast<int>(line.time / 1000000 % 1000));
+
+        std::string text = std::string(stamp) + " T" + std::to_string(line.thread) + " " + levelTag(line.level) + line.text + "\n";
+        if (fileBytes > 0 && fileBytes + text.size() > Log::RotateBytes) {
+            rotate();
+        }
+        file << text;
+        fileBytes += text.size();
+    }
+
+    // softypoker.log becomes softypoker.1.log, .1 becomes .2, and the oldest goes
+    void rotate() {
+        file.close();
+        std::error_code error;
+        std::filesystem::remove(logPath(Log::KeptFiles), error);
+        for (int index = Log::KeptFiles - 1; index >= 0; --index) {
+            std::filesystem::rename(logPath(index), logPath(index + 1), error);
+        }
+        file.open(logPath(0), std::ios::trunc);
+        fileBytes = 0;
+    }
+};
+
+void Log::openFile(const std::string& directory) {
+    LogSink& sink = LogSink::instance();
+    std::lock_guard<std::mutex> lock(sink.mutex);
+    sink.directory = directory;
+}
+
+void Log::setConsole(bool enabled) {
+    LogSink& sink = LogSink::instance();
+    std::lock_guard<std::mutex> lock(sink.mutex);
+    sink.console = enabled;
+}
+
+void Log::flush() {
+    LogSink& sink = LogSink::instance();
+    std::unique_lock<std::mutex> lock(sink.mutex);
+    if (sink.stopping) {
+        return;
+    }
+    std::uint64_t ticket = ++sink.flushRequested;
+    sink.wake.notify_one();
+    sink.flushed.wait(lock, [&]() { return sink.flushDone >= ticket || sink.stopping; });
+}
+
+LogRecord* Log::claim() {
+    if (!currentRing) {
+        currentRing = &LogSink::instance().registerThread();
+        thread_local RingRetire ringRetire;
+    }
+    ThreadRing& ring = *currentRing;
+    std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= RingSize) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    LogRecord& record = ring.records[head % RingSize];
+    record.time = now();
+    record.thread = ring.threadId;
+    return &record;
+}
+
+void Log::publish(LogLevel level) {
+    ThreadRing& ring = *currentRing;
+    ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    // Errors go out straight away; the rest wait for the sink's next pass.
+    // Notifying without the mutex can miss a sink that is just going to
+    // sleep, which only delays the line to that pass.
+    if (level == LogLevel::Error) {
+        LogSink& sink = LogSink::instance();
+        sink.urgent.store(true, std::memory_order_relaxed);
+        sink.wake.notify_one();
+    }
+}
+
+} // namespace SoftyPoker
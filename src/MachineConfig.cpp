@@ -0,0 +1,104 @@
+#include "MachineConfig.h"
+#include "MultiHand.h"
+#include "Log.h"
+#include <fstream>
+#include <stdexcept>
+
+namespace SoftyPoker {
+
+namespace {
+
+std::string trim(const std::string& text) {
+    const char* space = " \t\r";
+    std::size_t first = text.find_first_not_of(space);
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    return text.substr(first, text.find_last_not_of(space) - first + 1);
+}
+
+}
+
+MachineConfig loadMachineConfig(const std::string& path) {
+    MachineConfig config;
+    std::ifstream file(path);
+    if (!file) {
+        return config;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        std::size_t equals = line.find('=');
+        std::string key = trim(line.substr(0, equals));
+        std::string value = equals == std::string::npos ? std::string() : trim(line.substr(equals + 1));
+
+        if (key == "variant") {
+            const GameVariant* variant = GameVariant::find(value);
+            if (variant) {
+                config.variant = variant->id;
+            } else {
+                LOG_ERROR("{}:{}: unknown variant {}", path, lineNumber, value);
+            }
+        } else if (key == "hands") {
+            int hands = 0;
+            try {
+                hands = std::stoi(value);
+            } catch (const std::exception&) {
+            }
+            if (isHandCount(hands)) {
+                config.hands = hands;
+            } else {
+                LOG_ERROR("{}:{}: hands must be 1, 3, 10, 50 or 100", path, lineNumber);
+            }
+        } else if (key == "cache_mb") {
+            int megabytes = -1;
+            try {
+                megabytes = std::stoi(value);
+            } catch (const std::exception&) {
+            }
+            if (megabytes >= 0 && megabytes <= 4096) {
+                config.cacheMegabytes = megabytes;
+            } else {
+                LOG_ERROR("{}:{}: cache_mb must be 0 to 4096", path, lineNumber);
+            }
+        } else if (key == "frame_cap") {
+            int frames = -1;
+            try {
+                frames = std::stoi(value);
+            } catch (const std::exception&) {
+            }
+            if (frames >= 0 && frames <= 1000) {
+                config.frameCap = frames;
+            } else {
+                LOG_ERROR("{}:{}: frame_cap must be 0 to 1000", path, lineNumber);
+            }
+        } else if (key == "render_on_demand") {
+            if (value == "yes" || value == "true" || value == "1") {
+                config.renderOnDemand = true;
+            } else if (value == "no" || value == "false" || value == "0") {
+                config.renderOnDemand = false;
+            } else {
+                LOG_ERROR("{}:{}: render_on_demand must be yes or no", path, lineNumber);
+            }
+        } else if (key == "hold_advice") {
+            if (value == "yes" || value == "true" || value == "1") {
+                config.holdAdvice = true;
+            } else if (value == "no" || value == "false" || value == "0") {
+                config.holdAdvice = false;
+            } else {
+                LOG_ERROR("{}:{}: hold_advice must be yes or no", path, lineNumber);
+            }
+        } else {
+            LOG_ERROR("{}:{}: unknown setting {}", path, lineNumber, key);
+        }
+    }
+    return config;
+}
+
+} // namespace SoftyPoker
@@ -1,62 +1,578 @@
 #include "MainGameState.h"
+#include "Utility.h"
+#include "AssetPack.h"
+#include "Profiler.h"
+#include "ResourceCache.h"
+#include "Log.h"
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 
 namespace SoftyPoker {
 
-MainGameState::MainGameState(SoundManager& sp, sf::RenderWindow& window, const std::string& backgroundPath)
-    : soundPlayer(sp) {
-    // Initialize ButtonHandle and add button functionalities
-    buttonHandle.addButton(sf::Keyboard::S, [this]() { startGame(); });
-    buttonHandle.addButton(sf::Keyboard::B, [this]() { bet(); });
-    buttonHandle.addButton(sf::Keyboard::D, [this]() { deal(); });
-    buttonHandle.addButton(sf::Keyboard::C, [this]() { collect(); });
-    buttonHandle.addButton(sf::Keyboard::G, [this]() { enterGamblingState(); });
-    buttonHandle.addButton(sf::Keyboard::Left, [this]() { guessSmall(); });
-    buttonHandle.addButton(sf::Keyboard::Right, [this]() { guessHigh(); });
+namespace {
 
-    // Initialize separate buttons for holding cards
-    buttonHandle.addButton(sf::Keyboard::Num1, [this]() { holdCard(1); });
-    buttonHandle.addButton(sf::Keyboard::Num2, [this]() { holdCard(2); });
-    buttonHandle.addButton(sf::Keyboard::Num3, [this]() { holdCard(3); });
-    buttonHandle.addButton(sf::Keyboard::Num4, [this]() { holdCard(4); });
-    buttonHandle.addButton(sf::Keyboard::Num5, [this]() { holdCard(5); });
+const int StartingCredits = 20;
+// Card faces are 736x1060 in the source art. A quarter of that is their
+// height in the 1280x720 reference layout and still lets all of them
+// share one page; smaller windows pack them at the size they are shown.
+const unsigned MaxCardHeight = 265;
 
-    // Load background texture
-    if (!backgroundTexture.loadFromFile(backgroundPath)) {
-        throw std::runtime_error("Failed to load background texture: " + backgroundPath);
+unsigned fittedCardHeight(sf::Vector2u windowSize) {
+    const float scale = std::min(windowSize.x / 1280.0f, windowSize.y / 720.0f);
+    unsigned height = static_cast<unsigned>(std::ceil(MaxCardHeight * scale));
+    return std::max(1u, std::min(MaxCardHeight, height));
+}
+// Finished sessions are kept here for replays and disputes.
+const char* const SessionDirectory = "sessions";
+
+// Prize rows without art of their own get the name drawn in the style of
+// Assets/images/table: gray narrow bold italic, 455x49.
+sf::Image renderPrizeLabel(const sf::Font& font, const std::string& name) {
+    std::string text = name;
+    text[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(text[0])));
+    sf::Text label(text, font, 44);
+    label.setFillColor(sf::Color(106, 106, 106));
+    label.setPosition(2.0f, -label.getLocalBounds().top + 2.0f);
+
+    sf::RenderTexture target;
+    if (!target.create(455, 49)) {
+        throw std::runtime_error("Failed to create prize label target");
     }
-    backgroundSprite.setTexture(backgroundTexture);
+    target.clear(sf::Color::Transparent);
+    target.draw(label);
+    target.display();
+    return target.getTexture().copyToImage();
+}
+
+}
+
+MainGameState::MainGameState(SoundManager& sp, sf::RenderTarget& window, const std::string& backgroundName, std::uint64_t seed,
+                             const GameVariant& variant, int hands)
+    : soundPlayer(sp),
+      dirty(true),
+      background(backgroundName, window),
+      tick(0),
+      variant(variant),
+      game(CounterRng(seed), StartingCredits * hands, variant),
+      recorder(seed, StartingCredits * hands, variant.id, hands),
+      replayNext(0),
+      replaying(false),
+      keepSession(true),
+      holdAdvice(true),
+      advisedHolds(-1),
+      advisorPool(std::max(2u, std::thread::hardware_concurrency()) - 1),
+      advisor(advisorPool, variant),
+      tableBatch(atlas),
+      cards(sp) {
+    game.setHandCount(hands);
+
+    // Keyboard and gamepad bindings; the on-screen buttons and cards get
+    // their hit areas as the table is laid out
+    buttonHandle.bindKey(sf::Keyboard::S, Command::Start);
+    buttonHandle.bindKey(sf::Keyboard::B, Command::Bet);
+    buttonHandle.bindKey(sf::Keyboard::D, Command::Deal);
+    buttonHandle.bindKey(sf::Keyboard::C, Command::Collect);
+    buttonHandle.bindKey(sf::Keyboard::G, Command::Double);
+    buttonHandle.bindKey(sf::Keyboard::Left, Command::Low);
+    buttonHandle.bindKey(sf::Keyboard::Right, Command::High);
+    buttonHandle.bindKey(sf::Keyboard::Num1, Command::Hold1);
+    buttonHandle.bindKey(sf::Keyboard::Num2, Command::Hold2);
+    buttonHandle.bindKey(sf::Keyboard::Num3, Command::Hold3);
+    buttonHandle.bindKey(sf::Keyboard::Num4, Command::Hold4);
+    buttonHandle.bindKey(sf::Keyboard::Num5, Command::Hold5);
+
+    // Xbox-style layout: A deals, B collects, X bets, Y doubles, bumpers guess
+    buttonHandle.bindJoystickButton(0, Command::Deal);
+    buttonHandle.bindJoystickButton(1, Command::Collect);
+    buttonHandle.bindJoystickButton(2, Command::Bet);
+    buttonHandle.bindJoystickButton(3, Command::Double);
+    buttonHandle.bindJoystickButton(4, Command::Low);
+    buttonHandle.bindJoystickButton(5, Command::High);
+    buttonHandle.bindJoystickButton(7, Command::Start);
+
+    loadTableAtlas(window.getSize());
 }
 
-void MainGameState::update(sf::RenderWindow& window) {
-    sf::Time elapsed = clock.restart();
-    // Use elapsed or comment it out if it's not needed
-    // Update main game logic
+MainGameState::~MainGameState() {
+    recorder.finish(tick, game);
+    const SessionLog& log = recorder.getLog();
+    if (keepSession && !log.events.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(SessionDirectory, error);
+        std::ostringstream path;
+        path << SessionDirectory << "/session-" << std::hex << std::setw(16) << std::setfill('0') << log.seed << ".sps";
+        if (!saveSession(log, path.str())) {
+            LOG_ERROR("Could not save session: {}", path.str());
+        }
+    }
+    journal.finish(tick, game, log.digest);
 }
 
-void MainGameState::draw(sf::RenderWindow& window) {
+void MainGameState::loadTableAtlas(sf::Vector2u windowSize) {
+    const unsigned cardHeight = fittedCardHeight(windowSize);
+    atlasCardHeight = cardHeight;
+    atlas.clear();
+
+    const int deckSize = variant.rules.deckSize;
+    for (int card = 0; card < deckSize; ++card) {
+        std::string name = cardName(static_cast<Card>(card));
+        atlas.add("cards/" + name, "images/cards/" + name + ".png", cardHeight);
+    }
+    atlas.add("cards/card_back", "images/cards/card_back.png", cardHeight);
+    for (int digit = 0; digit < 10; ++digit) {
+        std::string name = "numbers/" + std::to_string(digit);
+        atlas.add(name, "images/" + name + ".png");
+    }
+    // Only the variant's own prize rows are shown
+    std::vector<std::string> tableArt = listAssets("images/table/");
+    // The intro's font, from the cache when it is still there
+    std::shared_ptr<sf::Font> labelFont;
+    for (int row = 0; row < variant.rules.ladderRows; ++row) {
+        std::string name = std::string("table/") + PrizeTable::name(variant.rules.ladder[row]);
+        std::string assetName = "images/" + name + ".png";
+        if (std::find(tableArt.begin(), tableArt.end(), assetName) != tableArt.end()) {
+            atlas.add(name, assetName);
+            continue;
+        }
+        if (!labelFont && !(labelFont = resourceCache().font("fonts/arialnbi.ttf"))) {
+            throw std::runtime_error("Failed to load font: fonts/arialnbi.ttf");
+        }
+        atlas.add(name, renderPrizeLabel(*labelFont, PrizeTable::name(variant.rules.ladder[row])));
+    }
+    for (const char* button : { "bet", "collect", "credits", "deal", "double", "held", "high", "hold", "low" }) {
+        std::string name = std::string("buttons/") + button;
+        atlas.add(name, "images/" + name + ".png");
+    }
+    atlas.build();
+
+    cardRegions.fill(-1);
+    for (int card = 0; card < deckSize; ++card) {
+        cardRegions[card] = atlas.find("cards/" + cardName(static_cast<Card>(card)));
+    }
+    for (int digit = 0; digit < 10; ++digit) {
+        digitRegions[digit] = atlas.find("numbers/" + std::to_string(digit));
+    }
+    prizeRegions.fill(-1);
+    for (int row = 0; row < variant.rules.ladderRows; ++row) {
+        Prize prize = variant.rules.ladder[row];
+        prizeRegions[static_cast<int>(prize)] = atlas.find(std::string("table/") + PrizeTable::name(prize));
+    }
+    cardBackRegion = atlas.find("cards/card_back");
+    heldRegion = atlas.find("buttons/held");
+    holdRegion = atlas.find("buttons/hold");
+    creditsRegion = atlas.find("buttons/credits");
+    betRegion = atlas.find("buttons/bet");
+    dealRegion = atlas.find("buttons/deal");
+    collectRegion = atlas.find("buttons/collect");
+    doubleRegion = atlas.find("buttons/double");
+    lowRegion = atlas.find("buttons/low");
+    highRegion = atlas.find("buttons/high");
+}
+
+// Lays out every table sprite for this frame into tableBatch, against a
+// 1280x720 reference layout scaled to the window.
+void MainGameState::buildTableLayer(sf::Vector2u windowSize) {
+    const float scale = std::min(windowSize.x / 1280.0f, windowSize.y / 720.0f);
+    const float width = static_cast<float>(windowSize.x);
+    const float digitHeight = 49.0f * scale;
+
+    // A window grown past the size the card faces were packed at gets them
+    // packed again, larger, as a grown background is resampled
+    if (fittedCardHeight(windowSize) > atlasCardHeight) {
+        loadTableAtlas(windowSize);
+    }
+
+    tableBatch.clear();
+    buttonHandle.clearHitAreas();
+
+    // The outcome of a draw shows once its cards are face up
+    bool revealed = !cards.isDealing();
+
+    // Prize table on the right, best prize on top, payout for the current bet
+    // beside it. Longer ladders get thinner rows, keeping the height of nine.
+    const VariantRules& rules = variant.rules;
+    int payBet = std::max(1, game.getBet());
+    // Every prize some hand won lights up
+    std::uint32_t hitPrizes = 0;
+    if (revealed && game.getPhase() == GamePhase::Won) {
+        const MultiHand& hands = game.getHands();
+        hitPrizes = 1u << static_cast<int>(game.getPrize());
+        for (int hand = 1; game.getHandCount() > 1 && hand < hands.getCount(); ++hand) {
+            hitPrizes |= 1u << static_cast<int>(hands.getPrize(hand));
+        }
+    }
+    float rowStep = 9.0f * 53.0f * scale / rules.ladderRows;
+    float rowHeight = rowStep - 4.0f * scale;
+    float rowX = width - (455.0f + 170.0f) * scale - 20.0f * scale;
+    for (int row = rules.ladderRows - 1; row >= 0; --row) {
+        Prize prize = rules.ladder[row];
+        float rowY = 20.0f * scale + (rules.ladderRows - 1 - row) * rowStep;
+        bool hit = (hitPrizes >> static_cast<int>(prize)) & 1;
+        sf::Color tint = hit ? sf::Color(255, 255, 140) : sf::Color::White;
+        tableBatch.addScaled(prizeRegions[static_cast<int>(prize)], sf::Vector2f(rowX, rowY), rowHeight, tint);
+        addNumber(rules.paytable.payout(prize, payBet), sf::Vector2f(rowX + 465.0f * scale, rowY), rowHeight);
+    }
+
+    // Credits, bet and win on the left
+    float meterX = 20.0f * scale;
+    tableBatch.addScaled(creditsRegion, sf::Vector2f(meterX, 20.0f * scale), 75.0f * scale);
+    addNumber(game.getCredits(), sf::Vector2f(meterX, 100.0f * scale), digitHeight);
+    tableBatch.addScaled(betRegion, sf::Vector2f(meterX, 170.0f * scale), 40.0f * scale);
+    addNumber(game.getBet(), sf::Vector2f(meterX + 110.0f * scale, 165.0f * scale), digitHeight);
+    if (revealed && game.getWin() > 0) {
+        addNumber(game.getWin(), sf::Vector2f(rowX - 200.0f * scale, 20.0f * scale), digitHeight);
+    }
+
+    if (game.getHandCount() > 1) {
+        addHandGrid(scale, rowX, revealed);
+    }
+
+    // Five card slots across the middle, with hold/held markers under them once dealt
+    cards.layout(windowSize);
+    bool dealt = game.hasHand();
+    std::array<int, 5> faces;
+    for (int i = 0; i < 5; ++i) {
+        const sf::FloatRect& slot = cards.getSlot(i);
+        faces[i] = dealt ? cardRegions[game.getHand()[i]] : cardBackRegion;
+        if (game.getPhase() == GamePhase::Gambling) {
+            // Double up shows the reference card in the first slot
+            faces[i] = i == 0 ? cardRegions[game.getGambleCard()] : cardBackRegion;
+        }
+        if (game.getPhase() == GamePhase::Dealt) {
+            buttonHandle.setHitArea(static_cast<Command>(static_cast<int>(Command::Hold1) + i), slot);
+            int marker = game.isHeld(i) ? heldRegion : holdRegion;
+            float markerWidth = tableBatch.widthForHeight(marker, 25.0f * scale);
+            // The cards the advisor would keep get a green marker
+            bool advised = advisedHolds >= 0 && ((advisedHolds >> i) & 1);
+            sf::Color markerTint = advised ? sf::Color(140, 255, 140) : sf::Color::White;
+            tableBatch.addScaled(marker, sf::Vector2f(slot.left + (slot.width - markerWidth) / 2.0f, slot.top + slot.height + 8.0f * scale), 25.0f * scale, markerTint);
+        }
+    }
+    float gap = 20.0f * scale;
+    float cardsX = cards.getSlot(0).left;
+
+    // Key hints along the bottom for the actions available right now
+    struct Button {
+        int region;
+        Command command;
+    };
+    const Button none = { -1, Command::None };
+    std::array<Button, 3> buttons = { none, none, none };
+    switch (game.getPhase()) {
+    case GamePhase::Betting:
+        buttons = { Button{ betRegion, Command::Bet }, Button{ dealRegion, Command::Deal }, none };
+        break;
+    case GamePhase::Dealt:
+        buttons = { Button{ dealRegion, Command::Deal }, none, none };
+        break;
+    case GamePhase::Won:
+        buttons = { Button{ collectRegion, Command::Collect }, Button{ doubleRegion, Command::Double }, none };
+        break;
+    case GamePhase::Gambling:
+        buttons = { Button{ lowRegion, Command::Low }, Button{ highRegion, Command::High }, Button{ collectRegion, Command::Collect } };
+        break;
+    }
+    float buttonHeight = 40.0f * scale;
+    float buttonX = cardsX;
+    for (const Button& button : buttons) {
+        if (button.region < 0) {
+            break;
+        }
+        sf::Vector2f position(buttonX, windowSize.y - buttonHeight - 20.0f * scale);
+        float buttonWidth = tableBatch.widthForHeight(button.region, buttonHeight);
+        tableBatch.addScaled(button.region, position, buttonHeight);
+        buttonHandle.setHitArea(button.command, sf::FloatRect(position, sf::Vector2f(buttonWidth, buttonHeight)));
+        buttonX += buttonWidth + gap;
+    }
+
+    // Cards go last so they pass over everything else on their way in from the shoe
+    cards.addTo(tableBatch, faces, cardBackRegion);
+}
+
+// The other hands of a multi-hand round, between the meters and the prize
+// table: the held cards as soon as they are held, the rest face down until
+// the draw is shown. Losing hands are dimmed. They go into tableBatch like
+// everything else, so even a hundred hands add no draw call.
+void MainGameState::addHandGrid(float scale, float right, bool revealed) {
+    const MultiHand& hands = game.getHands();
+    const int count = game.getHandCount() - 1;
+    const sf::Vector2f origin(230.0f * scale, 90.0f * scale);
+    const sf::Vector2f area(right - 20.0f * scale - origin.x, 360.0f * scale - origin.y);
+    // A hand is five cards and four gaps of 6% of a card
+    const float cardAspect = 184.0f / 265.0f;
+    const float handAspect = cardAspect * (5.0f + 4.0f * 0.06f);
+
+    // As many columns as make the cards largest
+    float cardHeight = 0.0f;
+    int columns = 1;
+    for (int tryColumns = 1; tryColumns <= count; ++tryColumns) {
+        int rows = (count + tryColumns - 1) / tryColumns;
+        float byHeight = area.y / rows / 1.15f;
+        float byWidth = area.x / tryColumns / 1.1f / handAspect;
+        float height = std::min(byHeight, byWidth);
+        if (height > cardHeight) {
+            cardHeight = height;
+            columns = tryColumns;
+        }
+    }
+    const float cardWidth = cardHeight * cardAspect;
+    const sf::Vector2f cell(cardHeight * handAspect * 1.1f, cardHeight * 1.15f);
+
+    const bool drawn = revealed && hands.isDrawn();
+    for (int hand = 1; hand <= count; ++hand) {
+        int index = hand - 1;
+        sf::Vector2f position(origin.x + (index % columns) * cell.x, origin.y + (index / columns) * cell.y);
+        sf::Color tint = drawn && hands.getPrize(hand) == Prize::None ? sf::Color(120, 120, 120) : sf::Color::White;
+        for (int slot = 0; slot < 5; ++slot) {
+            int region = cardBackRegion;
+            if (drawn) {
+                region = cardRegions[hands.getCard(hand, slot)];
+            } else if (game.hasHand() && game.isHeld(slot) && (game.getPhase() == GamePhase::Dealt || hands.isDrawn())) {
+                // Held cards also stay up while the draw is still being shown
+                region = cardRegions[game.getHand()[slot]];
+            }
+            tableBatch.addScaled(region, sf::Vector2f(position.x + slot * cardWidth * 1.06f, position.y), cardHeight, tint);
+        }
+    }
+}
+
+// Appends value as digit sprites and returns the width used.
+float MainGameState::addNumber(int value, sf::Vector2f position, float height) {
+    std::string digits = std::to_string(value);
+    float x = position.x;
+    for (char digit : digits) {
+        int region = digitRegions[digit - '0'];
+        tableBatch.addScaled(region, sf::Vector2f(x, position.y), height);
+        x += tableBatch.widthForHeight(region, height);
+    }
+    return x - position.x;
+}
+
+void MainGameState::update(sf::RenderTarget& window, sf::Time step) {
+    ++tick;
+    TimedCommand command;
+    while (buttonHandle.poll(command)) {
+        // The player only watches while a replay drives the table
+        if (replaying) {
+            continue;
+        }
+        // D during a deal skips to its end instead of waiting for it; that
+        // changes nothing in the game, so it is not recorded either
+        if (command.command == Command::Deal && cards.fastForward()) {
+            Profiler::recordInputLatency(command.timestamp);
+            dirty = true;
+            continue;
+        }
+        if (execute(command.command)) {
+            record(command.command);
+        }
+        Profiler::recordInputLatency(command.timestamp);
+        dirty = true;
+    }
+
+    if (replaying) {
+        const std::vector<SessionEvent>& events = replayLog.events;
+        while (replayNext < events.size() && events[replayNext].tick <= tick) {
+            Command replayed = events[replayNext++].command;
+            if (replayed == Command::Deal) {
+                cards.fastForward();
+            }
+            if (execute(replayed)) {
+                recorder.record(tick, replayed, game);
+            }
+            dirty = true;
+        }
+        if (replayNext == events.size()) {
+            finishReplay();
+        }
+    }
+
+    // The advice shows up as soon as the solve finishes
+    HoldAdvice advice;
+    if (advisedHolds < 0 && game.getPhase() == GamePhase::Dealt && advisor.getAdvice(advice)) {
+        advisedHolds = advice.bestHold;
+        dirty = true;
+    }
+
+    cards.update(step);
+}
+
+void MainGameState::startReplay(const SessionLog& log) {
+    if (log.variant != variant.id) {
+        LOG_ERROR("Session was played on {}, this table is {}", GameVariant::get(log.variant).title, variant.title);
+        return;
+    }
+    game = PokerGame(CounterRng(log.seed), log.startingCredits, variant);
+    game.setHandCount(log.hands);
+    recorder = SessionRecorder(log.seed, log.startingCredits, variant.id, log.hands);
+    replayLog = log;
+    replayNext = 0;
+    replaying = true;
+    advisor.cancel();
+    advisedHolds = -1;
+    cards.reset();
+    keepSession = false;
+    tick = 0;
+    dirty = true;
+}
+
+void MainGameState::finishReplay() {
+    replaying = false;
+    const SessionLog& replayed = recorder.getLog();
+    if (replayed.digest == replayLog.digest && game.getCredits() == replayLog.finalCredits) {
+        LOG_INFO("Replay finished and matches the recording");
+    } else {
+        LOG_ERROR("Replay diverged from the recording");
+    }
+}
+
+void MainGameState::resumeSession(const JournalRecovery& recovery) {
+    if (recovery.log.variant != variant.id) {
+        LOG_ERROR("Recovered session was played on {}, this table is {}",
+                  GameVariant::get(recovery.log.variant).title, variant.title);
+        return;
+    }
+    game = recovery.game;
+    recorder = SessionRecorder(recovery.log);
+    tick = recovery.log.ticks;
+    cards.reset();
+    advisedHolds = -1;
+    if (game.getPhase() == GamePhase::Dealt) {
+        for (int i = 0; i < 5; ++i) {
+            cards.setHeld(i, game.isHeld(i));
+        }
+        if (holdAdvice) {
+            advisor.request(game.getHand(), game.getBet());
+        }
+    }
+    journal.resume(JournalPath, recovery);
+    dirty = true;
+}
+
+void MainGameState::setKeepSession(bool keep) {
+    keepSession = keep;
+}
+
+void MainGameState::setHoldAdvice(bool show) {
+    holdAdvice = show;
+    if (!show) {
+        advisor.cancel();
+        advisedHolds = -1;
+        dirty = true;
+    }
+}
+
+// Every command the player makes goes to the journal as well as the
+// session, so the credits it left survive a crash.
+void MainGameState::record(Command command) {
+    recorder.record(tick, command, game);
+    journal.recordCommand(tick, command, game, recorder.getLog().digest);
+}
+
+// Runs a command through the same rules a replay uses, then gives the
+// player feedback for it. Returns whether the command changed the game.
+bool MainGameState::execute(Command command) {
+    if (command == Command::Start) {
+        startGame();
+        return false;
+    }
+    GamePhase before = game.getPhase();
+    GambleResult gambleResult = GambleResult::Push;
+    if (!applyCommand(game, command, gambleResult)) {
+        return false;
+    }
+
+    switch (command) {
+    case Command::Bet:
+        soundPlayer.playSound(SoundId::Bet);
+        break;
+    case Command::Deal:
+        // Work out the best holds in the background while the player looks at the cards
+        advisedHolds = -1;
+        if (before == GamePhase::Betting) {
+            cards.dealHand();
+            if (holdAdvice) {
+                advisor.request(game.getHand(), game.getBet());
+            }
+        } else {
+            advisor.cancel();
+            cards.drawCards(~game.getHeldMask() & 0x1f, game.getPhase() == GamePhase::Won ? SoundId::Win : SoundId::Lose);
+        }
+        break;
+    case Command::Collect:
+        soundPlayer.playSound(SoundId::Count);
+        break;
+    case Command::Double:
+        cards.revealCards(1);
+        break;
+    case Command::Low:
+    case Command::High:
+        if (gambleResult == GambleResult::Won) {
+            soundPlayer.playSound(SoundId::Prize);
+        } else if (gambleResult == GambleResult::Lost) {
+            soundPlayer.playSound(SoundId::Lose);
+        }
+        break;
+    case Command::Hold1:
+    case Command::Hold2:
+    case Command::Hold3:
+    case Command::Hold4:
+    case Command::Hold5: {
+        int index = static_cast<int>(command) - static_cast<int>(Command::Hold1);
+        soundPlayer.playSound(game.isHeld(index) ? SoundId::Held : SoundId::Unheld);
+        cards.setHeld(index, game.isHeld(index));
+        break;
+    }
+    default:
+        break;
+    }
+    return true;
+}
+
+bool MainGameState::needsRedraw() const {
+    // The table only changes in response to input and while cards move
+    return dirty || cards.isAnimating();
+}
+
+void MainGameState::draw(sf::RenderTarget& window) {
     window.clear();
-    window.draw(backgroundSprite); // Draw the background
-    // Draw main game elements
-    window.display();
+    background.draw(window);
+    buildTableLayer(window.getSize());
+    window.draw(tableBatch); // Cards, prize table, meters and buttons in one batch
+    dirty = false;
 }
 
-void MainGameState::handleEvent(sf::Event& event, sf::RenderWindow& window) {
-    buttonHandle.handleEvent(event);
-    if (event.type == sf::Event::Closed) {
-        window.close();
+void MainGameState::handleEvent(sf::Event& event, sf::RenderTarget& window) {
+    // Commands are queued here and carried out by the next update()
+    buttonHandle.handleEvent(event, window);
+    if (event.type == sf::Event::Resized) {
+        background.resize(window);
+        dirty = true;
     }
-    // Handle other events
+}
+
+void MainGameState::onEnter() {
+    // A new session replaces the journal of the last one, which closed normally
+    if (keepSession && !journal.isOpen() && recorder.getLog().events.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(SessionDirectory, error);
+        journal.start(JournalPath, recorder.getLog());
+    }
+    dirty = true;
+}
+
+void MainGameState::onResume() {
+    dirty = true;
 }
 
 void MainGameState::startGame() { /* Start game logic */ }
-void MainGameState::bet() { /* Betting logic */ }
-void MainGameState::deal() { /* Dealing cards logic */ }
-void MainGameState::collect() { /* Collect winnings logic */ }
-void MainGameState::enterGamblingState() { /* Enter gambling state logic */ }
-void MainGameState::guessSmall() { /* Guess small logic */ }
-void MainGameState::guessHigh() { /* Guess high logic */ }
-void MainGameState::holdCard(int cardIndex) { /* Hold card logic */ }
 
 } // namespace SoftyPoker
 
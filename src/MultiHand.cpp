@@ -0,0 +1,321 @@
+#include "MultiHand.h"
+#include <algorithm>
+
+// Build with SOFTYPOKER_SIMD=0 to leave only the scalar path.
+#ifndef SOFTYPOKER_SIMD
+#define SOFTYPOKER_SIMD 1
+#endif
+
+#if SOFTYPOKER_SIMD && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SOFTYPOKER_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define SOFTYPOKER_X86_KERNELS 0
+#endif
+
+namespace SoftyPoker {
+
+namespace {
+
+#if SOFTYPOKER_X86_KERNELS
+
+// What the kernels need to know about a variant. A card is wild when its
+// rank (card / 4) is wildRank: the deuces are rank 0 and the joker, card 52,
+// comes out as rank 13. Without wild cards no card has rank 255.
+struct KernelParams {
+    std::uint8_t wildRank;
+    std::uint8_t lowestPairRank;
+};
+
+KernelParams kernelParams(const VariantRules& rules) {
+    KernelParams params;
+    params.wildRank = rules.wild == WildCards::Deuces ? 0 : rules.wild == WildCards::Joker ? cardRank(Joker) : 255;
+    params.lowestPairRank = static_cast<std::uint8_t>(rules.lowestPairRank);
+    return params;
+}
+
+// The kernels work out the same case the scalar evaluator looks up, with
+// every hand in a byte lane:
+//   key    wild cards * 11 + equal pairs among the naturals
+//   flags  VariantTables::Flag bits
+// Rank counts come from the ten pairwise compares of the five slots, and the
+// straight, royal and suit tests from the highest and lowest natural rank
+// (ace high and ace low) and suit, so nothing needs a table or a variable shift.
+
+// Unsigned byte compares, all ones where they hold
+__attribute__((target("sse4.1")))
+inline __m128i atLeast(__m128i a, __m128i b) {
+    return _mm_cmpeq_epi8(_mm_max_epu8(a, b), a);
+}
+
+__attribute__((target("sse4.1")))
+inline __m128i atMost(__m128i a, __m128i b) {
+    return _mm_cmpeq_epi8(_mm_min_epu8(a, b), a);
+}
+
+__attribute__((target("avx2")))
+inline __m256i atLeast(__m256i a, __m256i b) {
+    return _mm256_cmpeq_epi8(_mm256_max_epu8(a, b), a);
+}
+
+__attribute__((target("avx2")))
+inline __m256i atMost(__m256i a, __m256i b) {
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(a, b), a);
+}
+
+__attribute__((target("sse4.1")))
+void classifySse41(const Card* const slots[5], int count, KernelParams params, std::uint8_t* keys, std::uint8_t* flags) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i all = _mm_set1_epi8(-1);
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i four = _mm_set1_epi8(4);
+    const __m128i three = _mm_set1_epi8(3);
+    const __m128i rankBits = _mm_set1_epi8(0x3F);
+    const __m128i ace = _mm_set1_epi8(12);
+    const __m128i ten = _mm_set1_epi8(8);
+    const __m128i wildRank = _mm_set1_epi8(static_cast<char>(params.wildRank));
+    const __m128i lowestPair = _mm_set1_epi8(static_cast<char>(params.lowestPairRank));
+
+    for (int base = 0; base < count; base += 16) {
+        __m128i ranks[5];
+        __m128i wild = zero;
+        __m128i highest = zero;
+        __m128i lowest = all;
+        __m128i highestAceLow = zero;
+        __m128i lowestAceLow = all;
+        __m128i highestSuit = zero;
+        __m128i lowestSuit = all;
+        __m128i payingNatural = zero;
+        for (int slot = 0; slot < 5; ++slot) {
+            __m128i card = _mm_loadu_si128(reinterpret_cast<const __m128i*>(slots[slot] + base));
+            __m128i rank = _mm_and_si128(_mm_srli_epi16(card, 2), rankBits);
+            __m128i suit = _mm_and_si128(card, three);
+            __m128i isWild = _mm_cmpeq_epi8(rank, wildRank);
+            wild = _mm_sub_epi8(wild, isWild);
+            // Wild cards get a rank of their own so they never pair, and are
+            // left out of the ranges
+            ranks[slot] = _mm_blendv_epi8(rank, _mm_set1_epi8(static_cast<char>(16 + slot)), isWild);
+            highest = _mm_max_epu8(highest, _mm_andnot_si128(isWild, rank));
+            lowest = _mm_min_epu8(lowest, _mm_or_si128(isWild, rank));
+            __m128i aceLow = _mm_andnot_si128(_mm_cmpeq_epi8(rank, ace), _mm_add_epi8(rank, one));
+            highestAceLow = _mm_max_epu8(highestAceLow, _mm_andnot_si128(isWild, aceLow));
+            lowestAceLow = _mm_min_epu8(lowestAceLow, _mm_or_si128(isWild, aceLow));
+            highestSuit = _mm_max_epu8(highestSuit, _mm_andnot_si128(isWild, suit));
+            lowestSuit = _mm_min_epu8(lowestSuit, _mm_or_si128(isWild, suit));
+            payingNatural = _mm_or_si128(payingNatural, _mm_andnot_si128(isWild, atLeast(rank, lowestPair)));
+        }
+
+        __m128i equalPairs = zero;
+        __m128i payingPair = zero;
+        for (int a = 0; a < 4; ++a) {
+            __m128i paying = atLeast(ranks[a], lowestPair);
+            for (int b = a + 1; b < 5; ++b) {
+                __m128i equal = _mm_cmpeq_epi8(ranks[a], ranks[b]);
+                equalPairs = _mm_sub_epi8(equalPairs, equal);
+                payingPair = _mm_or_si128(payingPair, _mm_and_si128(equal, paying));
+            }
+        }
+
+        __m128i straight = _mm_or_si128(atMost(_mm_sub_epi8(highest, lowest), four),
+                                        atMost(_mm_sub_epi8(highestAceLow, lowestAceLow), four));
+        __m128i royal = atLeast(lowest, ten);
+        __m128i suited = _mm_cmpeq_epi8(highestSuit, lowestSuit);
+        // With a wild card any paying natural makes the pair
+        __m128i pairPays = _mm_blendv_epi8(payingNatural, payingPair, _mm_cmpeq_epi8(wild, zero));
+        __m128i flagBits = _mm_or_si128(_mm_or_si128(_mm_and_si128(straight, _mm_set1_epi8(VariantTables::FitsStraight)),
+                                                     _mm_and_si128(royal, _mm_set1_epi8(VariantTables::FitsRoyal))),
+                                        _mm_or_si128(_mm_and_si128(suited, _mm_set1_epi8(VariantTables::Suited)),
+                                                     _mm_and_si128(pairPays, _mm_set1_epi8(VariantTables::PairPays))));
+        __m128i wild2 = _mm_add_epi8(wild, wild);
+        __m128i wild8 = _mm_add_epi8(_mm_add_epi8(wild2, wild2), _mm_add_epi8(wild2, wild2));
+        __m128i key = _mm_add_epi8(_mm_add_epi8(wild8, wild2), _mm_add_epi8(wild, equalPairs));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(keys + base), key);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(flags + base), flagBits);
+    }
+}
+
+__attribute__((target("avx2")))
+void classifyAvx2(const Card* const slots[5], int count, KernelParams params, std::uint8_t* keys, std::uint8_t* flags) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i all = _mm256_set1_epi8(-1);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i four = _mm256_set1_epi8(4);
+    const __m256i three = _mm256_set1_epi8(3);
+    const __m256i rankBits = _mm256_set1_epi8(0x3F);
+    const __m256i ace = _mm256_set1_epi8(12);
+    const __m256i ten = _mm256_set1_epi8(8);
+    const __m256i wildRank = _mm256_set1_epi8(static_cast<char>(params.wildRank));
+    const __m256i lowestPair = _mm256_set1_epi8(static_cast<char>(params.lowestPairRank));
+
+    for (int base = 0; base < count; base += 32) {
+        __m256i ranks[5];
+        __m256i wild = zero;
+        __m256i highest = zero;
+        __m256i lowest = all;
+        __m256i highestAceLow = zero;
+        __m256i lowestAceLow = all;
+        __m256i highestSuit = zero;
+        __m256i lowestSuit = all;
+        __m256i payingNatural = zero;
+        for (int slot = 0; slot < 5; ++slot) {
+            __m256i card = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(slots[slot] + base));
+            __m256i rank = _mm256_and_si256(_mm256_srli_epi16(card, 2), rankBits);
+            __m256i suit = _mm256_and_si256(card, three);
+            __m256i isWild = _mm256_cmpeq_epi8(rank, wildRank);
+            wild = _mm256_sub_epi8(wild, isWild);
+            ranks[slot] = _mm256_blendv_epi8(rank, _mm256_set1_epi8(static_cast<char>(16 + slot)), isWild);
+            highest = _mm256_max_epu8(highest, _mm256_andnot_si256(isWild, rank));
+            lowest = _mm256_min_epu8(lowest, _mm256_or_si256(isWild, rank));
+            __m256i aceLow = _mm256_andnot_si256(_mm256_cmpeq_epi8(rank, ace), _mm256_add_epi8(rank, one));
+            highestAceLow = _mm256_max_epu8(highestAceLow, _mm256_andnot_si256(isWild, aceLow));
+            lowestAceLow = _mm256_min_epu8(lowestAceLow, _mm256_or_si256(isWild, aceLow));
+            highestSuit = _mm256_max_epu8(highestSuit, _mm256_andnot_si256(isWild, suit));
+            lowestSuit = _mm256_min_epu8(lowestSuit, _mm256_or_si256(isWild, suit));
+            payingNatural = _mm256_or_si256(payingNatural, _mm256_andnot_si256(isWild, atLeast(rank, lowestPair)));
+        }
+
+        __m256i equalPairs = zero;
+        __m256i payingPair = zero;
+        for (int a = 0; a < 4; ++a) {
+            __m256i paying = atLeast(ranks[a], lowestPair);
+            for (int b = a + 1; b < 5; ++b) {
+                __m256i equal = _mm256_cmpeq_epi8(ranks[a], ranks[b]);
+                equalPairs = _mm256_sub_epi8(equalPairs, equal);
+                payingPair = _mm256_or_si256(payingPair, _mm256_and_si256(equal, paying));
+            }
+        }
+
+        __m256i straight = _mm256_or_si256(atMost(_mm256_sub_epi8(highest, lowest), four),
+                                           atMost(_mm256_sub_epi8(highestAceLow, lowestAceLow), four));
+        __m256i royal = atLeast(lowest, ten);
+        __m256i suited = _mm256_cmpeq_epi8(highestSuit, lowestSuit);
+        __m256i pairPays = _mm256_blendv_epi8(payingNatural, payingPair, _mm256_cmpeq_epi8(wild, zero));
+        __m256i flagBits = _mm256_or_si256(
+            _mm256_or_si256(_mm256_and_si256(straight, _mm256_set1_epi8(VariantTables::FitsStraight)),
+                            _mm256_and_si256(royal, _mm256_set1_epi8(VariantTables::FitsRoyal))),
+            _mm256_or_si256(_mm256_and_si256(suited, _mm256_set1_epi8(VariantTables::Suited)),
+                            _mm256_and_si256(pairPays, _mm256_set1_epi8(VariantTables::PairPays))));
+        __m256i wild2 = _mm256_add_epi8(wild, wild);
+        __m256i wild8 = _mm256_add_epi8(_mm256_add_epi8(wild2, wild2), _mm256_add_epi8(wild2, wild2));
+        __m256i key = _mm256_add_epi8(_mm256_add_epi8(wild8, wild2), _mm256_add_epi8(wild, equalPairs));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + base), key);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(flags + base), flagBits);
+    }
+}
+
+#endif
+
+HandKernel detectKernel() {
+#if SOFTYPOKER_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return HandKernel::Avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return HandKernel::Sse41;
+    }
+#endif
+    return HandKernel::Scalar;
+}
+
+HandKernel& selectedKernel() {
+    static HandKernel kernel = detectKernel();
+    return kernel;
+}
+
+} // namespace
+
+const char* handKernelName(HandKernel kernel) {
+    switch (kernel) {
+    case HandKernel::Sse41:
+        return "sse4.1";
+    case HandKernel::Avx2:
+        return "avx2";
+    case HandKernel::Scalar:
+    default:
+        return "scalar";
+    }
+}
+
+bool handKernelSupported(HandKernel kernel) {
+    return static_cast<int>(kernel) <= static_cast<int>(detectKernel());
+}
+
+HandKernel activeHandKernel() {
+    return selectedKernel();
+}
+
+void setHandKernel(HandKernel kernel) {
+    if (handKernelSupported(kernel)) {
+        selectedKernel() = kernel;
+    }
+}
+
+void evaluateHands(const GameVariant& variant, const Card* const slots[5], int count, std::uint8_t* prizes) {
+    HandKernel kernel = selectedKernel();
+    if (kernel == HandKernel::Scalar) {
+        for (int hand = 0; hand < count; ++hand) {
+            Card cards[5] = { slots[0][hand], slots[1][hand], slots[2][hand], slots[3][hand], slots[4][hand] };
+            prizes[hand] = static_cast<std::uint8_t>(variant.evaluate(cards));
+        }
+        return;
+    }
+
+#if SOFTYPOKER_X86_KERNELS
+    alignas(32) std::uint8_t keys[MultiHand::PaddedHands];
+    alignas(32) std::uint8_t flags[MultiHand::PaddedHands];
+    KernelParams params = kernelParams(variant.rules);
+    // A block at a time, so any count fits the buffers above
+    for (int first = 0; first < count; first += MultiHand::PaddedHands) {
+        int blockCount = std::min(count - first, MultiHand::PaddedHands);
+        const Card* block[5] = { slots[0] + first, slots[1] + first, slots[2] + first, slots[3] + first, slots[4] + first };
+        if (kernel == HandKernel::Avx2) {
+            classifyAvx2(block, blockCount, params, keys, flags);
+        } else {
+            classifySse41(block, blockCount, params, keys, flags);
+        }
+        visitVariant(variant.id, [&](auto evaluator) {
+            const std::uint8_t* table = &decltype(evaluator)::tables.prize[0][0][0];
+            for (int hand = 0; hand < blockCount; ++hand) {
+                prizes[first + hand] = table[keys[hand] * 16 + flags[hand]];
+            }
+        });
+    }
+#endif
+}
+
+MultiHand::MultiHand()
+    : count(1),
+      drawn(false) {
+    // Lanes past the last hand still hold real cards, so the kernels can
+    // read them like any other
+    for (int slot = 0; slot < 5; ++slot) {
+        cards[slot].fill(static_cast<Card>(slot));
+    }
+    prizes.fill(0);
+}
+
+void MultiHand::draw(const std::array<Card, 5>& base, int heldMask, const Deck& remaining, CounterRng& rng, int count) {
+    this->count = count;
+    for (int slot = 0; slot < 5; ++slot) {
+        cards[slot][0] = base[slot];
+    }
+    for (int hand = 1; hand < count; ++hand) {
+        Deck deck = remaining;
+        for (int slot = 0; slot < 5; ++slot) {
+            cards[slot][hand] = (heldMask >> slot) & 1 ? base[slot] : deck.draw(rng);
+        }
+    }
+    drawn = true;
+}
+
+void MultiHand::clear() {
+    drawn = false;
+}
+
+void MultiHand::evaluate(const GameVariant& variant) {
+    const Card* slots[5] = { cards[0].data(), cards[1].data(), cards[2].data(), cards[3].data(), cards[4].data() };
+    evaluateHands(variant, slots, count, prizes.data());
+}
+
+} // namespace SoftyPoker
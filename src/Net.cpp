@@ -0,0 +1,311 @@
+#include "Net.h"
+#include "Log.h"
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#endif
+
+namespace SoftyPoker {
+
+namespace {
+
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+
+bool wouldBlock() {
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+#else
+using NativeSocket = int;
+
+bool wouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+#endif
+
+NativeSocket native(SocketHandle socket) {
+    return static_cast<NativeSocket>(socket);
+}
+
+bool makeNonBlocking(SocketHandle socket) {
+#ifdef _WIN32
+    u_long enabled = 1;
+    return ioctlsocket(native(socket), FIONBIO, &enabled) == 0;
+#else
+    int flags = fcntl(native(socket), F_GETFL, 0);
+    return flags >= 0 && fcntl(native(socket), F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// Replies are small and each one is waited for, so they go out at once
+void disableNagle(SocketHandle socket) {
+    int enabled = 1;
+    setsockopt(native(socket), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enabled), sizeof(enabled));
+}
+
+}
+
+bool initSockets() {
+#ifdef _WIN32
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    return true;
+#endif
+}
+
+SocketHandle listenOn(std::uint16_t port, bool loopbackOnly) {
+    NativeSocket listener = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+#ifdef _WIN32
+    if (listener == INVALID_SOCKET) {
+#else
+    if (listener < 0) {
+#endif
+        LOG_ERROR("Could not create a socket");
+        return NoSocket;
+    }
+    SocketHandle handle = static_cast<SocketHandle>(listener);
+    int enabled = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&enabled), sizeof(enabled));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+    if (::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0 || !makeNonBlocking(handle)) {
+        LOG_ERROR("Could not listen on port {}", port);
+        closeSocket(handle);
+        return NoSocket;
+    }
+    return handle;
+}
+
+SocketHandle acceptConnection(SocketHandle listener) {
+    NativeSocket accepted = ::accept(native(listener), nullptr, nullptr);
+#ifdef _WIN32
+    if (accepted == INVALID_SOCKET) {
+#else
+    if (accepted < 0) {
+#endif
+        return NoSocket;
+    }
+    SocketHandle handle = static_cast<SocketHandle>(accepted);
+    if (!makeNonBlocking(handle)) {
+        closeSocket(handle);
+        return NoSocket;
+    }
+    disableNagle(handle);
+    return handle;
+}
+
+SocketHandle connectTo(const std::string& host, std::uint16_t port) {
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &found) != 0 || !found) {
+        return NoSocket;
+    }
+    NativeSocket connection = ::socket(found->ai_family, found->ai_socktype, found->ai_protocol);
+    SocketHandle handle = static_cast<SocketHandle>(connection);
+#ifdef _WIN32
+    bool created = connection != INVALID_SOCKET;
+#else
+    bool created = connection >= 0;
+#endif
+    bool connected = created && ::connect(connection, found->ai_addr, static_cast<int>(found->ai_addrlen)) == 0;
+    freeaddrinfo(found);
+    if (!connected || !makeNonBlocking(handle)) {
+        if (created) {
+            closeSocket(handle);
+        }
+        return NoSocket;
+    }
+    disableNagle(handle);
+    return handle;
+}
+
+void closeSocket(SocketHandle socket) {
+#ifdef _WIN32
+    closesocket(native(socket));
+#else
+    ::close(native(socket));
+#endif
+}
+
+long receiveSome(SocketHandle socket, void* data, std::size_t size) {
+    long received = ::recv(native(socket), static_cast<char*>(data), static_cast<int>(size), 0);
+    if (received > 0) {
+        return received;
+    }
+    return received < 0 && wouldBlock() ? 0 : -1;
+}
+
+long sendSome(SocketHandle socket, const void* data, std::size_t size) {
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;      // a closed peer is an error, not a SIGPIPE
+#else
+    const int flags = 0;
+#endif
+    long sent = ::send(native(socket), static_cast<const char*>(data), static_cast<int>(size), flags);
+    if (sent >= 0) {
+        return sent;
+    }
+    return wouldBlock() ? 0 : -1;
+}
+
+#ifdef __linux__
+
+Poller::Poller() : epoll(epoll_create1(EPOLL_CLOEXEC)) {
+    if (epoll < 0) {
+        LOG_ERROR("Could not create an epoll instance");
+    }
+}
+
+Poller::~Poller() {
+    if (epoll >= 0) {
+        ::close(epoll);
+    }
+}
+
+bool Poller::add(SocketHandle socket, std::uint64_t token) {
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.u64 = token;
+    return epoll_ctl(epoll, EPOLL_CTL_ADD, native(socket), &event) == 0;
+}
+
+void Poller::watchWritable(SocketHandle socket, std::uint64_t token, bool watch) {
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    if (watch) {
+        event.events |= EPOLLOUT;
+    }
+    event.data.u64 = token;
+    epoll_ctl(epoll, EPOLL_CTL_MOD, native(socket), &event);
+}
+
+void Poller::remove(SocketHandle socket) {
+    epoll_ctl(epoll, EPOLL_CTL_DEL, native(socket), nullptr);
+}
+
+int Poller::wait(std::vector<PollEvent>& events, int timeoutMs) {
+    constexpr int MaxEvents = 256;
+    epoll_event ready[MaxEvents];
+    int count = epoll_wait(epoll, ready, MaxEvents, timeoutMs);
+    events.clear();
+    for (int i = 0; i < count; ++i) {
+        std::uint32_t flags = ready[i].events;
+        events.push_back(PollEvent{ ready[i].data.u64, (flags & (EPOLLIN | EPOLLRDHUP)) != 0,
+                                    (flags & EPOLLOUT) != 0, (flags & (EPOLLERR | EPOLLHUP)) != 0 });
+    }
+    return static_cast<int>(events.size());
+}
+
+#else
+
+namespace {
+
+#ifdef _WIN32
+int pollSockets(std::vector<WSAPOLLFD>& fds, int timeoutMs) {
+    return WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeoutMs);
+}
+thread_local std::vector<WSAPOLLFD> pollSet;
+#else
+int pollSockets(std::vector<pollfd>& fds, int timeoutMs) {
+    return ::poll(fds.data(), static_cast<nfds_t>(fds.size()), timeoutMs);
+}
+thread_local std::vector<pollfd> pollSet;
+#endif
+
+}
+
+Poller::Poller() {
+}
+
+Poller::~Poller() {
+}
+
+bool Poller::add(SocketHandle socket, std::uint64_t token) {
+    if (positions.count(socket)) {
+        return false;
+    }
+    positions[socket] = watched.size();
+    watched.push_back(Watched{ socket, token, false });
+    return true;
+}
+
+void Poller::watchWritable(SocketHandle socket, std::uint64_t token, bool watch) {
+    auto found = positions.find(socket);
+    if (found != positions.end()) {
+        watched[found->second].token = token;
+        watched[found->second].writable = watch;
+    }
+}
+
+void Poller::remove(SocketHandle socket) {
+    auto found = positions.find(socket);
+    if (found == positions.end()) {
+        return;
+    }
+    std::size_t position = found->second;
+    positions.erase(found);
+    if (position + 1 != watched.size()) {
+        watched[position] = watched.back();
+        positions[watched[position].socket] = position;
+    }
+    watched.pop_back();
+}
+
+int Poller::wait(std::vector<PollEvent>& events, int timeoutMs) {
+    pollSet.resize(watched.size());
+    for (std::size_t i = 0; i < watched.size(); ++i) {
+        pollSet[i].fd = native(watched[i].socket);
+        pollSet[i].events = POLLIN | (watched[i].writable ? POLLOUT : 0);
+        pollSet[i].revents = 0;
+    }
+    events.clear();
+    if (pollSockets(pollSet, timeoutMs) <= 0) {
+        return 0;
+    }
+    for (std::size_t i = 0; i < pollSet.size(); ++i) {
+        short flags = pollSet[i].revents;
+        if (flags) {
+            events.push_back(PollEvent{ watched[i].token, (flags & POLLIN) != 0, (flags & POLLOUT) != 0,
+                                        (flags & (POLLERR | POLLHUP | POLLNVAL)) != 0 });
+        }
+    }
+    return static_cast<int>(events.size());
+}
+
+#endif
+
+} // namespace SoftyPoker
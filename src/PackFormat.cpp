@@ -0,0 +1,143 @@
+#include "PackFormat.h"
+#include <algorithm>
+#include <cstring>
+
+namespace SoftyPoker {
+
+namespace Pack {
+
+namespace {
+
+constexpr std::size_t MinMatch = 4;
+constexpr std::size_t MaxOffset = 65535;
+constexpr int HashBits = 14;
+
+std::uint32_t read32(const std::uint8_t* p) {
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::uint32_t hash4(std::uint32_t value) {
+    return (value * 2654435761u) >> (32 - HashBits);
+}
+
+void putLength(std::vector<std::uint8_t>& out, std::size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<std::uint8_t>(length));
+}
+
+// token = literal count (high nibble) | match length - MinMatch (low nibble);
+// a nibble of 15 continues in extra bytes. The final sequence has no match.
+void putSequence(std::vector<std::uint8_t>& out, const std::uint8_t* literals, std::size_t literalCount,
+                 std::size_t offset, std::size_t matchLength) {
+    std::size_t matchCode = matchLength ? matchLength - MinMatch : 0;
+    std::uint8_t token = static_cast<std::uint8_t>((std::min<std::size_t>(literalCount, 15) << 4) |
+                                                   std::min<std::size_t>(matchCode, 15));
+    out.push_back(token);
+    if (literalCount >= 15) {
+        putLength(out, literalCount - 15);
+    }
+    out.insert(out.end(), literals, literals + literalCount);
+    if (matchLength) {
+        out.push_back(static_cast<std::uint8_t>(offset));
+        out.push_back(static_cast<std::uint8_t>(offset >> 8));
+        if (matchCode >= 15) {
+            putLength(out, matchCode - 15);
+        }
+    }
+}
+
+bool getLength(const std::uint8_t*& in, const std::uint8_t* end, std::size_t& length) {
+    std::uint8_t byte;
+    do {
+        if (in == end) {
+            return false;
+        }
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+}
+
+std::vector<std::uint8_t> compress(const std::uint8_t* data, std::size_t size) {
+    std::vector<std::uint8_t> out;
+    out.reserve(size / 2 + 16);
+    std::vector<std::int64_t> table(std::size_t(1) << HashBits, -1);
+
+    std::size_t anchor = 0;
+    std::size_t pos = 0;
+    while (pos + MinMatch <= size) {
+        std::uint32_t value = read32(data + pos);
+        std::uint32_t slot = hash4(value);
+        std::int64_t candidate = table[slot];
+        table[slot] = static_cast<std::int64_t>(pos);
+
+        if (candidate >= 0 && pos - candidate <= MaxOffset && read32(data + candidate) == value) {
+            std::size_t length = MinMatch;
+            while (pos + length < size && data[candidate + length] == data[pos + length]) {
+                ++length;
+            }
+            putSequence(out, data + anchor, pos - anchor, pos - candidate, length);
+            pos += length;
+            anchor = pos;
+        } else {
+            ++pos;
+        }
+    }
+    putSequence(out, data + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+bool decompress(const std::uint8_t* data, std::size_t size, std::uint8_t* out, std::size_t outSize) {
+    const std::uint8_t* in = data;
+    const std::uint8_t* end = data + size;
+    std::size_t written = 0;
+
+    while (in < end) {
+        std::uint8_t token = *in++;
+        std::size_t literalCount = token >> 4;
+        if (literalCount == 15 && !getLength(in, end, literalCount)) {
+            return false;
+        }
+        if (literalCount > static_cast<std::size_t>(end - in) || literalCount > outSize - written) {
+            return false;
+        }
+        std::memcpy(out + written, in, literalCount);
+        in += literalCount;
+        written += literalCount;
+        if (in == end) {
+            break;
+        }
+
+        if (end - in < 2) {
+            return false;
+        }
+        std::size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        std::size_t matchLength = token & 15;
+        if (matchLength == 15 && !getLength(in, end, matchLength)) {
+            return false;
+        }
+        matchLength += MinMatch;
+        if (offset == 0 || offset > written || matchLength > outSize - written) {
+            return false;
+        }
+        // Byte by byte: the source may overlap the bytes being written.
+        const std::uint8_t* from = out + written - offset;
+        for (std::size_t i = 0; i < matchLength; ++i) {
+            out[written + i] = from[i];
+        }
+        written += matchLength;
+    }
+    return written == outSize;
+}
+
+} // namespace Pack
+
+} // namespace SoftyPoker
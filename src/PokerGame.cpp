@@ -0,0 +1,207 @@
+#include "PokerGame.h"
+
+namespace SoftyPoker {
+
+PokerGame::PokerGame(const CounterRng& rng, int startingCredits, const GameVariant& variant)
+    : PokerGame(rng, startingCredits, variant, variant.rules.paytable) {}
+
+PokerGame::PokerGame(const CounterRng& rng, int startingCredits, const GameVariant& variant, const Paytable& paytable)
+    : rng(rng),
+      variant(&variant),
+      paytable(paytable),
+      deck(variant.rules.deckSize),
+      hand(),
+      handDealt(false),
+      heldMask(0),
+      phase(GamePhase::Betting),
+      credits(startingCredits),
+      currentBet(0),
+      win(0),
+      prize(Prize::None),
+      gambleCard(0),
+      handCount(1) {}
+
+bool PokerGame::setHandCount(int count) {
+    if (phase != GamePhase::Betting || currentBet != 0 || !isHandCount(count)) {
+        return false;
+    }
+    handCount = count;
+    return true;
+}
+
+void PokerGame::insertCredits(int amount) {
+    credits += amount;
+}
+
+int PokerGame::cashOut() {
+    int paid = credits;
+    credits = 0;
+    return paid;
+}
+
+bool PokerGame::bet() {
+    if (phase != GamePhase::Betting) {
+        return false;
+    }
+    if (currentBet < MaxBet && credits >= handCount) {
+        credits -= handCount;
+        ++currentBet;
+        return true;
+    }
+    if (currentBet > 1) {
+        credits += (currentBet - 1) * handCount;
+        currentBet = 1;
+        return true;
+    }
+    return false;
+}
+
+bool PokerGame::deal() {
+    if (phase == GamePhase::Betting) {
+        if (currentBet == 0) {
+            return false;
+        }
+        deck.reset();
+        for (Card& card : hand) {
+            card = deck.draw(rng);
+        }
+        handDealt = true;
+        hands.clear();
+        heldMask = 0;
+        win = 0;
+        prize = Prize::None;
+        phase = GamePhase::Dealt;
+        return true;
+    }
+
+    if (phase == GamePhase::Dealt) {
+        // The other hands draw from the deck as the dealt hand found it
+        Deck remaining = deck;
+        for (int i = 0; i < 5; ++i) {
+            if (!isHeld(i)) {
+                hand[i] = deck.draw(rng);
+            }
+        }
+        if (handCount == 1) {
+            prize = variant->evaluate(hand.data());
+            win = paytable.payout(prize, currentBet);
+        } else {
+            hands.draw(hand, heldMask, remaining, rng, handCount);
+            hands.evaluate(*variant);
+            prize = hands.getPrize(0);
+            win = 0;
+            for (int h = 0; h < handCount; ++h) {
+                win += paytable.payout(hands.getPrize(h), currentBet);
+            }
+        }
+        currentBet = 0;
+        phase = win > 0 ? GamePhase::Won : GamePhase::Betting;
+        return true;
+    }
+
+    return false;
+}
+
+bool PokerGame::toggleHold(int index) {
+    if (phase != GamePhase::Dealt || index < 0 || index >= 5) {
+        return false;
+    }
+    heldMask ^= 1 << index;
+    return true;
+}
+
+bool PokerGame::collect() {
+    if (phase != GamePhase::Won && phase != GamePhase::Gambling) {
+        return false;
+    }
+    credits += win;
+    win = 0;
+    phase = GamePhase::Betting;
+    return true;
+}
+
+bool PokerGame::enterGamble() {
+    if (phase != GamePhase::Won) {
+        return false;
+    }
+    deck.reset();
+    gambleCard = deck.draw(rng);
+    phase = GamePhase::Gambling;
+    return true;
+}
+
+GambleResult PokerGame::guess(bool high) {
+    if (phase != GamePhase::Gambling) {
+        return GambleResult::Lost;
+    }
+    if (deck.remaining() == 0) {
+        deck.reset();
+    }
+    Card next = deck.draw(rng);
+    int difference = cardRank(next) - cardRank(gambleCard);
+    gambleCard = next;
+
+    if (difference == 0) {
+        return GambleResult::Push;
+    }
+    if ((difference > 0) == high) {
+        win *= 2;
+        return GambleResult::Won;
+    }
+    win = 0;
+    phase = GamePhase::Betting;
+    return GambleResult::Lost;
+}
+
+GameSnapshot PokerGame::snapshot() const {
+    // Zeroed first so the padding is the same in every copy
+    GameSnapshot snapshot = {};
+    snapshot.rngCounter = rng.getCounter();
+    snapshot.credits = credits;
+    snapshot.win = win;
+    snapshot.bet = static_cast<std::uint16_t>(currentBet);
+    snapshot.phase = static_cast<std::uint8_t>(phase);
+    snapshot.handDealt = handDealt ? 1 : 0;
+    snapshot.heldMask = static_cast<std::uint8_t>(heldMask);
+    snapshot.prize = static_cast<std::uint8_t>(prize);
+    snapshot.gambleCard = gambleCard;
+    snapshot.handCount = static_cast<std::uint8_t>(handCount);
+    snapshot.deckDealt = static_cast<std::uint8_t>(deck.getDealt());
+    snapshot.hand = hand;
+    snapshot.deck = deck.getOrder();
+    return snapshot;
+}
+
+bool PokerGame::restore(const GameSnapshot& snapshot) {
+    const int deckSize = variant->rules.deckSize;
+    bool valid = snapshot.phase <= static_cast<std::uint8_t>(GamePhase::Gambling) &&
+                 snapshot.prize < NumPrizes &&
+                 snapshot.heldMask < 32 &&
+                 isHandCount(snapshot.handCount) &&
+                 snapshot.bet <= MaxBet &&
+                 snapshot.gambleCard < deckSize;
+    for (Card card : snapshot.hand) {
+        valid = valid && card < deckSize;
+    }
+    Deck restored(deckSize);
+    if (!valid || !restored.restore(snapshot.deck, snapshot.deckDealt)) {
+        return false;
+    }
+
+    rng.setCounter(snapshot.rngCounter);
+    deck = restored;
+    hand = snapshot.hand;
+    handDealt = snapshot.handDealt != 0;
+    heldMask = snapshot.heldMask;
+    phase = static_cast<GamePhase>(snapshot.phase);
+    credits = snapshot.credits;
+    currentBet = snapshot.bet;
+    win = snapshot.win;
+    prize = static_cast<Prize>(snapshot.prize);
+    gambleCard = snapshot.gambleCard;
+    handCount = snapshot.handCount;
+    hands.clear();
+    return true;
+}
+
+} // namespace SoftyPoker
@@ -0,0 +1,42 @@
+#include "PrizeTable.h"
+#include "VariantEvaluator.h"
+
+namespace SoftyPoker {
+
+namespace {
+
+const char* const prizeNames[NumPrizes] = {
+    "",
+    "jacks or better",
+    "two pair",
+    "three of a kind",
+    "straight",
+    "flush",
+    "full house",
+    "four of a kind",
+    "straight flush",
+    "royal flush",
+    "kings or better",
+    "five of a kind",
+    "wild royal flush",
+    "four deuces"
+};
+
+} // namespace
+
+int Paytable::payout(Prize prize, int bet) const {
+    if (prize == Prize::RoyalFlush && bet == MaxBet) {
+        return maxBetRoyalFlush;
+    }
+    return multiplier[static_cast<int>(prize)] * bet;
+}
+
+const Paytable& PrizeTable::standard() {
+    return JacksOrBetterRules.paytable;
+}
+
+const char* PrizeTable::name(Prize prize) {
+    return prizeNames[static_cast<int>(prize)];
+}
+
+} // namespace SoftyPoker
@@ -0,0 +1,171 @@
+#include "Profiler.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace SoftyPoker {
+
+namespace {
+
+struct ThreadRing {
+    std::uint32_t threadId;
+    std::unique_ptr<ProfileEvent[]> events;
+    std::atomic<std::uint64_t> written;
+};
+
+// A finished thread hands its ring back to the free list, and the next new
+// thread takes it over, so there are only as many rings as threads ever ran
+// at once. Until then the finished thread's events can still be exported.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    std::vector<ThreadRing*> freeRings;
+    std::uint32_t nextThreadId = 1;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+std::atomic<bool> enabled(true);
+std::atomic<unsigned> pendingDrawCalls(0);
+std::atomic<std::int64_t> textureBytes(0);
+std::atomic<std::int64_t> inputLatency(0);
+FrameStats frameStats = {};
+
+thread_local ThreadRing* currentRing = nullptr;
+
+// Gives the thread's ring back when the thread ends
+struct RingReturn {
+    ~RingReturn() {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.freeRings.push_back(currentRing);
+        currentRing = nullptr;
+    }
+};
+
+ThreadRing& threadRing() {
+    if (!currentRing) {
+        Registry& reg = registry();
+        {
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            if (!reg.freeRings.empty()) {
+                currentRing = reg.freeRings.back();
+                reg.freeRings.pop_back();
+            } else {
+                auto ring = std::make_unique<ThreadRing>();
+                ring->events = std::make_unique<ProfileEvent[]>(Profiler::RingSize);
+                currentRing = ring.get();
+                reg.rings.push_back(std::move(ring));
+            }
+            currentRing->threadId = reg.nextThreadId++;
+            currentRing->written.store(0, std::memory_order_relaxed);
+        }
+        thread_local RingReturn ringReturn;
+    }
+    return *currentRing;
+}
+
+void writeJsonString(std::ofstream& out, const char* text) {
+    out << '"';
+    for (; *text; ++text) {
+        if (*text == '"' || *text == '\\') {
+            out << '\\';
+        }
+        out << *text;
+    }
+    out << '"';
+}
+
+}
+
+void Profiler::setEnabled(bool on) {
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+std::int64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::record(const char* name, std::int64_t start, std::int64_t end) {
+    ThreadRing& ring = threadRing();
+    std::uint64_t index = ring.written.load(std::memory_order_relaxed);
+    ring.events[index % RingSize] = ProfileEvent{ name, start, end - start };
+    ring.written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::countDrawCalls(unsigned count) {
+    pendingDrawCalls.fetch_add(count, std::memory_order_relaxed);
+}
+
+void Profiler::trackTextureMemory(std::int64_t bytes) {
+    textureBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Profiler::recordInputLatency(std::int64_t inputTime) {
+    std::int64_t now = Profiler::now();
+    inputLatency.store(now - inputTime, std::memory_order_relaxed);
+    if (isEnabled()) {
+        record("Input", inputTime, now);
+    }
+}
+
+void Profiler::endFrame(sf::Time frameTime) {
+    frameStats.frameMs[frameStats.next] = frameTime.asSeconds() * 1000.0f;
+    frameStats.next = (frameStats.next + 1) % FrameStats::History;
+    if (frameStats.count < FrameStats::History) {
+        ++frameStats.count;
+    }
+    frameStats.drawCalls = pendingDrawCalls.exchange(0, std::memory_order_relaxed);
+    frameStats.textureBytes = textureBytes.load(std::memory_order_relaxed);
+    frameStats.inputLatencyMs = inputLatency.load(std::memory_order_relaxed) / 1000000.0f;
+}
+
+const FrameStats& Profiler::getFrameStats() {
+    return frameStats;
+}
+
+bool Profiler::exportChromeTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& ring : reg.rings) {
+        // A thread may still be writing; only what it had published is read,
+        // and the oldest of those can be overwritten meanwhile, which a
+        // diagnostic dump can live with.
+        std::uint64_t written = ring->written.load(std::memory_order_acquire);
+        std::uint64_t begin = written > RingSize ? written - RingSize : 0;
+        for (std::uint64_t i = begin; i < written; ++i) {
+            const ProfileEvent& event = ring->events[i % RingSize];
+            out << (first ? "" : ",\n") << "{\"name\":";
+            writeJsonString(out, event.name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->threadId
+                << ",\"ts\":" << event.start / 1000.0
+                << ",\"dur\":" << event.duration / 1000.0 << "}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace SoftyPoker
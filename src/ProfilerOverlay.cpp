@@ -0,0 +1,140 @@
+#include "ProfilerOverlay.h"
+#include "Profiler.h"
+#include "ResourceCache.h"
+#include "Log.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace SoftyPoker {
+
+namespace {
+
+const char* TracePath = "softypoker-trace.json";
+
+// Graph scale: a bar reaching the top is 50 ms; the marker line is 60 fps.
+constexpr float GraphMaxMs = 50.0f;
+constexpr float BudgetMs = 1000.0f / 60.0f;
+
+}
+
+ProfilerOverlay::ProfilerOverlay()
+    : visible(false),
+      graph(sf::Triangles) {
+    panel.setFillColor(sf::Color(0, 0, 0, 170));
+    text.setCharacterSize(14);
+    text.setFillColor(sf::Color::White);
+}
+
+bool ProfilerOverlay::handleEvent(const sf::Event& event) {
+    if (event.type != sf::Event::KeyPressed) {
+        return false;
+    }
+    if (event.key.code == sf::Keyboard::F3) {
+        visible = !visible;
+        if (visible && !font) {
+            // Loaded on first use so the overlay costs nothing until it is needed
+            font = resourceCache().font("fonts/arial.ttf");
+            if (font) {
+                text.setFont(*font);
+            }
+        }
+        return true;
+    }
+    if (event.key.code == sf::Keyboard::F4) {
+        if (Profiler::exportChromeTrace(TracePath)) {
+            LOG_DEBUG("Wrote profile trace: {}", TracePath);
+        } else {
+            LOG_ERROR("Could not write profile trace: {}", TracePath);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool ProfilerOverlay::isVisible() const {
+    return visible;
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& window) {
+    if (!visible) {
+        return;
+    }
+    const FrameStats& stats = Profiler::getFrameStats();
+    const float barWidth = 2.0f;
+    const float graphHeight = 80.0f;
+    const float left = 10.0f;
+    const float top = 10.0f;
+    const float width = FrameStats::History * barWidth;
+
+    // Oldest frame on the left
+    graph.clear();
+    std::vector<float> sorted;
+    sorted.reserve(stats.count);
+    for (std::size_t i = 0; i < stats.count; ++i) {
+        std::size_t index = (stats.next + FrameStats::History - stats.count + i) % FrameStats::History;
+        float ms = stats.frameMs[index];
+        sorted.push_back(ms);
+
+        float height = std::min(ms / GraphMaxMs, 1.0f) * graphHeight;
+        float x = left + i * barWidth;
+        float bottom = top + graphHeight;
+        sf::Color color = ms > BudgetMs * 2 ? sf::Color(230, 70, 70) : ms > BudgetMs * 1.1f ? sf::Color(230, 200, 70) : sf::Color(144, 238, 144);
+        sf::Vector2f a(x, bottom - height), b(x + barWidth, bottom - height), c(x + barWidth, bottom), d(x, bottom);
+        graph.append(sf::Vertex(a, color));
+        graph.append(sf::Vertex(b, color));
+        graph.append(sf::Vertex(c, color));
+        graph.append(sf::Vertex(a, color));
+        graph.append(sf::Vertex(c, color));
+        graph.append(sf::Vertex(d, color));
+    }
+    float budgetY = top + graphHeight - BudgetMs / GraphMaxMs * graphHeight;
+    sf::Color budgetColor(173, 216, 230);
+    graph.append(sf::Vertex(sf::Vector2f(left, budgetY), budgetColor));
+    graph.append(sf::Vertex(sf::Vector2f(left + width, budgetY), budgetColor));
+    graph.append(sf::Vertex(sf::Vector2f(left + width, budgetY + 1.0f), budgetColor));
+    graph.append(sf::Vertex(sf::Vector2f(left, budgetY), budgetColor));
+    graph.append(sf::Vertex(sf::Vector2f(left + width, budgetY + 1.0f), budgetColor));
+    graph.append(sf::Vertex(sf::Vector2f(left, budgetY + 1.0f), budgetColor));
+
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(2);
+    if (!sorted.empty()) {
+        std::sort(sorted.begin(), sorted.end());
+        float sum = 0.0f;
+        for (float ms : sorted) {
+            sum += ms;
+        }
+        float latest = stats.frameMs[(stats.next + FrameStats::History - 1) % FrameStats::History];
+        summary << "frame " << latest
+                << " ms  avg " << sum / sorted.size()
+                << "  p50 " << sorted[sorted.size() / 2]
+                << "  p99 " << sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)] << " ms\n";
+    }
+    const ResourceCacheStats cache = resourceCache().getStats();
+    summary << "draw calls " << stats.drawCalls
+            << "  textures " << stats.textureBytes / (1024.0 * 1024.0) << " MB"
+            << "  input " << stats.inputLatencyMs << " ms\n"
+            << "cache " << cache.bytes / (1024.0 * 1024.0) << " of " << cache.budget / (1024.0 * 1024.0)
+            << " MB (" << cache.heldBytes / (1024.0 * 1024.0) << " held)"
+            << "  hits " << cache.hits << "  misses " << cache.misses << "  evictions " << cache.evictions << "\n"
+            << "F4: save trace to " << TracePath;
+
+    panel.setPosition(left - 5.0f, top - 5.0f);
+    panel.setSize(sf::Vector2f(width + 10.0f, graphHeight + 88.0f));
+    text.setString(summary.str());
+    text.setPosition(left, top + graphHeight + 6.0f);
+
+    // Drawn in window pixels whatever view the state has set
+    sf::View stateView = window.getView();
+    window.setView(sf::View(sf::FloatRect(0.0f, 0.0f, window.getSize().x, window.getSize().y)));
+    window.draw(panel);
+    window.draw(graph);
+    if (font) {
+        window.draw(text);
+    }
+    window.setView(stateView);
+}
+
+} // namespace SoftyPoker
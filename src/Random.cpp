@@ -0,0 +1,17 @@
+#include "Random.h"
+#include <random>
+
+namespace SoftyPoker {
+
+std::uint64_t randomSeed() {
+    std::random_device device;
+    std::uint64_t high = device();
+    return high << 32 | device();
+}
+
+CounterRng& sharedRng() {
+    thread_local CounterRng rng(randomSeed());
+    return rng;
+}
+
+} // namespace SoftyPoker
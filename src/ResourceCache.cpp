@@ -0,0 +1,257 @@
+#include "ResourceCache.h"
+#include "AssetPack.h"
+#include "Profiler.h"
+#include "Utility.h"
+#include "Log.h"
+#include <filesystem>
+
+namespace SoftyPoker {
+
+namespace {
+
+// What a font costs to keep: SFML holds on to the whole file
+std::size_t assetSize(const std::string& name) {
+    AssetView view;
+    if (assetPack().read(name, view)) {
+        return view.size;
+    }
+    std::error_code error;
+    std::uintmax_t size = std::filesystem::file_size(getAssetPath(name), error);
+    return error ? 0 : static_cast<std::size_t>(size);
+}
+
+}
+
+ResourceCache::ResourceCache(std::size_t budget)
+    : budget(budget),
+      totalBytes(0),
+      useCounter(0),
+      hits(0),
+      misses(0),
+      evictions(0) {
+}
+
+std::shared_ptr<void> ResourceCache::acquireErased(const std::string& key, const Loader<void>& load) {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        auto found = entries.find(key);
+        if (found == entries.end()) {
+            break;
+        }
+        if (!found->second.loading) {
+            ++hits;
+            found->second.lastUse = ++useCounter;
+            return found->second.resource;
+        }
+        // Someone else is loading it; if that fails the entry goes and we try ourselves
+        loaded.wait(lock);
+    }
+    entries[key].loading = true;
+    ++misses;
+    lock.unlock();
+
+    std::size_t bytes = 0;
+    std::shared_ptr<void> resource;
+    try {
+        resource = load(bytes);
+    } catch (...) {
+        lock.lock();
+        entries.erase(key);
+        loaded.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    if (!resource) {
+        entries.erase(key);
+        loaded.notify_all();
+        return nullptr;
+    }
+    Entry& entry = entries[key];
+    entry.resource = resource;
+    entry.bytes = bytes;
+    entry.lastUse = ++useCounter;
+    entry.loading = false;
+    totalBytes += bytes;
+    loaded.notify_all();
+    trimLocked();
+    return resource;
+}
+
+std::shared_ptr<void> ResourceCache::findErased(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(key);
+    if (found == entries.end() || found->second.loading) {
+        return nullptr;
+    }
+    ++hits;
+    found->second.lastUse = ++useCounter;
+    return found->second.resource;
+}
+
+std::shared_ptr<void> ResourceCache::insertErased(const std::string& key, std::shared_ptr<void> resource, std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(key);
+    if (found != entries.end()) {
+        if (found->second.loading) {
+            // A loader of its own is making it; that one gets cached
+            ++misses;
+            return resource;
+        }
+        // Someone else cached it first, and this caller gets theirs
+        ++hits;
+        found->second.lastUse = ++useCounter;
+        return found->second.resource;
+    }
+    ++misses;
+    Entry& entry = entries[key];
+    entry.resource = resource;
+    entry.bytes = bytes;
+    entry.lastUse = ++useCounter;
+    totalBytes += bytes;
+    trimLocked();
+    return resource;
+}
+
+std::shared_ptr<sf::Font> ResourceCache::font(const std::string& name) {
+    return acquire<sf::Font>("font:" + name, [&name](std::size_t& bytes) {
+        auto font = std::make_shared<sf::Font>();
+        if (!loadAsset(*font, name)) {
+            return std::shared_ptr<sf::Font>();
+        }
+        bytes = assetSize(name);
+        return font;
+    });
+}
+
+std::shared_ptr<sf::SoundBuffer> ResourceCache::soundBuffer(const std::string& name) {
+    return acquire<sf::SoundBuffer>("sound:" + name, [&name](std::size_t& bytes) {
+        auto buffer = std::make_shared<sf::SoundBuffer>();
+        if (!loadAsset(*buffer, name)) {
+            return std::shared_ptr<sf::SoundBuffer>();
+        }
+        bytes = static_cast<std::size_t>(buffer->getSampleCount()) * sizeof(sf::Int16);
+        return buffer;
+    });
+}
+
+std::shared_ptr<const std::vector<std::uint8_t>> ResourceCache::encoded(const std::string& name) {
+    return acquire<std::vector<std::uint8_t>>("encoded:" + name, [&name](std::size_t& bytes) {
+        auto data = std::make_shared<std::vector<std::uint8_t>>();
+        if (!readAssetBytes(name, *data)) {
+            return std::shared_ptr<std::vector<std::uint8_t>>();
+        }
+        bytes = data->size();
+        return data;
+    });
+}
+
+std::string ResourceCache::textureKey(const std::string& name, bool smooth, sf::Vector2u fitTo) {
+    std::string key = "texture:" + name;
+    if (fitTo.x > 0 && fitTo.y > 0) {
+        key += "@" + std::to_string(fitTo.x) + "x" + std::to_string(fitTo.y);
+    }
+    return smooth ? key : key + ":sharp";
+}
+
+void ResourceCache::setBudget(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budget = bytes;
+    trimLocked();
+}
+
+void ResourceCache::trim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    trimLocked();
+}
+
+void ResourceCache::trimLocked() {
+    // A linear scan per eviction: there are a few dozen entries at most
+    while (totalBytes > budget) {
+        auto victim = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            // Only our own reference left: nobody holds it
+            bool held = it->second.loading || it->second.resource.use_count() > 1;
+            if (!held && (victim == entries.end() || it->second.lastUse < victim->second.lastUse)) {
+                victim = it;
+            }
+        }
+        if (victim == entries.end()) {
+            return;
+        }
+        LOG_DEBUG("Resource cache evicting {} ({} KB)", victim->first, victim->second.bytes / 1024);
+        totalBytes -= victim->second.bytes;
+        ++evictions;
+        entries.erase(victim);
+    }
+}
+
+void ResourceCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.loading) {
+            ++it;
+            continue;
+        }
+        totalBytes -= it->second.bytes;
+        it = entries.erase(it);
+    }
+}
+
+void ResourceCache::evict(const std::string& prefix) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end();) {
+        bool held = it->second.loading || it->second.resource.use_count() > 1;
+        if (held || it->first.compare(0, prefix.size(), prefix) != 0) {
+            ++it;
+            continue;
+        }
+        LOG_DEBUG("Resource cache evicting {} ({} KB)", it->first, it->second.bytes / 1024);
+        totalBytes -= it->second.bytes;
+        ++evictions;
+        it = entries.erase(it);
+    }
+}
+
+ResourceCacheStats ResourceCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    ResourceCacheStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    stats.entries = entries.size();
+    stats.bytes = totalBytes;
+    stats.budget = budget;
+    for (const auto& entry : entries) {
+        if (entry.second.resource.use_count() > 1) {
+            stats.heldBytes += entry.second.bytes;
+        }
+    }
+    return stats;
+}
+
+ResourceCache& resourceCache() {
+    static ResourceCache cache;
+    return cache;
+}
+
+CacheEviction::CacheEviction(std::vector<std::string> prefixes) : prefixes(std::move(prefixes)) {}
+
+CacheEviction::~CacheEviction() {
+    for (const std::string& prefix : prefixes) {
+        resourceCache().evict(prefix);
+    }
+}
+
+std::shared_ptr<sf::Texture> makeTrackedTexture(long long bytes) {
+    // The deleter keeps the profiler's texture memory total honest however
+    // long states and the cache hold on to the texture.
+    std::shared_ptr<sf::Texture> texture(new sf::Texture, [bytes](sf::Texture* texture) {
+        Profiler::trackTextureMemory(-bytes);
+        delete texture;
+    });
+    Profiler::trackTextureMemory(bytes);
+    return texture;
+}
+
+} // namespace SoftyPoker
@@ -0,0 +1,230 @@
+#include "Session.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace SoftyPoker {
+
+namespace {
+
+constexpr char Magic[4] = { 'S', 'P', 'S', 'N' };
+constexpr std::uint32_t Version = 2;
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t seed;
+    std::int32_t startingCredits;
+    std::uint32_t eventCount;
+    std::uint32_t ticks;
+    std::int32_t finalCredits;
+    std::uint64_t digest;
+    std::uint32_t variant;
+    std::uint32_t hands;
+};
+
+static_assert(sizeof(FileHeader) == 48, "session header layout changed");
+
+// FNV-1a, one value at a time
+std::uint64_t fold(std::uint64_t digest, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        digest ^= (value >> (i * 8)) & 0xFF;
+        digest *= 0x100000001B3ull;
+    }
+    return digest;
+}
+
+void writeVarint(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+bool readVarint(const std::uint8_t*& data, const std::uint8_t* end, std::uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35 && data < end; shift += 7) {
+        std::uint8_t byte = *data++;
+        value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+bool applyCommand(PokerGame& game, Command command, GambleResult& gambleResult) {
+    switch (command) {
+    case Command::Bet:
+        return game.bet();
+    case Command::Deal:
+        return game.deal();
+    case Command::Collect:
+        return game.collect();
+    case Command::Double:
+        return game.enterGamble();
+    case Command::Low:
+    case Command::High:
+        // guess() treats a guess outside the double-up as lost
+        if (game.getPhase() != GamePhase::Gambling) {
+            return false;
+        }
+        gambleResult = game.guess(command == Command::High);
+        return true;
+    case Command::Hold1:
+    case Command::Hold2:
+    case Command::Hold3:
+    case Command::Hold4:
+    case Command::Hold5:
+        return game.toggleHold(static_cast<int>(command) - static_cast<int>(Command::Hold1));
+    case Command::None:
+    case Command::Start:
+        break;
+    }
+    return false;
+}
+
+std::uint64_t stateDigest(std::uint64_t digest, const PokerGame& game) {
+    digest = fold(digest, static_cast<std::uint64_t>(game.getPhase()));
+    digest = fold(digest, static_cast<std::uint64_t>(game.getCredits()));
+    digest = fold(digest, static_cast<std::uint64_t>(game.getBet()));
+    digest = fold(digest, static_cast<std::uint64_t>(game.getWin()));
+    digest = fold(digest, static_cast<std::uint64_t>(game.getPrize()));
+    digest = fold(digest, static_cast<std::uint64_t>(game.getHeldMask()));
+    digest = fold(digest, game.hasHand() ? handMask(game.getHand().data(), 5) : 0);
+    // Then every other hand of a multi-hand round once it has been drawn
+    const MultiHand& hands = game.getHands();
+    if (hands.isDrawn()) {
+        for (int hand = 1; hand < hands.getCount(); ++hand) {
+            Card cards[5] = { hands.getCard(hand, 0), hands.getCard(hand, 1), hands.getCard(hand, 2),
+                              hands.getCard(hand, 3), hands.getCard(hand, 4) };
+            digest = fold(digest, handMask(cards, 5));
+        }
+    }
+    return fold(digest, game.getGambleCard());
+}
+
+SessionRecorder::SessionRecorder(std::uint64_t seed, int startingCredits, VariantId variant, int hands) {
+    log.seed = seed;
+    log.startingCredits = startingCredits;
+    log.variant = variant;
+    log.hands = hands;
+    log.finalCredits = startingCredits;
+    log.digest = SessionDigestSeed;
+}
+
+SessionRecorder::SessionRecorder(const SessionLog& log) : log(log) {}
+
+void SessionRecorder::record(std::uint32_t tick, Command command, const PokerGame& game) {
+    log.events.push_back(SessionEvent{ tick, command });
+    log.digest = stateDigest(log.digest, game);
+    log.ticks = tick;
+    log.finalCredits = game.getCredits();
+}
+
+void SessionRecorder::finish(std::uint32_t ticks, const PokerGame& game) {
+    log.ticks = ticks;
+    log.finalCredits = game.getCredits();
+}
+
+const SessionLog& SessionRecorder::getLog() const {
+    return log;
+}
+
+ReplayResult replaySession(const SessionLog& log) {
+    PokerGame game(CounterRng(log.seed), log.startingCredits, GameVariant::get(log.variant));
+    game.setHandCount(log.hands);
+    std::uint64_t digest = SessionDigestSeed;
+    GambleResult gambleResult = GambleResult::Push;
+    for (const SessionEvent& event : log.events) {
+        // Only commands that changed the game are recorded, so one that
+        // does nothing here means the rules have changed under the log
+        if (!applyCommand(game, event.command, gambleResult)) {
+            return ReplayResult{ false, digest, game.getCredits() };
+        }
+        digest = stateDigest(digest, game);
+    }
+    bool matches = digest == log.digest && game.getCredits() == log.finalCredits;
+    return ReplayResult{ matches, digest, game.getCredits() };
+}
+
+bool saveSession(const SessionLog& log, const std::string& path) {
+    FileHeader header = {};
+    std::memcpy(header.magic, Magic, sizeof(header.magic));
+    header.version = Version;
+    header.seed = log.seed;
+    header.startingCredits = log.startingCredits;
+    header.eventCount = static_cast<std::uint32_t>(log.events.size());
+    header.ticks = log.ticks;
+    header.finalCredits = log.finalCredits;
+    header.digest = log.digest;
+    header.variant = static_cast<std::uint32_t>(log.variant);
+    header.hands = static_cast<std::uint32_t>(log.hands);
+
+    std::vector<std::uint8_t> body;
+    body.reserve(log.events.size() * 3);
+    std::uint32_t lastTick = 0;
+    for (const SessionEvent& event : log.events) {
+        writeVarint(body, event.tick - lastTick);
+        body.push_back(static_cast<std::uint8_t>(event.command));
+        lastTick = event.tick;
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(body.data()), body.size());
+    return static_cast<bool>(out);
+}
+
+bool loadSession(const std::string& path, SessionLog& log) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    FileHeader header = {};
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version) {
+        return false;
+    }
+    if (header.variant >= static_cast<std::uint32_t>(NumVariants) || !isHandCount(static_cast<int>(header.hands))) {
+        return false;
+    }
+
+    log.seed = header.seed;
+    log.startingCredits = header.startingCredits;
+    log.variant = static_cast<VariantId>(header.variant);
+    log.hands = static_cast<int>(header.hands);
+    log.ticks = header.ticks;
+    log.finalCredits = header.finalCredits;
+    log.digest = header.digest;
+    log.events.clear();
+
+    const std::uint8_t* cursor = data.data() + sizeof(header);
+    const std::uint8_t* end = data.data() + data.size();
+    // Every event takes at least two bytes, a tick delta and a command, so a
+    // count the file cannot hold is corrupt and is not trusted with a reserve
+    if (header.eventCount > static_cast<std::size_t>(end - cursor) / 2) {
+        return false;
+    }
+    log.events.reserve(header.eventCount);
+    std::uint32_t tick = 0;
+    for (std::uint32_t i = 0; i < header.eventCount; ++i) {
+        std::uint32_t delta;
+        if (!readVarint(cursor, end, delta) || cursor >= end || *cursor >= NumCommands) {
+            return false;
+        }
+        tick += delta;
+        log.events.push_back(SessionEvent{ tick, static_cast<Command>(*cursor++) });
+    }
+    return cursor == end;
+}
+
+} // namespace SoftyPoker
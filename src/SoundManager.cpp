@@ -1,11 +1,46 @@
 #include "SoundManager.h"
-#include "Utility.h"
+#include "AssetPack.h"
+#include "Random.h"
+#include "Profiler.h"
+#include "ResourceCache.h"
+#include "Log.h"
 #include <SFML/Audio.hpp>
-#include <iostream>
-#include <random>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+const sf::Time CrossfadeTime = sf::seconds(4.0f);
+
+struct SoundInfo {
+    const char* asset;
+    int priority;     // higher steals lower when every voice is busy
+    int maxVoices;    // beyond this the oldest instance is restarted instead
+};
+
+// Indexed by SoundId
+constexpr SoundInfo soundInfo[NumSoundIds] = {
+    { "sounds/bet.wav",    1, 2 },
+    { "sounds/bet2.wav",   1, 2 },
+    { "sounds/deal.wav",   2, 5 },
+    { "sounds/held.wav",   2, 2 },
+    { "sounds/unheld.wav", 2, 2 },
+    { "sounds/count.wav",  0, 2 },
+    { "sounds/prize.wav",  3, 1 },
+    { "sounds/win.wav",    3, 1 },
+    { "sounds/lose.wav",   3, 1 }
+};
 
-SoundManager::SoundManager() {
-    // Initialization here
+}
+
+SoundManager::SoundManager()
+    : currentTrack(0),
+      nextTrack(0),
+      fadeElapsed(sf::Time::Zero),
+      musicVolume(100.0f),
+      musicStarted(false),
+      voiceCounter(0),
+      soundsLoaded(false) {
 }
 
 SoundManager::~SoundManager() {
@@ -13,80 +48,211 @@ SoundManager::~SoundManager() {
 }
 
 void SoundManager::initializeMusic() {
-    // Check if music tracks are already initialized
-    if (!musicTracks.empty()) {
-        std::cout << "[Debug] Music already initialized" << std::endl;
+    // Check if music is already initialized
+    if (!musicCatalog.empty()) {
+        LOG_DEBUG("Music already initialized");
         return;
     }
 
-    std::cout << "[Debug] Initializing music" << std::endl;
-    auto music1 = std::make_unique<sf::Music>();
-    auto music2 = std::make_unique<sf::Music>();
-    auto music3 = std::make_unique<sf::Music>();
-    auto music4 = std::make_unique<sf::Music>();
-    auto music5 = std::make_unique<sf::Music>();
-    auto music6 = std::make_unique<sf::Music>(); // New music added
+    LOG_DEBUG("Initializing music");
+    musicCatalog = SoftyPoker::listAssets("music/");
+    if (musicCatalog.empty()) {
+        LOG_ERROR("No music tracks available");
+        return;
+    }
 
-    try {
-        if (!music1->openFromFile(getAssetPath("music/music1.ogg"))) {
-            throw std::runtime_error("Failed to load music 1");
-        }
-        if (!music2->openFromFile(getAssetPath("music/music2.ogg"))) {
-            throw std::runtime_error("Failed to load music 2");
-        }
-        if (!music3->openFromFile(getAssetPath("music/music3.ogg"))) {
-            throw std::runtime_error("Failed to load music 3");
-        }
-        if (!music4->openFromFile(getAssetPath("music/music4.ogg"))) {
-            throw std::runtime_error("Failed to load music 4");
+    currentTrack = SoftyPoker::sharedRng().uniform(musicCatalog.size());
+    currentMusic = openTrack(currentTrack);
+    LOG_DEBUG("Finished initializing music ({} tracks)", musicCatalog.size());
+}
+
+void SoundManager::playRandomBackgroundMusic() {
+    LOG_DEBUG("Attempting to play random background music");
+    if (musicCatalog.empty()) {
+        LOG_ERROR("No music tracks available");
+        return;
+    }
+
+    // initializeMusic() has usually opened a random track already.
+    if (!currentMusic || currentMusic->getStatus() != sf::SoundSource::Stopped) {
+        currentTrack = SoftyPoker::sharedRng().uniform(musicCatalog.size());
+        currentMusic = openTrack(currentTrack);
+    }
+    fadingMusic.reset();
+
+    if (currentMusic) {
+        LOG_DEBUG("Selected track: {}", musicCatalog[currentTrack]);
+        // With a single track there is nothing to fade into, so just loop it.
+        currentMusic->setLoop(musicCatalog.size() == 1);
+        currentMusic->setVolume(musicVolume);
+        currentMusic->play();
+        musicStarted = true;
+        prefetchNextTrack();
+        LOG_DEBUG("Playing random background music");
+    } else {
+        LOG_ERROR("currentMusic is null");
+    }
+}
+
+void SoundManager::updateMusic(sf::Time elapsed) {
+    PROFILE_SCOPE("SoundManager::updateMusic");
+    // initializeMusic() may still be running on a loader thread until the
+    // first track is started, so nothing here is touched before that.
+    if (!musicStarted || !currentMusic) {
+        return;
+    }
+
+    if (fadingMusic) {
+        fadeElapsed += elapsed;
+        float progress = std::min(1.0f, fadeElapsed / CrossfadeTime);
+        currentMusic->setVolume(musicVolume * progress);
+        fadingMusic->setVolume(musicVolume * (1.0f - progress));
+        if (progress >= 1.0f) {
+            fadingMusic.reset();
+            prefetchNextTrack();
         }
-        if (!music5->openFromFile(getAssetPath("music/music5.ogg"))) {
-            throw std::runtime_error("Failed to load music 5");
+        return;
+    }
+
+    if (!nextMusic.valid() || nextMusic.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    sf::Time remaining = currentMusic->getDuration() - currentMusic->getPlayingOffset();
+    if (currentMusic->getStatus() == sf::SoundSource::Stopped || remaining <= CrossfadeTime) {
+        startNextTrack();
+    }
+}
+
+void SoundManager::setMusicPaused(bool paused) {
+    if (!musicStarted) {
+        return;
+    }
+    for (sf::Music* music : { currentMusic.get(), fadingMusic.get() }) {
+        if (!music) {
+            continue;
         }
-        if (!music6->openFromFile(getAssetPath("music/music6.ogg"))) {
-            throw std::runtime_error("Failed to load music 6");
+        if (paused && music->getStatus() == sf::SoundSource::Playing) {
+            music->pause();
+        } else if (!paused && music->getStatus() == sf::SoundSource::Paused) {
+            music->play();
         }
+    }
+}
 
-        musicTracks.push_back(std::move(music1));
-        musicTracks.push_back(std::move(music2));
-        musicTracks.push_back(std::move(music3));
-        musicTracks.push_back(std::move(music4));
-        musicTracks.push_back(std::move(music5));
-        musicTracks.push_back(std::move(music6));
+void SoundManager::stopMusic() {
+    musicStarted = false;
+    currentMusic.reset();
+    fadingMusic.reset();
+    if (nextMusic.valid()) {
+        nextMusic.get();
+    }
+}
+
+std::unique_ptr<sf::Music> SoundManager::openTrack(std::size_t index) const {
+    PROFILE_SCOPE("SoundManager::openTrack");
+    auto music = std::make_unique<sf::Music>();
+    if (!SoftyPoker::openAsset(*music, musicCatalog[index])) {
+        LOG_ERROR("Failed to load music: {}", musicCatalog[index]);
+        return nullptr;
+    }
+    return music;
+}
+
+std::size_t SoundManager::pickNextTrack() const {
+    // Any track but the one playing now.
+    std::size_t offset = 1 + SoftyPoker::sharedRng().uniform(musicCatalog.size() - 1);
+    return (currentTrack + offset) % musicCatalog.size();
+}
+
+void SoundManager::prefetchNextTrack() {
+    if (musicCatalog.size() < 2) {
+        return;
+    }
+    // Opening a stream reads the file header and sets up the decoder, which is
+    // worth keeping off the frame; the stream itself only buffers once played.
+    nextTrack = pickNextTrack();
+    nextMusic = std::async(std::launch::async, [this, index = nextTrack]() { return openTrack(index); });
+}
+
+void SoundManager::startNextTrack() {
+    std::unique_ptr<sf::Music> next = nextMusic.get();
+    if (!next) {
+        prefetchNextTrack();
+        return;
+    }
+    LOG_DEBUG("Crossfading to: {}", musicCatalog[nextTrack]);
+    fadingMusic = std::move(currentMusic);
+    currentMusic = std::move(next);
+    currentTrack = nextTrack;
+    fadeElapsed = sf::Time::Zero;
+    currentMusic->setVolume(0.0f);
+    currentMusic->play();
+}
 
-        for (const auto& music : musicTracks) {
-            music->setVolume(100.0f); // Set volume for each music track
+void SoundManager::initializeGameSounds() {
+    PROFILE_SCOPE("SoundManager::initializeGameSounds");
+    if (soundsLoaded) {
+        return;
+    }
+    for (std::size_t i = 0; i < NumSoundIds; ++i) {
+        soundBuffers[i] = SoftyPoker::resourceCache().soundBuffer(soundInfo[i].asset);
+        if (!soundBuffers[i]) {
+            LOG_ERROR("Failed to load sound: {}", soundInfo[i].asset);
         }
-        std::cout << "[Debug] Finished initializing music" << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "[Error] " << e.what() << std::endl;
-        throw; // Rethrow the exception
     }
+    soundsLoaded = true;
+    LOG_DEBUG("Finished initializing game sounds");
 }
 
-void SoundManager::playRandomBackgroundMusic() {
-    std::cout << "[Debug] Attempting to play random background music" << std::endl;
-    if (!musicTracks.empty()) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> distr(0, static_cast<int>(musicTracks.size() - 1)); // Ensure the range is correct
-
-        size_t trackIndex = distr(gen);
-        currentMusic = musicTracks[trackIndex].get();
-
-        // Debug output for selected track
-        std::cout << "[Debug] Selected track index: " << trackIndex << std::endl;
-        std::cout << "[Debug] Music track at index: " << musicTracks[trackIndex].get() << std::endl;
-
-        if (currentMusic) {
-            currentMusic->stop(); // Ensure any previously playing music is stopped
-            currentMusic->setLoop(true);
-            currentMusic->play();
-            std::cout << "[Debug] Playing random background music" << std::endl;
-        } else {
-            std::cerr << "[Error] currentMusic is null" << std::endl;
+void SoundManager::playSound(SoundId id) {
+    PROFILE_SCOPE("SoundManager::playSound");
+    if (!soundsLoaded) {
+        return;
+    }
+    const std::size_t index = static_cast<std::size_t>(id);
+    const SoundInfo& info = soundInfo[index];
+    if (!soundBuffers[index]) {
+        return;
+    }
+
+    Voice* freeVoice = nullptr;
+    Voice* oldestSame = nullptr;
+    Voice* victim = nullptr;
+    int sameCount = 0;
+    for (Voice& voice : voices) {
+        if (voice.sound.getStatus() != sf::Sound::Playing) {
+            if (!freeVoice) {
+                freeVoice = &voice;
+            }
+            continue;
+        }
+        if (voice.id == id) {
+            ++sameCount;
+            if (!oldestSame || voice.startOrder < oldestSame->startOrder) {
+                oldestSame = &voice;
+            }
+        }
+        if (!victim || voice.priority < victim->priority ||
+            (voice.priority == victim->priority && voice.startOrder < victim->startOrder)) {
+            victim = &voice;
         }
-    } else {
-        std::cerr << "[Error] No music tracks available" << std::endl;
     }
+
+    Voice* chosen = freeVoice;
+    if (sameCount >= info.maxVoices) {
+        // Rapid repeats (count ticks) retrigger rather than pile up.
+        chosen = oldestSame;
+    } else if (!chosen) {
+        if (victim->priority > info.priority) {
+            return;
+        }
+        chosen = victim;
+    }
+
+    chosen->sound.stop();
+    chosen->sound.setBuffer(*soundBuffers[index]);
+    chosen->id = id;
+    chosen->priority = info.priority;
+    chosen->startOrder = ++voiceCounter;
+    chosen->sound.play();
 }
@@ -0,0 +1,61 @@
+#include "SpriteBatch.h"
+#include "Profiler.h"
+
+SpriteBatch::SpriteBatch(const TextureAtlas& atlas)
+    : atlas(atlas) {}
+
+void SpriteBatch::clear() {
+    for (auto& vertices : pages) {
+        vertices.clear();
+    }
+}
+
+void SpriteBatch::add(int region, sf::Vector2f position, sf::Vector2f size, sf::Color color) {
+    if (region < 0) {
+        return;
+    }
+    const AtlasRegion& source = atlas.getRegion(region);
+    if (pages.size() <= source.page) {
+        pages.resize(source.page + 1, sf::VertexArray(sf::Triangles));
+    }
+
+    float left = static_cast<float>(source.rect.left);
+    float top = static_cast<float>(source.rect.top);
+    float right = left + source.rect.width;
+    float bottom = top + source.rect.height;
+
+    sf::Vertex topLeft(position, color, sf::Vector2f(left, top));
+    sf::Vertex topRight(sf::Vector2f(position.x + size.x, position.y), color, sf::Vector2f(right, top));
+    sf::Vertex bottomLeft(sf::Vector2f(position.x, position.y + size.y), color, sf::Vector2f(left, bottom));
+    sf::Vertex bottomRight(position + size, color, sf::Vector2f(right, bottom));
+
+    sf::VertexArray& vertices = pages[source.page];
+    vertices.append(topLeft);
+    vertices.append(topRight);
+    vertices.append(bottomLeft);
+    vertices.append(bottomLeft);
+    vertices.append(topRight);
+    vertices.append(bottomRight);
+}
+
+void SpriteBatch::addScaled(int region, sf::Vector2f position, float height, sf::Color color) {
+    add(region, position, sf::Vector2f(widthForHeight(region, height), height), color);
+}
+
+float SpriteBatch::widthForHeight(int region, float height) const {
+    if (region < 0) {
+        return 0.0f;
+    }
+    const sf::IntRect& rect = atlas.getRegion(region).rect;
+    return height * rect.width / rect.height;
+}
+
+void SpriteBatch::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    for (unsigned page = 0; page < pages.size(); ++page) {
+        if (pages[page].getVertexCount() > 0) {
+            states.texture = &atlas.getPage(page);
+            target.draw(pages[page], states);
+            SoftyPoker::Profiler::countDrawCalls();
+        }
+    }
+}
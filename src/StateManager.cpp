@@ -1,47 +1,139 @@
 #include "StateManager.h"
-#include <iostream>
+#include "Profiler.h"
+#include <stdexcept>
+#include <string>
 
-namespace SoftyPoker {
-
-StateManager::StateManager() : currentState(nullptr) {}
+StateManager::~StateManager() {
+    // Top first, so no state outlives one pushed on top of it
+    while (!stack.empty()) {
+        stack.pop_back();
+    }
+}
 
-void StateManager::addState(const std::string& stateName, std::unique_ptr<GameState> state) {
-    states[stateName] = std::move(state);
+void StateManager::registerState(StateId id, Factory factory) {
+    factories[static_cast<std::size_t>(id)] = std::move(factory);
 }
 
-void StateManager::switchToState(const std::string& stateName) {
-    if (states.find(stateName) != states.end()) {
-        currentState = states[stateName].get();
-        currentStateName_ = stateName;
-    } else {
-        std::cerr << "State " << stateName << " not found!" << std::endl;
+void StateManager::preload(StateId id) {
+    std::size_t index = static_cast<std::size_t>(id);
+    if (!factories[index]) {
+        throw std::runtime_error("No factory registered for state " + std::to_string(index));
     }
+    if (preloaded[index].valid()) {
+        return;
+    }
+    Factory& factory = factories[index];
+    preloaded[index] = std::async(std::launch::async, [&factory]() {
+        PROFILE_SCOPE("StateManager::preload");
+        // Textures created here are shared with the window's context
+        sf::Context context;
+        return factory();
+    });
+}
+
+void StateManager::push(StateId id) {
+    pending.push_back(PendingChange{ Change::Push, id });
+}
+
+void StateManager::pop() {
+    pending.push_back(PendingChange{ Change::Pop, StateId::Loading });
+}
+
+void StateManager::replace(StateId id) {
+    pending.push_back(PendingChange{ Change::Replace, id });
+}
+
+bool StateManager::isEmpty() const {
+    return stack.empty() && pending.empty();
+}
+
+bool StateManager::takeSwitched() {
+    bool result = switched;
+    switched = false;
+    return result;
 }
 
-void StateManager::update(sf::RenderWindow& window) {
-    if (currentState) {
-        currentState->update(window);
+std::unique_ptr<GameState> StateManager::create(StateId id) {
+    std::size_t index = static_cast<std::size_t>(id);
+    if (preloaded[index].valid()) {
+        PROFILE_SCOPE("StateManager::waitForPreload");
+        // Rethrows whatever the constructor threw on the loader thread
+        return preloaded[index].get();
     }
+    if (!factories[index]) {
+        throw std::runtime_error("No factory registered for state " + std::to_string(index));
+    }
+    PROFILE_SCOPE("StateManager::create");
+    return factories[index]();
 }
 
-void StateManager::draw(sf::RenderWindow& window) {
-    if (currentState) {
-        currentState->draw(window);
+void StateManager::applyPendingChanges() {
+    // A hook may queue further changes, so the list is taken before it runs
+    while (!pending.empty()) {
+        std::vector<PendingChange> changes;
+        changes.swap(pending);
+        for (const PendingChange& change : changes) {
+            switch (change.change) {
+            case Change::Push: {
+                std::unique_ptr<GameState> next = create(change.id);
+                if (!stack.empty()) {
+                    stack.back()->onSuspend();
+                }
+                stack.push_back(std::move(next));
+                stack.back()->onEnter();
+                break;
+            }
+            case Change::Pop:
+                if (stack.empty()) {
+                    break;
+                }
+                stack.back()->onExit();
+                stack.pop_back();
+                if (!stack.empty()) {
+                    stack.back()->onResume();
+                }
+                break;
+            case Change::Replace: {
+                // Build the next state before the old one goes, so a failure leaves the old one running
+                std::unique_ptr<GameState> next = create(change.id);
+                if (!stack.empty()) {
+                    stack.back()->onExit();
+                    stack.pop_back();
+                }
+                stack.push_back(std::move(next));
+                stack.back()->onEnter();
+                break;
+            }
+            }
+            switched = true;
+        }
     }
 }
 
-void StateManager::handleEvent(sf::Event& event, sf::RenderWindow& window) {
-    if (currentState) {
-        currentState->handleEvent(event, window);
+void StateManager::update(sf::RenderTarget& window, sf::Time step) {
+    PROFILE_SCOPE("StateManager::update");
+    applyPendingChanges();
+    if (!stack.empty()) {
+        stack.back()->update(window, step);
     }
+    applyPendingChanges();
 }
 
-std::string StateManager::getCurrentStateName() const {
-    return currentStateName_;
+bool StateManager::needsRedraw() const {
+    return !stack.empty() && stack.back()->needsRedraw();
 }
 
-GameState* StateManager::getCurrentState() const {
-    return currentState;
+void StateManager::draw(sf::RenderTarget& window) {
+    PROFILE_SCOPE("StateManager::draw");
+    if (!stack.empty()) {
+        stack.back()->draw(window);
+    }
 }
 
-} // namespace SoftyPoker
+void StateManager::handleEvent(sf::Event& event, sf::RenderTarget& window) {
+    PROFILE_SCOPE("StateManager::handleEvent");
+    if (!stack.empty()) {
+        stack.back()->handleEvent(event, window);
+    }
+    applyPendingChanges();
+}
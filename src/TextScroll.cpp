@@ -1,16 +1,29 @@
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <cmath>
 #include "TextScroll.h"
 
 TextScroll::TextScroll(const sf::Font& font, const std::string& textStr, float speed, float startY, float windowWidth)
-    : speed(speed), windowWidth(windowWidth), enableColorTransition(false), colorFadeSpeed(1.0f) {
-    text.setFont(font);
-    text.setString(textStr);
-    text.setPosition(windowWidth, startY);
+    : font(&font),
+      string(textStr),
+      characterSize(30),
+      glyphs(sf::Triangles),
+      position(windowWidth, startY),
+      color(sf::Color::White),
+      speed(speed),
+      windowWidth(windowWidth),
+      enableColorTransition(false),
+      colorFadeSpeed(1.0f) {
+    buildGlyphs();
+}
+
+void TextScroll::setString(const std::string& textStr) {
+    string = textStr;
+    buildGlyphs();
 }
 
 void TextScroll::setTextColor(const sf::Color& color) {
-    text.setFillColor(color);
+    applyColor(color);
 }
 
 void TextScroll::enableSmoothColorTransition(bool enable) {
@@ -22,9 +35,9 @@ void TextScroll::setColorFadeSpeed(float speed) {
 }
 
 void TextScroll::update(sf::Time elapsed, sf::Time totalElapsed) {
-    text.move(-speed * elapsed.asSeconds(), 0);
-    if (text.getPosition().x + text.getGlobalBounds().width < 0) {
-        text.setPosition(windowWidth, text.getPosition().y);
+    position.x -= speed * elapsed.asSeconds();
+    if (position.x + bounds.left + bounds.width < 0) {
+        position.x = windowWidth;
     }
 
     if (enableColorTransition) {
@@ -33,35 +46,112 @@ void TextScroll::update(sf::Time elapsed, sf::Time totalElapsed) {
         sf::Uint8 green = static_cast<sf::Uint8>((std::sin(time + 2.0f) * 0.5f + 0.5f) * 255);
         sf::Uint8 blue = static_cast<sf::Uint8>((std::sin(time + 4.0f) * 0.5f + 0.5f) * 255);
 
-        sf::Color fadeColor(red, green, blue);
-        text.setFillColor(fadeColor);
+        // A slow fade only moves a channel every few frames
+        applyColor(sf::Color(red, green, blue));
     }
 }
 
 void TextScroll::setCharacterSize(unsigned int size) {
-    text.setCharacterSize(size);
+    if (size != characterSize) {
+        characterSize = size;
+        buildGlyphs();
+    }
 }
 
 void TextScroll::setPosition(float x, float y) {
-    text.setPosition(x, y);
+    position = sf::Vector2f(x, y);
 }
 
 void TextScroll::setPosition(sf::Vector2f position) {
-    text.setPosition(position);
+    this->position = position;
 }
 
 sf::Vector2f TextScroll::getPosition() const {
-    return text.getPosition();
+    return position;
 }
 
 sf::FloatRect TextScroll::getLocalBounds() const {
-    return text.getLocalBounds();
+    return bounds;
 }
 
 void TextScroll::setWindowWidth(float width) {
     windowWidth = width;
 }
 
+// Lays the string out on one line the way sf::Text does (kerning, the same
+// one pixel of glyph padding), minus the styles the scroller never uses.
+void TextScroll::buildGlyphs() {
+    glyphs.clear();
+    bounds = sf::FloatRect();
+    if (string.isEmpty()) {
+        return;
+    }
+
+    const float padding = 1.0f;
+    const float whitespaceWidth = font->getGlyph(L' ', characterSize, false).advance;
+    float x = 0.0f;
+    float y = static_cast<float>(characterSize);
+    float minX = static_cast<float>(characterSize);
+    float minY = static_cast<float>(characterSize);
+    float maxX = 0.0f;
+    float maxY = 0.0f;
+    sf::Uint32 previous = 0;
+
+    for (std::size_t i = 0; i < string.getSize(); ++i) {
+        sf::Uint32 current = string[i];
+        if (current == L'\r') {
+            continue;
+        }
+        x += font->getKerning(previous, current, characterSize);
+        previous = current;
+
+        if (current == L' ' || current == L'\n' || current == L'\t') {
+            x += current == L'\t' ? whitespaceWidth * 4 : whitespaceWidth;
+            maxX = std::max(maxX, x);
+            continue;
+        }
+
+        const sf::Glyph& glyph = font->getGlyph(current, characterSize, false);
+        float left = glyph.bounds.left - padding;
+        float top = glyph.bounds.top - padding;
+        float right = glyph.bounds.left + glyph.bounds.width + padding;
+        float bottom = glyph.bounds.top + glyph.bounds.height + padding;
+
+        float u1 = static_cast<float>(glyph.textureRect.left) - padding;
+        float v1 = static_cast<float>(glyph.textureRect.top) - padding;
+        float u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width) + padding;
+        float v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height) + padding;
+
+        glyphs.append(sf::Vertex(sf::Vector2f(x + left, y + top), color, sf::Vector2f(u1, v1)));
+        glyphs.append(sf::Vertex(sf::Vector2f(x + right, y + top), color, sf::Vector2f(u2, v1)));
+        glyphs.append(sf::Vertex(sf::Vector2f(x + left, y + bottom), color, sf::Vector2f(u1, v2)));
+        glyphs.append(sf::Vertex(sf::Vector2f(x + left, y + bottom), color, sf::Vector2f(u1, v2)));
+        glyphs.append(sf::Vertex(sf::Vector2f(x + right, y + top), color, sf::Vector2f(u2, v1)));
+        glyphs.append(sf::Vertex(sf::Vector2f(x + right, y + bottom), color, sf::Vector2f(u2, v2)));
+
+        minX = std::min(minX, x + glyph.bounds.left);
+        maxX = std::max(maxX, x + glyph.bounds.left + glyph.bounds.width);
+        minY = std::min(minY, y + glyph.bounds.top);
+        maxY = std::max(maxY, y + glyph.bounds.top + glyph.bounds.height);
+
+        x += glyph.advance;
+    }
+
+    bounds = sf::FloatRect(minX, minY, maxX - minX, maxY - minY);
+}
+
+void TextScroll::applyColor(const sf::Color& newColor) {
+    if (newColor == color) {
+        return;
+    }
+    color = newColor;
+    for (std::size_t i = 0; i < glyphs.getVertexCount(); ++i) {
+        glyphs[i].color = color;
+    }
+}
+
 void TextScroll::draw(sf::RenderTarget& target, sf::RenderStates states) const {
-    target.draw(text, states);
+    states.transform.translate(position);
+    states.texture = &font->getTexture(characterSize);
+    target.draw(glyphs, states);
 }
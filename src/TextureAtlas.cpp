@@ -0,0 +1,127 @@
+#include "TextureAtlas.h"
+#include "Utility.h"
+#include "AssetPack.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Transparent gap between packed images so smooth filtering never samples a neighbour.
+constexpr unsigned Padding = 2;
+
+}
+
+TextureAtlas::TextureAtlas(unsigned pageSize)
+    : pageSize(std::min(pageSize, sf::Texture::getMaximumSize())) {}
+
+void TextureAtlas::add(const std::string& name, const std::string& assetName, unsigned maxHeight) {
+    sf::Image image;
+    if (!SoftyPoker::loadAsset(image, assetName)) {
+        throw std::runtime_error("Failed to load atlas image: " + assetName);
+    }
+    if (maxHeight > 0 && image.getSize().y > maxHeight) {
+        unsigned width = image.getSize().x * maxHeight / image.getSize().y;
+        image = resampleImage(image, width, maxHeight);
+    }
+    add(name, image);
+}
+
+void TextureAtlas::add(const std::string& name, const sf::Image& image) {
+    if (image.getSize().x + Padding > pageSize || image.getSize().y + Padding > pageSize) {
+        throw std::runtime_error("Image too large for texture atlas: " + name);
+    }
+    int id = static_cast<int>(regions.size());
+    ids[name] = id;
+    regions.push_back(AtlasRegion{ 0, sf::IntRect(0, 0, image.getSize().x, image.getSize().y) });
+    pending.push_back(PendingImage{ id, image });
+}
+
+void TextureAtlas::build() {
+    // Shelf packing: tallest images first, left to right, opening a new shelf
+    // (or a new page) when the current one is full.
+    std::sort(pending.begin(), pending.end(), [](const PendingImage& a, const PendingImage& b) {
+        return a.image.getSize().y > b.image.getSize().y;
+    });
+
+    std::vector<sf::Image> pageImages;
+    std::vector<sf::Vector2u> pageExtents;
+    unsigned x = pageSize;
+    unsigned y = 0;
+    unsigned shelfHeight = 0;
+    for (const PendingImage& item : pending) {
+        sf::Vector2u size = item.image.getSize();
+        if (x + size.x + Padding > pageSize) {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (pageImages.empty() || y + size.y + Padding > pageSize) {
+            pageImages.emplace_back();
+            pageImages.back().create(pageSize, pageSize, sf::Color::Transparent);
+            pageExtents.emplace_back(0u, 0u);
+            x = 0;
+            y = 0;
+            shelfHeight = 0;
+        }
+
+        pageImages.back().copy(item.image, x, y);
+        AtlasRegion& region = regions[item.id];
+        region.page = static_cast<unsigned>(pageImages.size() - 1);
+        region.rect = sf::IntRect(x, y, size.x, size.y);
+        sf::Vector2u& extent = pageExtents.back();
+        extent.x = std::max(extent.x, x + size.x + Padding);
+        extent.y = std::max(extent.y, y + size.y + Padding);
+
+        x += size.x + Padding;
+        shelfHeight = std::max(shelfHeight, size.y + Padding);
+    }
+    pending.clear();
+
+    releasePages();
+    for (std::size_t page = 0; page < pageImages.size(); ++page) {
+        const sf::Vector2u& extent = pageExtents[page];
+        auto texture = std::make_unique<sf::Texture>();
+        if (!texture->loadFromImage(pageImages[page], sf::IntRect(0, 0, extent.x, extent.y))) {
+            throw std::runtime_error("Failed to create texture atlas page");
+        }
+        texture->setSmooth(true);
+        SoftyPoker::Profiler::trackTextureMemory(textureBytes(*texture));
+        pages.push_back(std::move(texture));
+    }
+}
+
+TextureAtlas::~TextureAtlas() {
+    releasePages();
+}
+
+void TextureAtlas::clear() {
+    pending.clear();
+    regions.clear();
+    ids.clear();
+    releasePages();
+}
+
+void TextureAtlas::releasePages() {
+    for (const auto& page : pages) {
+        SoftyPoker::Profiler::trackTextureMemory(-textureBytes(*page));
+    }
+    pages.clear();
+}
+
+int TextureAtlas::find(const std::string& name) const {
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : -1;
+}
+
+const AtlasRegion& TextureAtlas::getRegion(int id) const {
+    return regions[id];
+}
+
+const sf::Texture& TextureAtlas::getPage(unsigned index) const {
+    return *pages[index];
+}
+
+unsigned TextureAtlas::getPageCount() const {
+    return static_cast<unsigned>(pages.size());
+}
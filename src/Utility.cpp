@@ -1,29 +1,102 @@
 #include "Utility.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
 
-void resizeBackground(sf::RenderWindow& window, sf::Sprite& backgroundSprite, sf::Texture& backgroundTexture) {
-    float windowRatio = static_cast<float>(window.getSize().x) / window.getSize().y;
-    float textureRatio = static_cast<float>(backgroundTexture.getSize().x) / backgroundTexture.getSize().y;
+namespace {
 
-    float scale;
-    if (windowRatio > textureRatio) {
-        scale = static_cast<float>(window.getSize().x) / backgroundTexture.getSize().x;
-    } else {
-        scale = static_cast<float>(window.getSize().y) / backgroundTexture.getSize().y;
+// Loose asset roots, searched in order. SOFTYPOKER_ASSETS overrides them for
+// installs that keep the files elsewhere; the two spellings cover the split
+// between Assets/ and assets/ on case-sensitive file systems.
+std::vector<std::string> assetRoots() {
+    std::vector<std::string> roots;
+    if (const char* custom = std::getenv("SOFTYPOKER_ASSETS")) {
+        std::string root = custom;
+        if (!root.empty() && root.back() != '/' && root.back() != '\\') {
+            root += '/';
+        }
+        roots.push_back(root);
     }
+    roots.push_back("Assets/");
+    roots.push_back("assets/");
+    return roots;
+}
 
-    backgroundSprite.setScale(scale, scale);
-
-    sf::Vector2f newSize(
-        backgroundTexture.getSize().x * scale,
-        backgroundTexture.getSize().y * scale
-    );
-    backgroundSprite.setPosition(
-        (window.getSize().x - newSize.x) / 2,
-        (window.getSize().y - newSize.y) / 2
-    );
 }
 
 std::string getAssetPath(const std::string& relativePath) {
-    std::string basePath = "D:/Projects/softypoker/assets/";  // Update this to your actual assets path
-    return basePath + relativePath;
+    std::vector<std::string> roots = assetRoots();
+    for (const std::string& root : roots) {
+        std::error_code error;
+        if (std::filesystem::exists(root + relativePath, error)) {
+            return root + relativePath;
+        }
+    }
+    return roots.front() + relativePath;
+}
+
+std::vector<std::string> listAssetFiles(const std::string& prefix) {
+    std::vector<std::string> names;
+    for (const std::string& root : assetRoots()) {
+        std::error_code error;
+        for (std::filesystem::directory_iterator it(root + prefix, error), end; !error && it != end; it.increment(error)) {
+            if (it->is_regular_file(error)) {
+                names.push_back(prefix + it->path().filename().generic_string());
+            }
+        }
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+
+sf::Vector2u coverSize(sf::Vector2u source, sf::Vector2u target) {
+    if (source.x == 0 || source.y == 0) {
+        return source;
+    }
+    float scale = std::max(static_cast<float>(target.x) / source.x, static_cast<float>(target.y) / source.y);
+    if (scale >= 1.0f) {
+        return source;
+    }
+    return sf::Vector2u(std::max(1u, static_cast<unsigned>(std::ceil(source.x * scale))),
+                        std::max(1u, static_cast<unsigned>(std::ceil(source.y * scale))));
+}
+
+sf::Image resampleImage(const sf::Image& source, unsigned width, unsigned height) {
+    sf::Vector2u sourceSize = source.getSize();
+    const sf::Uint8* pixels = source.getPixelsPtr();
+    std::vector<sf::Uint8> result(width * height * 4);
+
+    for (unsigned y = 0; y < height; ++y) {
+        unsigned y0 = y * sourceSize.y / height;
+        unsigned y1 = std::max(y0 + 1, (y + 1) * sourceSize.y / height);
+        for (unsigned x = 0; x < width; ++x) {
+            unsigned x0 = x * sourceSize.x / width;
+            unsigned x1 = std::max(x0 + 1, (x + 1) * sourceSize.x / width);
+
+            // Alpha-weighted average so transparent edges do not darken the colour
+            unsigned long sum[4] = {};
+            for (unsigned sy = y0; sy < y1; ++sy) {
+                const sf::Uint8* row = pixels + (sy * sourceSize.x + x0) * 4;
+                for (unsigned sx = x0; sx < x1; ++sx, row += 4) {
+                    sum[0] += row[0] * row[3];
+                    sum[1] += row[1] * row[3];
+                    sum[2] += row[2] * row[3];
+                    sum[3] += row[3];
+                }
+            }
+            unsigned long count = (y1 - y0) * (x1 - x0);
+            sf::Uint8* out = &result[(y * width + x) * 4];
+            for (int channel = 0; channel < 3; ++channel) {
+                out[channel] = static_cast<sf::Uint8>(sum[3] ? sum[channel] / sum[3] : 0);
+            }
+            out[3] = static_cast<sf::Uint8>(sum[3] / count);
+        }
+    }
+
+    sf::Image image;
+    image.create(width, height, result.data());
+    return image;
 }
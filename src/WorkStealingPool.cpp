@@ -0,0 +1,103 @@
+#include "WorkStealingPool.h"
+
+namespace SoftyPoker {
+
+namespace {
+
+// Index of the pool worker running on this thread, so tasks spawned from a
+// task land on the spawning worker's own deque.
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local unsigned currentWorker = 0;
+
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+    : sleepers(0), pendingTasks(0), nextWorker(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads.emplace_back([this, i]() { run(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    unsigned index = currentPool == this ? currentWorker : nextWorker++ % workers.size();
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+    // Both counters are sequentially consistent: either this sees the
+    // sleeper, or the sleeper sees the task before it waits.
+    ++pendingTasks;
+    if (sleepers.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wakeUp.notify_one();
+    }
+}
+
+unsigned WorkStealingPool::size() const {
+    return static_cast<unsigned>(workers.size());
+}
+
+bool WorkStealingPool::takeTask(unsigned index, std::function<void()>& task) {
+    {
+        Worker& own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (unsigned offset = 1; offset < workers.size(); ++offset) {
+        Worker& victim = *workers[(index + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(unsigned index) {
+    currentPool = this;
+    currentWorker = index;
+
+    std::function<void()> task;
+    while (!stopping.load(std::memory_order_relaxed)) {
+        if (takeTask(index, task)) {
+            --pendingTasks;
+            task();
+            task = nullptr;
+        } else if (pendingTasks.load() > 0) {
+            // Another worker is about to take the last one
+            std::this_thread::yield();
+        } else {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            ++sleepers;
+            wakeUp.wait(lock, [this]() { return stopping || pendingTasks.load() > 0; });
+            --sleepers;
+        }
+    }
+}
+
+} // namespace SoftyPoker
@@ -2,30 +2,148 @@
 #include "ControlManager.h"
 #include "SoundManager.h"
 #include "IntroState.h"
+#include "LoadingState.h"
+#include "MachineConfig.h"
+#include "MainGameState.h"
+#include "Random.h"
+#include "Session.h"
+#include "AssetLoader.h"
+#include "FrameScheduler.h"
+#include "Journal.h"
+#include "Profiler.h"
+#include "ProfilerOverlay.h"
+#include "ResourceCache.h"
+#include "Log.h"
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include <cstdint>
+#include <string>
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Log lines are written by a thread of their own, to the console and to logs/
+    SoftyPoker::Log::openFile("logs");
+
+    // softypoker --replay <file> plays a recorded table session back on screen
+    SoftyPoker::SessionLog replayLog;
+    bool replay = argc == 3 && std::string(argv[1]) == "--replay";
+    if (replay && !SoftyPoker::loadSession(argv[2], replayLog)) {
+        LOG_ERROR("Could not read session: {}", argv[2]);
+        return 1;
+    }
+
+    // A session still open when the machine went down carries on where it
+    // stopped, credits and all, before anything else is shown
+    SoftyPoker::JournalRecovery recovered;
+    bool resume = !replay && SoftyPoker::recoverJournal(SoftyPoker::JournalPath, recovered);
+
+    // A replay or a recovered session is shown on the table it was played on, whatever this machine runs
+    SoftyPoker::MachineConfig config = SoftyPoker::loadMachineConfig();
+    SoftyPoker::VariantId tableVariant = replay ? replayLog.variant : resume ? recovered.log.variant : config.variant;
+    const SoftyPoker::GameVariant& variant = SoftyPoker::GameVariant::get(tableVariant);
+    int tableHands = replay ? replayLog.hands : resume ? recovered.log.hands : config.hands;
+    SoftyPoker::resourceCache().setBudget(static_cast<std::size_t>(config.cacheMegabytes) << 20);
+
+    // The deal gets a full 64-bit seed of its own, not one from the cosmetic generator
+    std::uint64_t tableSeed = SoftyPoker::randomSeed();
+
     sf::RenderWindow window(sf::VideoMode(1280, 720), "SoftyPoker");
+    // Declared before the states that refer to them, so they outlive them
+    SoundManager soundManager;
+    SoftyPoker::AssetLoader assetLoader;
     StateManager stateManager;
     ControlManager controlManager(stateManager);
-    SoundManager soundManager;
 
-    soundManager.initializeMusic();
-    auto introState = std::make_unique<SoftyPoker::IntroState>(soundManager, window);
-    stateManager.addState("Intro", std::move(introState));
-    stateManager.switchToState("Intro");
+    // The loading screen draws from the first frame while the intro's assets decode.
+    SoftyPoker::IntroAssets introAssets = SoftyPoker::IntroState::requestAssets(assetLoader, soundManager, window.getSize());
+    std::string tableBackground = introAssets.backgroundName;
+
+    stateManager.registerState(StateId::Loading, [&]() {
+        return std::make_unique<SoftyPoker::LoadingState>(assetLoader, [&]() {
+            if (replay || resume) {
+                introAssets = SoftyPoker::IntroAssets();
+                stateManager.replace(StateId::Table);
+                return;
+            }
+            stateManager.replace(StateId::Intro);
+            // The table builds its atlas in the background while the intro plays
+            stateManager.preload(StateId::Table);
+        });
+    });
+    stateManager.registerState(StateId::Intro, [&]() {
+        auto introState = std::make_unique<SoftyPoker::IntroState>(soundManager, window, introAssets, [&]() {
+            stateManager.replace(StateId::Table);
+        });
+        // The intro holds the only references now, and its assets leave the cache with it
+        introAssets = SoftyPoker::IntroAssets();
+        return introState;
+    });
+    stateManager.registerState(StateId::Table, [&]() {
+        auto table = std::make_unique<SoftyPoker::MainGameState>(soundManager, window, tableBackground, tableSeed, variant, tableHands);
+        table->setHoldAdvice(config.holdAdvice);
+        if (replay) {
+            table->startReplay(replayLog);
+        } else if (resume) {
+            table->resumeSession(recovered);
+        }
+        return table;
+    });
+    stateManager.push(StateId::Loading);
+
+    SoftyPoker::ProfilerOverlay profilerOverlay;
+    SoftyPoker::FrameSettings frameSettings;
+    frameSettings.frameLimit = static_cast<unsigned>(config.frameCap);
+    frameSettings.renderOnDemand = config.renderOnDemand;
+    SoftyPoker::FrameScheduler scheduler(frameSettings);
+    scheduler.applyTo(window);
+    bool paused = false;
 
     while (window.isOpen()) {
         sf::Event event;
         while (window.pollEvent(event)) {
-            controlManager.handleInput(event, window);
+            scheduler.onEvent(event);
+            if (!profilerOverlay.handleEvent(event)) {
+                controlManager.handleInput(event, window);
+            }
+        }
+
+        // In the background: no simulation, no drawing, no music
+        if (scheduler.isPaused() != paused) {
+            paused = scheduler.isPaused();
+            soundManager.setMusicPaused(paused);
+        }
+        if (paused) {
+            scheduler.idle();
+            continue;
         }
 
-        stateManager.update(window);
-        stateManager.draw(window);
+        int ticks = scheduler.beginFrame();
+        {
+            PROFILE_SCOPE("Frame");
+            for (int i = 0; i < ticks; ++i) {
+                stateManager.update(window, scheduler.getTickStep());
+            }
+            soundManager.updateMusic(scheduler.getFrameTime());
+
+            // A state that has just gone may have left cached assets nobody holds
+            bool switched = stateManager.takeSwitched();
+            if (switched) {
+                SoftyPoker::resourceCache().trim();
+            }
+            // The overlay graph moves every frame, so it keeps the frame live
+            bool changed = switched || stateManager.needsRedraw() || profilerOverlay.isVisible();
+            if (scheduler.shouldRender(changed)) {
+                stateManager.draw(window);
+                profilerOverlay.draw(window);
+                PROFILE_SCOPE("Present");
+                window.display();
+            }
+        }
+        SoftyPoker::Profiler::endFrame(scheduler.getFrameTime());
+        scheduler.endFrame();
     }
 
+    // The window's GL context is still there for what the cache lets go of
+    SoftyPoker::resourceCache().clear();
     return 0;
 }
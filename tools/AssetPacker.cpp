@@ -0,0 +1,186 @@
+// Builds softypoker.pak from one or more loose asset directories.
+// Every file below each root is stored under its root-relative path, e.g.
+// Assets/images/logo.png becomes "images/logo.png". Roots given later win
+// when two of them hold the same name.
+
+#include "PackFormat.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace SoftyPoker;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::string output;
+    std::vector<std::string> roots;
+    bool compress = true;
+};
+
+struct PackedFile {
+    std::string name;
+    std::vector<std::uint8_t> data;
+    std::uint64_t size = 0;
+    std::uint8_t compression = Pack::Stored;
+};
+
+void printUsage() {
+    std::cout << "usage: softypoker-pack [--store] <output.pak> <asset-dir>...\n"
+              << "  --store   never compress entries\n"
+              << "example: softypoker-pack softypoker.pak Assets assets\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--store") {
+            options.compress = false;
+        } else if (arg == "--help" || arg == "-h") {
+            return false;
+        } else if (options.output.empty()) {
+            options.output = arg;
+        } else {
+            options.roots.push_back(arg);
+        }
+    }
+    return !options.output.empty() && !options.roots.empty();
+}
+
+// Images and music are already compressed; LZ only pays off on raw formats.
+bool worthCompressing(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension != ".png" && extension != ".jpg" && extension != ".ogg" && extension != ".flac";
+}
+
+bool readFile(const fs::path& path, std::vector<std::uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+void writePadding(std::ofstream& out, std::uint64_t& position, std::uint64_t target) {
+    static const char zeros[Pack::Alignment] = {};
+    out.write(zeros, static_cast<std::streamsize>(target - position));
+    position = target;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    std::map<std::string, fs::path> sources;
+    for (const std::string& root : options.roots) {
+        std::error_code error;
+        for (fs::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error)) {
+            if (!it->is_regular_file()) {
+                continue;
+            }
+            std::string name = fs::relative(it->path(), root).generic_string();
+            auto existing = sources.find(name);
+            if (existing != sources.end()) {
+                std::cout << "replacing " << existing->second.generic_string() << " with " << it->path().generic_string() << "\n";
+            }
+            sources[name] = it->path();
+        }
+        if (error) {
+            std::cerr << "cannot read " << root << ": " << error.message() << "\n";
+            return 1;
+        }
+    }
+    if (sources.empty()) {
+        std::cerr << "no files found\n";
+        return 1;
+    }
+
+    // std::map keeps the names sorted, which is the order the runtime binary searches.
+    std::vector<PackedFile> files;
+    std::uint64_t looseBytes = 0;
+    for (const auto& source : sources) {
+        PackedFile file;
+        file.name = source.first;
+        if (!readFile(source.second, file.data)) {
+            std::cerr << "cannot read " << source.second.generic_string() << "\n";
+            return 1;
+        }
+        file.size = file.data.size();
+        looseBytes += file.size;
+
+        if (options.compress && worthCompressing(source.second) && !file.data.empty()) {
+            std::vector<std::uint8_t> packed = Pack::compress(file.data.data(), file.data.size());
+            if (packed.size() < file.data.size() * 9 / 10) {
+                file.data = std::move(packed);
+                file.compression = Pack::Lz;
+            }
+        }
+        files.push_back(std::move(file));
+    }
+
+    std::string names;
+    std::vector<Pack::Entry> entries(files.size());
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        entries[i].nameOffset = static_cast<std::uint32_t>(names.size());
+        entries[i].nameLength = static_cast<std::uint16_t>(files[i].name.size());
+        entries[i].compression = files[i].compression;
+        entries[i].size = files[i].size;
+        entries[i].storedSize = files[i].data.size();
+        names += files[i].name;
+    }
+
+    Pack::Header header = {};
+    std::memcpy(header.magic, Pack::Magic, sizeof(header.magic));
+    header.version = Pack::Version;
+    header.entryCount = static_cast<std::uint32_t>(entries.size());
+    header.namesOffset = sizeof(Pack::Header) + entries.size() * sizeof(Pack::Entry);
+    header.namesSize = static_cast<std::uint32_t>(names.size());
+
+    std::uint64_t offset = Pack::align(header.namesOffset + header.namesSize);
+    for (Pack::Entry& entry : entries) {
+        entry.offset = offset;
+        offset = Pack::align(offset + entry.storedSize);
+    }
+
+    std::ofstream out(options.output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "cannot write " << options.output << "\n";
+        return 1;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Pack::Entry));
+    out.write(names.data(), names.size());
+
+    std::uint64_t position = header.namesOffset + header.namesSize;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        writePadding(out, position, entries[i].offset);
+        out.write(reinterpret_cast<const char*>(files[i].data.data()), files[i].data.size());
+        position += files[i].data.size();
+    }
+    if (!out) {
+        std::cerr << "error writing " << options.output << "\n";
+        return 1;
+    }
+
+    int compressed = static_cast<int>(std::count_if(files.begin(), files.end(), [](const PackedFile& file) {
+        return file.compression != Pack::Stored;
+    }));
+    std::cout << options.output << ": " << files.size() << " entries (" << compressed << " compressed), "
+              << looseBytes / 1024 << " KB loose, " << position / 1024 << " KB packed\n";
+    return 0;
+}
@@ -0,0 +1,496 @@
+// Load generator for softypoker-server.
+// Opens many table sessions from a few threads and plays them the way
+// players might: a random bet, random holds, now and then a double-up,
+// and a new session once one runs out of credits. Each session keeps one
+// action in flight (plus an optional think time) and times it from send to
+// reply. At the end it reports sessions per server core, throughput and
+// the action latency percentiles. Unless --no-verify is given, every
+// session is followed by a PokerGame of its own that checks each reply's
+// digest, so the server is also shown to play the same game as the table.
+
+#include "GameVariant.h"
+#include "MultiHand.h"
+#include "Net.h"
+#include "PokerGame.h"
+#include "Random.h"
+#include "ServerProtocol.h"
+#include "Session.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SoftyPoker;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    std::uint16_t port = DefaultServerPort;
+    unsigned sessions = 1000;
+    unsigned threads = 2;
+    double seconds = 10.0;
+    double thinkMs = 0.0;
+    const GameVariant* variant = &GameVariant::standard();
+    int hands = 1;
+    bool verify = true;
+    std::uint64_t seed = 1;
+};
+
+void printUsage() {
+    std::cout << "usage: softypoker-load [--host <name>] [--port <n>] [--sessions <n>] [--threads <n>] [--seconds <n>]\n"
+              << "                       [--think <ms>] [--variant <name>] [--hands <n>] [--seed <n>] [--no-verify]\n"
+              << "  --sessions <n>   concurrent sessions, default 1000\n"
+              << "  --threads <n>    client threads, default 2\n"
+              << "  --seconds <n>    how long to play, default 10\n"
+              << "  --think <ms>     pause after each reply before the next action, default 0\n"
+              << "  --variant <name> jacks-or-better (default), deuces-wild, joker-poker\n"
+              << "  --hands <n>      hands per round, 1, 3, 10, 50 or 100, default 1\n"
+              << "  --seed <n>       seed for the players' choices, default 1\n"
+              << "  --no-verify      do not check replies against a local PokerGame\n";
+}
+
+std::uint64_t parseNumber(const std::string& value) {
+    std::size_t used = 0;
+    unsigned long long number = std::stoull(value, &used);
+    if (used != value.size()) {
+        throw std::invalid_argument("not a number: " + value);
+    }
+    return number;
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(arg + " needs a value");
+            }
+            return argv[++i];
+        };
+        if (arg == "--host") {
+            options.host = value();
+        } else if (arg == "--port") {
+            std::uint64_t port = parseNumber(value());
+            if (port == 0 || port > 65535) {
+                throw std::invalid_argument("--port must be 1 to 65535");
+            }
+            options.port = static_cast<std::uint16_t>(port);
+        } else if (arg == "--sessions") {
+            options.sessions = std::max<unsigned>(1, static_cast<unsigned>(parseNumber(value())));
+        } else if (arg == "--threads") {
+            options.threads = std::max<unsigned>(1, static_cast<unsigned>(parseNumber(value())));
+        } else if (arg == "--seconds") {
+            options.seconds = std::max(0.1, std::stod(value()));
+        } else if (arg == "--think") {
+            options.thinkMs = std::max(0.0, std::stod(value()));
+        } else if (arg == "--variant") {
+            std::string name = value();
+            options.variant = GameVariant::find(name);
+            if (!options.variant) {
+                throw std::invalid_argument("unknown variant: " + name);
+            }
+        } else if (arg == "--hands") {
+            options.hands = static_cast<int>(parseNumber(value()));
+            if (!isHandCount(options.hands)) {
+                throw std::invalid_argument("--hands must be 1, 3, 10, 50 or 100");
+            }
+        } else if (arg == "--seed") {
+            options.seed = parseNumber(value());
+        } else if (arg == "--no-verify") {
+            options.verify = false;
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("unknown option: " + arg);
+        }
+    }
+    options.threads = std::min(options.threads, options.sessions);
+    return options;
+}
+
+struct Player {
+    SocketHandle socket = NoSocket;
+    bool greeted = false;
+    std::uint16_t shard = 0;
+    std::optional<PokerGame> mirror;
+    std::uint64_t digest = SessionDigestSeed;
+
+    // The last reply
+    GamePhase phase = GamePhase::Betting;
+    int credits = 0;
+    int bet = 0;
+
+    // This round's plan
+    int betsLeft = 0;
+    int holdsLeft = 0;         // bit per card still to toggle
+    bool doubled = false;
+
+    Command sent = Command::None;
+    std::uint32_t sequence = 0;
+    Clock::time_point sentAt;
+    std::array<std::uint8_t, 128> input;
+    std::size_t inputUsed = 0;
+};
+
+struct ThreadResult {
+    std::vector<float> latencyUs;
+    std::vector<std::uint64_t> sessionsPerShard;
+    std::uint64_t actions = 0;
+    std::uint64_t rounds = 0;
+    std::uint64_t restarts = 0;
+    std::uint64_t mismatches = 0;
+    std::uint64_t failures = 0;
+};
+
+class PlayerThread {
+public:
+    PlayerThread(const Options& options, unsigned first, unsigned count, Clock::time_point deadline)
+        : options(options),
+          script(options.seed, first),
+          players(count),
+          deadline(deadline) {
+    }
+
+    ThreadResult run() {
+        for (std::size_t i = 0; i < players.size(); ++i) {
+            if (!open(i)) {
+                ++result.failures;
+            }
+        }
+        std::vector<PollEvent> events;
+        const auto think = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(options.thinkMs));
+        while (Clock::now() < deadline) {
+            int timeoutMs = 100;
+            if (!thinking.empty()) {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(thinking.front().first - Clock::now());
+                timeoutMs = static_cast<int>(std::max<std::chrono::milliseconds::rep>(0, wait.count()));
+            }
+            poller.wait(events, timeoutMs);
+            for (const PollEvent& event : events) {
+                std::size_t index = static_cast<std::size_t>(event.token);
+                if (players[index].socket != NoSocket && !receive(index)) {
+                    restart(index);
+                }
+            }
+            // Everyone thinks for the same time, so the queue stays in order
+            Clock::time_point now = Clock::now();
+            while (!thinking.empty() && thinking.front().first <= now) {
+                std::size_t index = thinking.front().second;
+                thinking.pop_front();
+                act(index);
+            }
+            for (std::size_t index : ready) {
+                if (think.count() > 0) {
+                    thinking.emplace_back(now + think, index);
+                } else {
+                    act(index);
+                }
+            }
+            ready.clear();
+        }
+
+        for (Player& player : players) {
+            if (player.socket != NoSocket) {
+                if (player.greeted) {
+                    if (result.sessionsPerShard.size() <= player.shard) {
+                        result.sessionsPerShard.resize(player.shard + 1);
+                    }
+                    ++result.sessionsPerShard[player.shard];
+                }
+                closeSocket(player.socket);
+            }
+        }
+        return std::move(result);
+    }
+
+private:
+    bool open(std::size_t index) {
+        Player& player = players[index];
+        player = Player();
+        player.socket = connectTo(options.host, options.port);
+        if (player.socket == NoSocket) {
+            return false;
+        }
+        ClientHello hello = {};
+        std::memcpy(hello.magic, ClientMagic, sizeof(hello.magic));
+        hello.version = ProtocolVersion;
+        hello.variant = static_cast<std::uint8_t>(options.variant->id);
+        hello.hands = static_cast<std::uint16_t>(options.hands);
+        if (!sendAll(player.socket, &hello, sizeof(hello)) || !poller.add(player.socket, index)) {
+            closeSocket(player.socket);
+            player.socket = NoSocket;
+            return false;
+        }
+        return true;
+    }
+
+    // Ends a session that went broke or failed and starts another in its place
+    void restart(std::size_t index) {
+        Player& player = players[index];
+        if (player.socket != NoSocket) {
+            poller.remove(player.socket);
+            closeSocket(player.socket);
+            player.socket = NoSocket;
+        }
+        ++result.restarts;
+        if (Clock::now() < deadline && !open(index)) {
+            ++result.failures;
+        }
+    }
+
+    // Requests are 8 bytes and only one is ever in flight, so they fit the socket buffer
+    static bool sendAll(SocketHandle socket, const void* data, std::size_t size) {
+        const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+        while (size > 0) {
+            long sent = sendSome(socket, bytes, size);
+            if (sent < 0) {
+                return false;
+            }
+            if (sent == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            bytes += sent;
+            size -= static_cast<std::size_t>(sent);
+        }
+        return true;
+    }
+
+    bool receive(std::size_t index) {
+        Player& player = players[index];
+        std::size_t room = player.input.size() - player.inputUsed;
+        long received = receiveSome(player.socket, player.input.data() + player.inputUsed, room);
+        if (received < 0) {
+            return false;
+        }
+        player.inputUsed += static_cast<std::size_t>(received);
+        // Only one message is ever on its way, so one read gets it; the rest
+        // of a split one is reported again
+        std::size_t needed = player.greeted ? sizeof(ActionReply) : sizeof(ServerHello);
+        if (player.inputUsed < needed) {
+            return true;
+        }
+        bool ok = player.greeted ? onReply(index) : onHello(index);
+        std::memmove(player.input.data(), player.input.data() + needed, player.inputUsed - needed);
+        player.inputUsed -= needed;
+        return ok;
+    }
+
+    bool onHello(std::size_t index) {
+        Player& player = players[index];
+        ServerHello hello;
+        std::memcpy(&hello, player.input.data(), sizeof(hello));
+        if (std::memcmp(hello.magic, ServerMagic, sizeof(hello.magic)) != 0 || !hello.accepted) {
+            ++result.failures;
+            return false;
+        }
+        player.greeted = true;
+        player.shard = hello.shard;
+        player.credits = hello.credits;
+        if (options.verify) {
+            player.mirror.emplace(CounterRng(hello.seed), hello.credits, *options.variant);
+            player.mirror->setHandCount(options.hands);
+        }
+        planRound(player);
+        ready.push_back(index);
+        return true;
+    }
+
+    bool onReply(std::size_t index) {
+        Player& player = players[index];
+        ActionReply reply;
+        std::memcpy(&reply, player.input.data(), sizeof(reply));
+        float latency = std::chrono::duration<float, std::micro>(Clock::now() - player.sentAt).count();
+        result.latencyUs.push_back(latency);
+        ++result.actions;
+
+        if (player.mirror) {
+            GambleResult gambleResult = GambleResult::Push;
+            bool applied = applyCommand(*player.mirror, player.sent, gambleResult);
+            if (applied) {
+                player.digest = stateDigest(player.digest, *player.mirror);
+            }
+            if (applied != (reply.applied != 0) || player.digest != reply.digest || reply.sequence != player.sequence) {
+                ++result.mismatches;
+            }
+        }
+
+        GamePhase before = player.phase;
+        player.phase = static_cast<GamePhase>(reply.phase);
+        player.credits = reply.credits;
+        player.bet = reply.bet;
+        if (player.phase == GamePhase::Betting && before != GamePhase::Betting) {
+            ++result.rounds;
+            planRound(player);
+        }
+        if (player.phase == GamePhase::Betting && player.bet == 0 && player.credits == 0) {
+            return false;
+        }
+        ready.push_back(index);
+        return true;
+    }
+
+    void planRound(Player& player) {
+        player.betsLeft = 1 + static_cast<int>(script.uniform(5));
+        player.holdsLeft = static_cast<int>(script.uniform(32));
+        player.doubled = false;
+    }
+
+    Command decide(Player& player) {
+        switch (player.phase) {
+        case GamePhase::Betting:
+            if (player.betsLeft > 0 || player.bet == 0) {
+                --player.betsLeft;
+                return Command::Bet;
+            }
+            return Command::Deal;
+        case GamePhase::Dealt:
+            for (int card = 0; card < 5; ++card) {
+                if (player.holdsLeft & (1 << card)) {
+                    player.holdsLeft &= ~(1 << card);
+                    return static_cast<Command>(static_cast<int>(Command::Hold1) + card);
+                }
+            }
+            return Command::Deal;
+        case GamePhase::Won:
+            if (!player.doubled && script.uniform(3) == 0) {
+                player.doubled = true;
+                return Command::Double;
+            }
+            return Command::Collect;
+        case GamePhase::Gambling:
+            return script.uniform(2) ? Command::High : Command::Low;
+        }
+        return Command::Collect;
+    }
+
+    void act(std::size_t index) {
+        Player& player = players[index];
+        if (player.socket == NoSocket) {
+            return;
+        }
+        ActionRequest request = {};
+        request.sequence = ++player.sequence;
+        player.sent = decide(player);
+        request.command = static_cast<std::uint8_t>(player.sent);
+        player.sentAt = Clock::now();
+        if (!sendAll(player.socket, &request, sizeof(request))) {
+            restart(index);
+        }
+    }
+
+    const Options& options;
+    CounterRng script;
+    std::vector<Player> players;
+    Clock::time_point deadline;
+    Poller poller;
+    std::vector<std::size_t> ready;
+    std::deque<std::pair<Clock::time_point, std::size_t>> thinking;
+    ThreadResult result;
+};
+
+float percentile(const std::vector<float>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0f;
+    }
+    std::size_t index = std::min(sorted.size() - 1, static_cast<std::size_t>(sorted.size() * fraction));
+    return sorted[index];
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "[Error] " << e.what() << std::endl;
+        printUsage();
+        return 1;
+    }
+    if (!initSockets()) {
+        std::cerr << "[Error] could not start networking" << std::endl;
+        return 1;
+    }
+
+    auto started = Clock::now();
+    auto deadline = started + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.seconds));
+    std::vector<ThreadResult> results(options.threads);
+    std::vector<std::thread> threads;
+    unsigned first = 0;
+    for (unsigned t = 0; t < options.threads; ++t) {
+        unsigned count = options.sessions / options.threads + (t < options.sessions % options.threads ? 1 : 0);
+        threads.emplace_back([&options, &results, t, first, count, deadline]() {
+            PlayerThread players(options, first, count, deadline);
+            results[t] = players.run();
+        });
+        first += count;
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+
+    ThreadResult total;
+    for (ThreadResult& result : results) {
+        total.latencyUs.insert(total.latencyUs.end(), result.latencyUs.begin(), result.latencyUs.end());
+        if (total.sessionsPerShard.size() < result.sessionsPerShard.size()) {
+            total.sessionsPerShard.resize(result.sessionsPerShard.size());
+        }
+        for (std::size_t shard = 0; shard < result.sessionsPerShard.size(); ++shard) {
+            total.sessionsPerShard[shard] += result.sessionsPerShard[shard];
+        }
+        total.actions += result.actions;
+        total.rounds += result.rounds;
+        total.restarts += result.restarts;
+        total.mismatches += result.mismatches;
+        total.failures += result.failures;
+    }
+    std::sort(total.latencyUs.begin(), total.latencyUs.end());
+
+    std::uint64_t open = 0;
+    for (std::uint64_t count : total.sessionsPerShard) {
+        open += count;
+    }
+    std::size_t cores = std::max<std::size_t>(1, total.sessionsPerShard.size());
+    auto busiest = std::max_element(total.sessionsPerShard.begin(), total.sessionsPerShard.end());
+    auto quietest = std::min_element(total.sessionsPerShard.begin(), total.sessionsPerShard.end());
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "sessions      " << open << " open on " << total.sessionsPerShard.size() << " server cores: "
+              << static_cast<double>(open) / cores << " per core (min " << (quietest != total.sessionsPerShard.end() ? *quietest : 0)
+              << ", max " << (busiest != total.sessionsPerShard.end() ? *busiest : 0) << ")\n"
+              << "actions       " << total.actions << " in " << elapsed << " s: "
+              << total.actions / elapsed << "/s, " << total.actions / elapsed / cores << "/s per core\n"
+              << "latency (us)  p50 " << percentile(total.latencyUs, 0.5)
+              << "  p90 " << percentile(total.latencyUs, 0.9)
+              << "  p99 " << percentile(total.latencyUs, 0.99)
+              << "  p99.9 " << percentile(total.latencyUs, 0.999)
+              << "  max " << (total.latencyUs.empty() ? 0.0f : total.latencyUs.back()) << "\n"
+              << "rounds        " << total.rounds << ", " << total.restarts << " sessions ended and replaced\n";
+    if (options.verify) {
+        std::cout << "verified      " << (total.mismatches == 0 ? "every reply matches the local game" : "MISMATCHES: ")
+                  << (total.mismatches == 0 ? std::string() : std::to_string(total.mismatches)) << "\n";
+    }
+    if (total.failures > 0) {
+        std::cout << "failures      " << total.failures << " sessions could not be opened or were refused\n";
+    }
+    return total.mismatches == 0 && total.failures == 0 ? 0 : 1;
+}
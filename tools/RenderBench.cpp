@@ -0,0 +1,400 @@
+// Offscreen rendering benchmark.
+// Drives IntroState and MainGameState into sf::RenderTextures with a fixed
+// simulation step and scripted input, so two runs of the same scenario do the
+// same work, and reports frame time percentiles, draw calls and heap
+// allocations per frame. Needs no window: on a Linux box without a display run
+// it under xvfb-run with Mesa, see the README.
+
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "IntroState.h"
+#include "MainGameState.h"
+#include "MultiHand.h"
+#include "Profiler.h"
+#include "ResourceCache.h"
+#include "SoundManager.h"
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace SoftyPoker;
+
+// Every heap allocation in the process is counted, worker threads included,
+// so the per-frame figure also shows what a frame sets off in the background.
+namespace {
+std::atomic<std::uint64_t> allocationCount(0);
+}
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+enum class Scenario {
+    IntroScroll,   // the intro as shipped: scrolling text, logo fade, background
+    IntroResize,   // the intro while the target changes size every few frames
+    TableCycle     // bet, deal, hold, draw and collect on the table, over and over
+};
+
+struct Options {
+    Scenario scenario = Scenario::IntroScroll;
+    int frames = 600;
+    int warmup = 60;
+    unsigned width = 1280;
+    unsigned height = 720;
+    std::uint64_t seed = 1;
+    int hands = 1;
+    std::string background;
+};
+
+const sf::Time Step = sf::seconds(1.0f / 60.0f);
+
+// Frames between two size changes in the resize scenario.
+const int ResizeInterval = 4;
+
+// One hand of the table script: a key, then the frames until the next one.
+// The deal and the draw get long enough for their cards to land (0.76 s for
+// five dealt cards, 0.34 s for three drawn at 60 Hz); a D sooner would only
+// fast-forward the deal and the hand would never be drawn.
+struct ScriptStep {
+    sf::Keyboard::Key key;
+    int frames;
+};
+
+const ScriptStep TableScript[] = {
+    { sf::Keyboard::B, 1 },
+    { sf::Keyboard::D, 48 },
+    { sf::Keyboard::Num1, 1 },
+    { sf::Keyboard::Num3, 1 },
+    { sf::Keyboard::D, 24 },
+    { sf::Keyboard::C, 3 }
+};
+
+// The key the table script presses on a frame, Unknown between keys.
+sf::Keyboard::Key tableScriptKey(int frame) {
+    int length = 0;
+    for (const ScriptStep& step : TableScript) {
+        length += step.frames;
+    }
+    int position = frame % length;
+    for (const ScriptStep& step : TableScript) {
+        if (position == 0) {
+            return step.key;
+        }
+        position -= step.frames;
+        if (position < 0) {
+            break;
+        }
+    }
+    return sf::Keyboard::Unknown;
+}
+
+struct FrameSample {
+    double updateMs;
+    double drawMs;
+    double totalMs;
+    unsigned drawCalls;
+    std::uint64_t allocations;
+};
+
+void printUsage() {
+    std::cout << "usage: softypoker-bench [options]\n"
+              << "  --scenario <intro-scroll|intro-resize|table-cycle>   default intro-scroll\n"
+              << "  --frames <n>       measured frames, default 600\n"
+              << "  --warmup <n>       frames run before measuring, default 60\n"
+              << "  --width <px>       target width, default 1280\n"
+              << "  --height <px>      target height, default 720\n"
+              << "  --seed <n>         table RNG seed, default 1\n"
+              << "  --hands <n>        hands played at once on the table, 1, 3, 10, 50 or 100, default 1\n"
+              << "  --background <name>  intro background, default the first one in the pack\n";
+}
+
+unsigned parseNumber(const std::string& value) {
+    std::size_t used = 0;
+    unsigned long number = std::stoul(value, &used);
+    if (used != value.size()) {
+        throw std::invalid_argument("not a number: " + value);
+    }
+    return static_cast<unsigned>(number);
+}
+
+Scenario parseScenario(const std::string& value) {
+    if (value == "intro-scroll") {
+        return Scenario::IntroScroll;
+    }
+    if (value == "intro-resize") {
+        return Scenario::IntroResize;
+    }
+    if (value == "table-cycle") {
+        return Scenario::TableCycle;
+    }
+    throw std::invalid_argument("unknown scenario: " + value);
+}
+
+const char* scenarioName(Scenario scenario) {
+    switch (scenario) {
+    case Scenario::IntroScroll:
+        return "intro-scroll";
+    case Scenario::IntroResize:
+        return "intro-resize";
+    case Scenario::TableCycle:
+        return "table-cycle";
+    }
+    return "";
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(arg + " needs a value");
+            }
+            return argv[++i];
+        };
+        if (arg == "--scenario") {
+            options.scenario = parseScenario(value());
+        } else if (arg == "--frames") {
+            options.frames = std::max(1u, parseNumber(value()));
+        } else if (arg == "--warmup") {
+            options.warmup = parseNumber(value());
+        } else if (arg == "--width") {
+            options.width = std::max(64u, parseNumber(value()));
+        } else if (arg == "--height") {
+            options.height = std::max(64u, parseNumber(value()));
+        } else if (arg == "--seed") {
+            options.seed = parseNumber(value());
+        } else if (arg == "--hands") {
+            options.hands = static_cast<int>(parseNumber(value()));
+            if (!isHandCount(options.hands)) {
+                throw std::invalid_argument("--hands must be 1, 3, 10, 50 or 100");
+            }
+        } else if (arg == "--background") {
+            options.background = value();
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("unknown option: " + arg);
+        }
+    }
+    return options;
+}
+
+// Same assets IntroState::requestAssets asks for, minus music and sound
+// effects, and with a fixed background so runs are comparable.
+IntroAssets loadIntroAssets(const Options& options) {
+    IntroAssets assets;
+    assets.backgroundName = options.background;
+    if (assets.backgroundName.empty()) {
+        std::vector<std::string> backgrounds = listAssets("images/backgrounds/");
+        if (backgrounds.empty()) {
+            throw std::runtime_error("No background images found");
+        }
+        assets.backgroundName = backgrounds.front();
+    }
+
+    AssetLoader loader;
+    sf::Vector2u displaySize(options.width, options.height);
+    assets.background = loader.loadTexture(assets.backgroundName, true, displaySize);
+    assets.logo = loader.loadTexture("images/logo.png", true, sf::Vector2u(displaySize.x / 5, displaySize.y / 5));
+    assets.font = loader.loadFont("fonts/arialnbi.ttf");
+    while (!loader.isIdle()) {
+        loader.uploadPending(sf::milliseconds(100));
+    }
+    return assets;
+}
+
+std::unique_ptr<sf::RenderTexture> createTarget(unsigned width, unsigned height) {
+    auto target = std::make_unique<sf::RenderTexture>();
+    if (!target->create(width, height)) {
+        throw std::runtime_error("Failed to create a " + std::to_string(width) + "x" + std::to_string(height) + " render texture");
+    }
+    return target;
+}
+
+sf::Event keyPressed(sf::Keyboard::Key key) {
+    sf::Event event;
+    event.type = sf::Event::KeyPressed;
+    event.key.code = key;
+    event.key.alt = false;
+    event.key.control = false;
+    event.key.shift = false;
+    event.key.system = false;
+    return event;
+}
+
+sf::Event resized(sf::Vector2u size) {
+    sf::Event event;
+    event.type = sf::Event::Resized;
+    event.size.width = size.x;
+    event.size.height = size.y;
+    return event;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double percentile(std::vector<double> values, double fraction) {
+    std::sort(values.begin(), values.end());
+    std::size_t index = static_cast<std::size_t>(fraction * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+void printReport(const Options& options, const std::vector<FrameSample>& samples) {
+    std::vector<double> update, draw, total;
+    double drawCalls = 0.0;
+    double allocations = 0.0;
+    std::uint64_t maxAllocations = 0;
+    for (const FrameSample& sample : samples) {
+        update.push_back(sample.updateMs);
+        draw.push_back(sample.drawMs);
+        total.push_back(sample.totalMs);
+        drawCalls += sample.drawCalls;
+        allocations += sample.allocations;
+        maxAllocations = std::max(maxAllocations, sample.allocations);
+    }
+    double count = static_cast<double>(samples.size());
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "scenario      " << scenarioName(options.scenario) << " at " << options.width << "x" << options.height
+              << ", " << samples.size() << " frames after " << options.warmup << " warm-up\n";
+    std::cout << "                  p50        p99        max\n";
+    auto row = [](const char* name, const std::vector<double>& values) {
+        std::cout << name << std::setw(8) << percentile(values, 0.50) << " ms"
+                  << std::setw(8) << percentile(values, 0.99) << " ms"
+                  << std::setw(8) << percentile(values, 1.0) << " ms\n";
+    };
+    row("update      ", update);
+    row("draw+finish ", draw);
+    row("frame       ", total);
+    std::cout << std::setprecision(1)
+              << "draw calls    " << drawCalls / count << " per frame\n"
+              << "allocations   " << allocations / count << " per frame, at most " << maxAllocations << "\n"
+              << "textures      " << Profiler::getFrameStats().textureBytes / (1024.0 * 1024.0) << " MB resident at the end\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "[Error] " << e.what() << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    try {
+        std::vector<std::unique_ptr<sf::RenderTexture>> targets;
+        targets.push_back(createTarget(options.width, options.height));
+        if (options.scenario == Scenario::IntroResize) {
+            // Cycle through a smaller, a larger and a differently shaped target
+            targets.push_back(createTarget(options.width * 2 / 3, options.height * 2 / 3));
+            targets.push_back(createTarget(options.width * 3 / 2, options.height * 3 / 2));
+            targets.push_back(createTarget(options.width, options.width * 3 / 4));
+        }
+
+        SoundManager soundPlayer;
+        std::unique_ptr<GameState> state;
+        if (options.scenario == Scenario::TableCycle) {
+            std::vector<std::string> backgrounds = listAssets("images/backgrounds/");
+            std::string background = !options.background.empty() ? options.background
+                                   : !backgrounds.empty() ? backgrounds.front() : std::string();
+            auto table = std::make_unique<MainGameState>(soundPlayer, *targets[0], background, options.seed,
+                                                         GameVariant::standard(), options.hands);
+            table->setKeepSession(false);
+            state = std::move(table);
+        } else {
+            state = std::make_unique<IntroState>(soundPlayer, *targets[0], loadIntroAssets(options), nullptr);
+        }
+
+        state->onEnter();
+
+        std::vector<FrameSample> samples;
+        samples.reserve(options.frames);
+        std::size_t targetIndex = 0;
+        const int totalFrames = options.warmup + options.frames;
+        for (int frame = 0; frame < totalFrames; ++frame) {
+            std::uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+            auto frameStart = std::chrono::steady_clock::now();
+
+            if (options.scenario == Scenario::IntroResize && frame % ResizeInterval == 0) {
+                targetIndex = (targetIndex + 1) % targets.size();
+                sf::Event event = resized(targets[targetIndex]->getSize());
+                state->handleEvent(event, *targets[targetIndex]);
+            } else if (options.scenario == Scenario::TableCycle) {
+                sf::Keyboard::Key key = tableScriptKey(frame);
+                if (key != sf::Keyboard::Unknown) {
+                    sf::Event event = keyPressed(key);
+                    state->handleEvent(event, *targets[targetIndex]);
+                }
+            }
+            sf::RenderTexture& target = *targets[targetIndex];
+
+            state->update(target, Step);
+            double updateMs = millisecondsSince(frameStart);
+
+            // glFinish makes the GPU's share of the frame show up in the timing
+            auto drawStart = std::chrono::steady_clock::now();
+            state->draw(target);
+            target.display();
+            glFinish();
+            double drawMs = millisecondsSince(drawStart);
+            double totalMs = millisecondsSince(frameStart);
+
+            Profiler::endFrame(sf::microseconds(static_cast<sf::Int64>(totalMs * 1000.0)));
+            std::uint64_t allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+            if (frame >= options.warmup) {
+                samples.push_back(FrameSample{ updateMs, drawMs, totalMs, Profiler::getFrameStats().drawCalls, allocations });
+            }
+        }
+
+        printReport(options, samples);
+        // Cached textures go while the targets' GL contexts are still there
+        resourceCache().clear();
+    } catch (const std::exception& e) {
+        std::cerr << "[Error] " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
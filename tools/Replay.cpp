@@ -0,0 +1,365 @@
+// Headless session verifier.
+// Replays recorded table sessions (.sps files, see Session.h) against the
+// rules in this build as fast as they run, spread over every core, and lists
+// the ones whose outcome no longer matches the recording. --generate writes a
+// corpus of scripted sessions to verify later builds against. --crash-journal
+// and --journal check crash recovery: the first plays scripted rounds into a
+// journal and stops without closing it, the second recovers a journal and
+// checks the result against replaying the whole session.
+
+#include "Journal.h"
+#include "Log.h"
+#include "Random.h"
+#include "Session.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SoftyPoker;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t generate = 0;
+    std::uint64_t crashRounds = 0;
+    bool journal = false;
+    std::uint64_t seed = 1;
+    const GameVariant* variant = &GameVariant::standard();
+    int hands = 1;
+    std::string output;
+    std::vector<std::string> inputs;
+};
+
+enum class Outcome {
+    Matches,
+    Diverged,
+    Unreadable
+};
+
+void printUsage() {
+    std::cout << "usage: softypoker-replay [--threads <n>] <session-file-or-dir>...\n"
+              << "       softypoker-replay --generate <count> [--seed <n>] [--variant <name>] [--hands <n>] <output-dir>\n"
+              << "       softypoker-replay --crash-journal <rounds> [--seed <n>] [--variant <name>] [--hands <n>] <journal>\n"
+              << "       softypoker-replay --journal <journal>\n"
+              << "  --threads <n>    replay on n threads, default one per core\n"
+              << "  --generate <n>   write n scripted sessions instead of replaying\n"
+              << "  --seed <n>       seed for --generate, default 1\n"
+              << "  --variant <name> game for --generate: jacks-or-better (default), deuces-wild, joker-poker\n"
+              << "  --hands <n>      hands per round for --generate, 1, 3, 10, 50 or 100, default 1\n"
+              << "  --crash-journal <n>  journal n scripted rounds and stop as if the machine had crashed\n"
+              << "  --journal        recover a journal and check it against a full replay\n";
+}
+
+std::uint64_t parseNumber(const std::string& value) {
+    std::size_t used = 0;
+    unsigned long long number = std::stoull(value, &used);
+    if (used != value.size()) {
+        throw std::invalid_argument("not a number: " + value);
+    }
+    return number;
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(arg + " needs a value");
+            }
+            return argv[++i];
+        };
+        if (arg == "--threads") {
+            options.threads = std::max<unsigned>(1, static_cast<unsigned>(parseNumber(value())));
+        } else if (arg == "--generate") {
+            options.generate = parseNumber(value());
+        } else if (arg == "--crash-journal") {
+            options.crashRounds = parseNumber(value());
+        } else if (arg == "--journal") {
+            options.journal = true;
+        } else if (arg == "--seed") {
+            options.seed = parseNumber(value());
+        } else if (arg == "--variant") {
+            std::string name = value();
+            options.variant = GameVariant::find(name);
+            if (!options.variant) {
+                throw std::invalid_argument("unknown variant: " + name);
+            }
+        } else if (arg == "--hands") {
+            options.hands = static_cast<int>(parseNumber(value()));
+            if (!isHandCount(options.hands)) {
+                throw std::invalid_argument("--hands must be 1, 3, 10, 50 or 100");
+            }
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    if (options.generate > 0) {
+        if (options.inputs.size() != 1) {
+            throw std::invalid_argument("--generate needs exactly one output directory");
+        }
+        options.output = options.inputs.front();
+        options.inputs.clear();
+    } else if (options.crashRounds > 0 || options.journal) {
+        if (options.inputs.size() != 1) {
+            throw std::invalid_argument("give exactly one journal file");
+        }
+    } else if (options.inputs.empty()) {
+        throw std::invalid_argument("no session files given");
+    }
+    return options;
+}
+
+// Expands directories into the .sps files below them, sorted so reports are stable.
+std::vector<std::string> collectFiles(const std::vector<std::string>& inputs) {
+    std::vector<std::string> files;
+    for (const std::string& input : inputs) {
+        std::error_code error;
+        if (!fs::is_directory(input, error)) {
+            files.push_back(input);
+            continue;
+        }
+        for (fs::recursive_directory_iterator it(input, error), end; !error && it != end; it.increment(error)) {
+            if (it->is_regular_file() && it->path().extension() == ".sps") {
+                files.push_back(it->path().generic_string());
+            }
+        }
+        if (error) {
+            throw std::runtime_error("cannot read " + input + ": " + error.message());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// Plays a round the way a player might: a random bet, random holds, and
+// now and then a double-up. run carries out one command.
+template <typename Run>
+void scriptRound(const PokerGame& game, CounterRng& script, Run run) {
+    int bets = 1 + static_cast<int>(script.uniform(5));
+    for (int i = 0; i < bets; ++i) {
+        run(Command::Bet);
+    }
+    run(Command::Deal);
+    for (int card = 0; card < 5; ++card) {
+        if (script.uniform(2)) {
+            run(static_cast<Command>(static_cast<int>(Command::Hold1) + card));
+        }
+    }
+    run(Command::Deal);
+    if (game.getPhase() == GamePhase::Won) {
+        if (script.uniform(3) == 0) {
+            run(Command::Double);
+            run(script.uniform(2) ? Command::High : Command::Low);
+        }
+        run(Command::Collect);
+    }
+}
+
+// A session of scripted rounds with a few idle ticks between commands.
+SessionLog scriptSession(std::uint64_t seed, CounterRng& script, const GameVariant& variant, int hands) {
+    // Enough for about as many rounds at any hand count
+    const int startingCredits = 20 * hands;
+    PokerGame game(CounterRng(seed), startingCredits, variant);
+    game.setHandCount(hands);
+    SessionRecorder recorder(seed, startingCredits, variant.id, hands);
+    std::uint32_t tick = 0;
+    GambleResult gambleResult = GambleResult::Push;
+
+    auto run = [&](Command command) {
+        tick += 1 + script.uniform(30);
+        if (applyCommand(game, command, gambleResult)) {
+            recorder.record(tick, command, game);
+        }
+    };
+
+    int rounds = 20 + static_cast<int>(script.uniform(200));
+    for (int round = 0; round < rounds && (game.getCredits() > 0 || game.getBet() > 0); ++round) {
+        scriptRound(game, script, run);
+    }
+    recorder.finish(tick + 60, game);
+    return recorder.getLog();
+}
+
+int generate(const Options& options) {
+    std::error_code error;
+    fs::create_directories(options.output, error);
+    if (error) {
+        std::cerr << "[Error] cannot create " << options.output << ": " << error.message() << std::endl;
+        return 1;
+    }
+    for (std::uint64_t i = 0; i < options.generate; ++i) {
+        CounterRng script(options.seed, i);
+        std::uint64_t seed = script.next();
+        SessionLog log = scriptSession(seed, script, *options.variant, options.hands);
+        std::ostringstream path;
+        path << options.output << "/session-" << std::setw(6) << std::setfill('0') << i << ".sps";
+        if (!saveSession(log, path.str())) {
+            std::cerr << "[Error] cannot write " << path.str() << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "wrote " << options.generate << " sessions to " << options.output << "\n";
+    return 0;
+}
+
+int crashJournal(const Options& options) {
+    const std::string& path = options.inputs.front();
+    CounterRng script(options.seed, 0);
+    std::uint64_t seed = script.next();
+    // Credits for every round at the top bet, so the session never runs dry
+    const int startingCredits = static_cast<int>(std::min<std::uint64_t>(options.crashRounds * MaxBet * options.hands, 1u << 30));
+    PokerGame game(CounterRng(seed), startingCredits, *options.variant);
+    game.setHandCount(options.hands);
+    SessionRecorder recorder(seed, startingCredits, options.variant->id, options.hands);
+    Journal journal;
+    if (!journal.start(path, recorder.getLog())) {
+        return 1;
+    }
+
+    std::uint32_t tick = 0;
+    GambleResult gambleResult = GambleResult::Push;
+    auto run = [&](Command command) {
+        tick += 1 + script.uniform(30);
+        if (applyCommand(game, command, gambleResult)) {
+            recorder.record(tick, command, game);
+            journal.recordCommand(tick, command, game, recorder.getLog().digest);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t round = 0; round < options.crashRounds; ++round) {
+        scriptRound(game, script, run);
+    }
+    // Mid-round, so recovery has a hand on the table to bring back
+    run(Command::Bet);
+    run(Command::Deal);
+    journal.flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // No finish(): the journal is left as a crash would leave it
+    std::cout << "journaled " << options.crashRounds << " rounds, " << recorder.getLog().events.size()
+              << " commands in " << std::fixed << std::setprecision(3) << seconds << " s, "
+              << game.getCredits() << " credits on the meter\n";
+    return 0;
+}
+
+int checkJournal(const Options& options) {
+    const std::string& path = options.inputs.front();
+    JournalRecovery recovery;
+    auto start = std::chrono::steady_clock::now();
+    bool recovered = recoverJournal(path, recovery);
+    // Recovery reports through the log; keep its lines ahead of ours
+    Log::flush();
+    if (!recovered) {
+        std::cout << "nothing to recover in " << path << "\n";
+        return 2;
+    }
+    double recoverMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // The whole session from its first command must come out the same
+    start = std::chrono::steady_clock::now();
+    SessionLog log = recovery.log;
+    log.finalCredits = recovery.game.getCredits();
+    ReplayResult full = replaySession(log);
+    double replayMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(1) << "recovered " << recovery.log.events.size() << " commands ("
+              << recovery.replayed << " replayed after the snapshot) in " << recoverMs << " ms, full replay "
+              << replayMs << " ms: " << (full.matches ? "matches" : "DIVERGED") << ", "
+              << recovery.game.getCredits() << " credits\n";
+    return full.matches ? 0 : 2;
+}
+
+int verify(const Options& options) {
+    std::vector<std::string> files = collectFiles(options.inputs);
+    std::vector<Outcome> outcomes(files.size(), Outcome::Unreadable);
+    std::atomic<std::uint64_t> commands(0);
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        WorkStealingPool pool(options.threads);
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::size_t remaining = files.size();
+
+        // One task per file, so reading the files overlaps with replaying them
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            pool.submit([&, i]() {
+                SessionLog log;
+                if (loadSession(files[i], log)) {
+                    outcomes[i] = replaySession(log).matches ? Outcome::Matches : Outcome::Diverged;
+                    commands.fetch_add(log.events.size(), std::memory_order_relaxed);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--remaining == 0) {
+                    finished.notify_one();
+                }
+            });
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&]() { return remaining == 0; });
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t diverged = 0;
+    std::size_t unreadable = 0;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        if (outcomes[i] == Outcome::Diverged) {
+            std::cout << "DIVERGED   " << files[i] << "\n";
+            ++diverged;
+        } else if (outcomes[i] == Outcome::Unreadable) {
+            std::cout << "UNREADABLE " << files[i] << "\n";
+            ++unreadable;
+        }
+    }
+    std::cout << files.size() << " sessions, " << commands.load() << " commands replayed on "
+              << options.threads << " threads in " << std::fixed << std::setprecision(3) << seconds << " s: "
+              << files.size() - diverged - unreadable << " match, " << diverged << " diverged, "
+              << unreadable << " unreadable\n";
+    return diverged == 0 && unreadable == 0 ? 0 : 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "[Error] " << e.what() << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    try {
+        if (options.crashRounds > 0) {
+            return crashJournal(options);
+        }
+        if (options.journal) {
+            return checkJournal(options);
+        }
+        return options.generate > 0 ? generate(options) : verify(options);
+    } catch (const std::exception& e) {
+        std::cerr << "[Error] " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,163 @@
+// Headless table server.
+// Hosts thousands of independent table sessions for remote clients over
+// TCP, sharded over one event loop per core (see GameServer.h and
+// ServerProtocol.h), and prints the sessions and actions of every loop as
+// it goes. softypoker-load drives it with simulated players.
+
+#include "GameServer.h"
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SoftyPoker;
+
+namespace {
+
+struct Options {
+    ServerOptions server;
+    double reportSeconds = 5.0;
+    double runSeconds = 0.0;      // 0 runs until interrupted
+};
+
+volatile std::sig_atomic_t interrupted = 0;
+
+void onSignal(int) {
+    interrupted = 1;
+}
+
+void printUsage() {
+    std::cout << "usage: softypoker-server [--port <n>] [--shards <n>] [--credits <n>] [--seed <n>] [--public]\n"
+              << "                         [--report <seconds>] [--seconds <n>]\n"
+              << "  --port <n>       TCP port, default " << DefaultServerPort << "\n"
+              << "  --shards <n>     event loops, default one per core\n"
+              << "  --credits <n>    starting credits per hand of a session, default 20\n"
+              << "  --seed <n>       seed the session seeds are drawn from, default random\n"
+              << "  --public         listen on every interface, not just localhost\n"
+              << "  --report <s>     seconds between status lines, default 5\n"
+              << "  --seconds <n>    stop after n seconds instead of on Ctrl+C\n";
+}
+
+std::uint64_t parseNumber(const std::string& value) {
+    std::size_t used = 0;
+    unsigned long long number = std::stoull(value, &used);
+    if (used != value.size()) {
+        throw std::invalid_argument("not a number: " + value);
+    }
+    return number;
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(arg + " needs a value");
+            }
+            return argv[++i];
+        };
+        if (arg == "--port") {
+            std::uint64_t port = parseNumber(value());
+            if (port == 0 || port > 65535) {
+                throw std::invalid_argument("--port must be 1 to 65535");
+            }
+            options.server.port = static_cast<std::uint16_t>(port);
+        } else if (arg == "--shards") {
+            options.server.shards = std::max<unsigned>(1, static_cast<unsigned>(parseNumber(value())));
+        } else if (arg == "--credits") {
+            options.server.startingCredits = static_cast<int>(std::min<std::uint64_t>(parseNumber(value()), 1000000));
+        } else if (arg == "--seed") {
+            options.server.seed = parseNumber(value());
+        } else if (arg == "--public") {
+            options.server.loopbackOnly = false;
+        } else if (arg == "--report") {
+            options.reportSeconds = std::max(0.1, std::stod(value()));
+        } else if (arg == "--seconds") {
+            options.runSeconds = std::stod(value());
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("unknown option: " + arg);
+        }
+    }
+    return options;
+}
+
+void printStatus(const std::vector<ShardStats>& stats, std::uint64_t actionsBefore, double seconds) {
+    std::uint64_t sessions = 0;
+    std::uint64_t actions = 0;
+    for (const ShardStats& shard : stats) {
+        sessions += shard.sessions;
+        actions += shard.actions;
+    }
+    std::cout << std::fixed << std::setprecision(0)
+              << "sessions " << sessions << " (per loop";
+    for (const ShardStats& shard : stats) {
+        std::cout << " " << shard.sessions;
+    }
+    std::cout << ")  actions/s " << (actions - actionsBefore) / seconds << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "[Error] " << e.what() << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    GameServer server(options.server);
+    if (!server.start()) {
+        Log::flush();
+        return 1;
+    }
+    std::cout << "listening on port " << options.server.port << " with " << server.getShardCount() << " event loops" << std::endl;
+
+    auto started = std::chrono::steady_clock::now();
+    auto lastReport = started;
+    std::uint64_t lastActions = 0;
+    while (!interrupted) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = std::chrono::steady_clock::now();
+        if (options.runSeconds > 0 && std::chrono::duration<double>(now - started).count() >= options.runSeconds) {
+            break;
+        }
+        double sinceReport = std::chrono::duration<double>(now - lastReport).count();
+        if (sinceReport >= options.reportSeconds) {
+            std::vector<ShardStats> stats = server.getStats();
+            printStatus(stats, lastActions, sinceReport);
+            lastActions = 0;
+            for (const ShardStats& shard : stats) {
+                lastActions += shard.actions;
+            }
+            lastReport = now;
+        }
+    }
+
+    server.stop();
+    std::uint64_t opened = 0;
+    std::uint64_t actions = 0;
+    for (const ShardStats& shard : server.getStats()) {
+        opened += shard.sessionsOpened;
+        actions += shard.actions;
+    }
+    std::cout << "served " << opened << " sessions, " << actions << " actions" << std::endl;
+    return 0;
+}
@@ -0,0 +1,676 @@
+// Headless RTP / volatility simulator.
+// Plays hands through the same PokerGame rules the machine uses, one game and
+// one RNG stream per thread, and merges per-thread totals once at the end.
+
+#include "Deck.h"
+#include "GameVariant.h"
+#include "HandEvaluator.h"
+#include "HoldAdvisor.h"
+#include "HoldStrategy.h"
+#include "MultiHand.h"
+#include "PokerGame.h"
+#include "PrizeTable.h"
+#include "Random.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SoftyPoker;
+
+namespace {
+
+enum class Strategy {
+    Basic,
+    Optimal,
+    DrawAll,
+    StandPat
+};
+
+struct Options {
+    std::uint64_t hands = 100000000;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t seed = 1;
+    Strategy strategy = Strategy::Basic;
+    int bet = MaxBet;
+    int multi = 1;
+    const GameVariant* variant = &GameVariant::standard();
+    Paytable paytable = PrizeTable::standard();
+    bool bench = false;
+    std::uint64_t shuffleTest = 0;
+    bool verifyEvaluator = false;
+};
+
+// Padded so that threads never share a cache line while counting.
+struct alignas(64) ThreadStats {
+    std::uint64_t rounds = 0;
+    std::uint64_t hands = 0;
+    std::uint64_t wagered = 0;
+    std::uint64_t won = 0;
+    double wonSquared = 0.0;       // per round
+    std::uint64_t hits[NumPrizes] = {};
+};
+
+// Threads look at the clock every ProgressCheck rounds (every round with the
+// slow optimal strategy) and add their rounds to the progress count when
+// ProgressInterval has passed.
+constexpr std::uint64_t ProgressCheck = 1 << 10;
+constexpr auto ProgressInterval = std::chrono::milliseconds(250);
+
+void printUsage() {
+    std::cout << "usage: softypoker-sim [--hands N] [--threads N] [--seed N] [--bet 1-5] [--multi 1|3|10|50|100]\n"
+                 "                      [--variant jacks-or-better|deuces-wild|joker-poker]\n"
+                 "                      [--strategy basic|optimal|drawall|pat]\n"
+                 "                      [--pays N,N,...] [--royal-bonus N] [--bench] [--shuffle-test DEALS]\n"
+                 "                      [--verify-evaluator]\n"
+                 "  --pays lists the variant's prize rows lowest first, e.g. for jacks-or-better\n"
+                 "  jacks,twopair,trips,straight,flush,fullhouse,quads,sflush,royal\n"
+                 "  basic strategy is a Jacks or Better chart; other variants need optimal, drawall or pat\n"
+                 "  --multi plays that many hands per round from one held hand, --hands counts all of them\n";
+}
+
+std::uint64_t parseNumber(const std::string& value) {
+    std::size_t used = 0;
+    double number = std::stod(value, &used);
+    if (used != value.size() || number < 0) {
+        throw std::runtime_error("Invalid number: " + value);
+    }
+    return static_cast<std::uint64_t>(number);
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    std::string pays;
+    std::string royalBonus;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--hands") {
+            options.hands = parseNumber(value());
+        } else if (arg == "--threads") {
+            options.threads = std::max<unsigned>(1, static_cast<unsigned>(parseNumber(value())));
+        } else if (arg == "--seed") {
+            options.seed = parseNumber(value());
+        } else if (arg == "--bet") {
+            options.bet = static_cast<int>(parseNumber(value()));
+            if (options.bet < 1 || options.bet > MaxBet) {
+                throw std::runtime_error("Bet must be between 1 and 5");
+            }
+        } else if (arg == "--multi") {
+            options.multi = static_cast<int>(parseNumber(value()));
+            if (!isHandCount(options.multi)) {
+                throw std::runtime_error("--multi must be 1, 3, 10, 50 or 100");
+            }
+        } else if (arg == "--variant") {
+            std::string name = value();
+            options.variant = GameVariant::find(name);
+            if (!options.variant) {
+                throw std::runtime_error("Unknown variant: " + name);
+            }
+        } else if (arg == "--strategy") {
+            std::string name = value();
+            if (name == "basic") {
+                options.strategy = Strategy::Basic;
+            } else if (name == "optimal") {
+                options.strategy = Strategy::Optimal;
+            } else if (name == "drawall") {
+                options.strategy = Strategy::DrawAll;
+            } else if (name == "pat") {
+                options.strategy = Strategy::StandPat;
+            } else {
+                throw std::runtime_error("Unknown strategy: " + name);
+            }
+        } else if (arg == "--pays") {
+            pays = value();
+        } else if (arg == "--royal-bonus") {
+            royalBonus = value();
+        } else if (arg == "--bench") {
+            options.bench = true;
+        } else if (arg == "--shuffle-test") {
+            options.shuffleTest = parseNumber(value());
+        } else if (arg == "--verify-evaluator") {
+            options.verifyEvaluator = true;
+        } else {
+            printUsage();
+            throw std::runtime_error("Unknown option: " + arg);
+        }
+    }
+
+    // The paytable options change the chosen variant's table, whatever order they came in
+    const VariantRules& rules = options.variant->rules;
+    options.paytable = rules.paytable;
+    if (!pays.empty()) {
+        std::stringstream list(pays);
+        std::string item;
+        for (int row = 0; row < rules.ladderRows; ++row) {
+            if (!std::getline(list, item, ',')) {
+                throw std::runtime_error("--pays needs one value per prize row");
+            }
+            options.paytable.multiplier[static_cast<int>(rules.ladder[row])] = static_cast<int>(parseNumber(item));
+        }
+    }
+    if (!royalBonus.empty()) {
+        options.paytable.maxBetRoyalFlush = static_cast<int>(parseNumber(royalBonus));
+    }
+    if (options.strategy == Strategy::Basic && options.variant->id != VariantId::JacksOrBetter) {
+        throw std::runtime_error(std::string("Basic strategy is a Jacks or Better chart; use --strategy optimal for ")
+                                 + options.variant->title);
+    }
+    return options;
+}
+
+void simulate(const Options& options, std::uint64_t rounds, unsigned stream, HoldAdvisor* advisor,
+              ThreadStats& stats, std::atomic<std::uint64_t>& progress) {
+    PokerGame game(CounterRng(options.seed, stream), 0, *options.variant, options.paytable);
+    game.setHandCount(options.multi);
+    ThreadStats local;
+    const std::uint64_t progressCheck = options.strategy == Strategy::Optimal ? 1 : ProgressCheck;
+    std::uint64_t published = 0;
+    auto lastPublished = std::chrono::steady_clock::now();
+
+    for (std::uint64_t played = 0; played < rounds; ++played) {
+        game.insertCredits(options.bet * options.multi);
+        for (int i = 0; i < options.bet; ++i) {
+            game.bet();
+        }
+        game.deal();
+
+        int hold = 0;
+        switch (options.strategy) {
+        case Strategy::Basic:
+            hold = basicStrategyHold(game.getHand());
+            break;
+        case Strategy::Optimal:
+            hold = advisor->solve(game.getHand(), options.bet).bestHold;
+            break;
+        case Strategy::DrawAll:
+            hold = 0;
+            break;
+        case Strategy::StandPat:
+            hold = 0x1F;
+            break;
+        }
+        for (int i = 0; i < 5; ++i) {
+            if (hold & (1 << i)) {
+                game.toggleHold(i);
+            }
+        }
+        game.deal();
+
+        int win = game.getWin();
+        if (options.multi == 1) {
+            ++local.hits[static_cast<int>(game.getPrize())];
+        } else {
+            const MultiHand& hands = game.getHands();
+            for (int hand = 0; hand < options.multi; ++hand) {
+                ++local.hits[static_cast<int>(hands.getPrize(hand))];
+            }
+        }
+        local.won += win;
+        local.wonSquared += static_cast<double>(win) * win;
+        game.collect();
+        game.cashOut();
+
+        if ((played + 1) % progressCheck == 0) {
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastPublished >= ProgressInterval) {
+                progress.fetch_add((played + 1 - published) * options.multi, std::memory_order_relaxed);
+                published = played + 1;
+                lastPublished = now;
+            }
+        }
+    }
+
+    local.rounds = rounds;
+    local.hands = rounds * options.multi;
+    local.wagered = local.hands * options.bet;
+    stats = local;
+}
+
+void runBenchmark() {
+    const int deals = 1 << 24;
+    Deck deck;
+    CounterRng rng(1);
+    std::uint64_t dealtChecksum = 0;
+    auto dealStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < deals; ++i) {
+        deck.reset();
+        for (int card = 0; card < 10; ++card) {
+            dealtChecksum += deck.draw(rng);
+        }
+    }
+    double dealSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - dealStart).count();
+    std::cout << "Deck: " << std::fixed << std::setprecision(2) << deals / dealSeconds / 1e6
+              << " M deals/s of 5 cards + 5 draws (checksum " << dealtChecksum << ")\n";
+
+    std::vector<Card> hands;
+    PokerGame game(CounterRng(1), 0);
+    for (int i = 0; i < 1 << 20; ++i) {
+        game.insertCredits(1);
+        game.bet();
+        game.deal();
+        hands.insert(hands.end(), game.getHand().begin(), game.getHand().end());
+        game.deal();
+        game.collect();
+        game.cashOut();
+    }
+
+    const int passes = 50;
+    std::uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (std::size_t i = 0; i < hands.size(); i += 5) {
+            checksum += HandEvaluator::evaluate(&hands[i]);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double evaluations = static_cast<double>(passes) * (hands.size() / 5);
+
+    std::cout << "HandEvaluator: " << std::fixed << std::setprecision(2)
+              << seconds * 1e9 / evaluations << " ns/hand, "
+              << evaluations / seconds / 1e6 << " M hands/s (checksum " << checksum << ")\n";
+
+    // Prize evaluation per variant, each on hands from its own deck. The
+    // variants take turns over many short rounds on cache-resident hands and
+    // each keeps its fastest round, so a busy machine slows no variant alone.
+    const int variantHandCount = 1 << 16;
+    const int variantRounds = 400;
+    std::vector<std::vector<Card>> variantHands(NumVariants);
+    for (int id = 0; id < NumVariants; ++id) {
+        const GameVariant& variant = GameVariant::get(static_cast<VariantId>(id));
+        variantHands[id].reserve(5 * variantHandCount);
+        Deck variantDeck(variant.rules.deckSize);
+        CounterRng dealRng(2);
+        for (int i = 0; i < variantHandCount; ++i) {
+            variantDeck.reset();
+            for (int card = 0; card < 5; ++card) {
+                variantHands[id].push_back(variantDeck.draw(dealRng));
+            }
+        }
+    }
+
+    std::vector<double> bestSeconds(NumVariants, 1e9);
+    std::vector<std::uint64_t> prizeChecksums(NumVariants, 0);
+    for (int round = 0; round < variantRounds; ++round) {
+        for (int id = 0; id < NumVariants; ++id) {
+            const std::vector<Card>& roundHands = variantHands[id];
+            std::uint64_t roundChecksum = 0;
+            auto roundStart = std::chrono::steady_clock::now();
+            visitVariant(static_cast<VariantId>(id), [&](auto evaluator) {
+                using Evaluator = decltype(evaluator);
+                for (std::size_t i = 0; i < roundHands.size(); i += 5) {
+                    roundChecksum += static_cast<int>(Evaluator::evaluate(&roundHands[i]));
+                }
+            });
+            bestSeconds[id] = std::min(bestSeconds[id],
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - roundStart).count());
+            prizeChecksums[id] += roundChecksum;
+        }
+    }
+
+    const double plainNs = bestSeconds[0] * 1e9 / variantHandCount;
+    for (int id = 0; id < NumVariants; ++id) {
+        const GameVariant& variant = GameVariant::get(static_cast<VariantId>(id));
+        double ns = bestSeconds[id] * 1e9 / variantHandCount;
+        std::cout << std::left << std::setw(17) << (std::string(variant.title) + ":") << std::right
+                  << std::setprecision(2) << ns << " ns/hand, " << ns / plainNs << "x Jacks or Better"
+                  << " (checksum " << prizeChecksums[id] << ")\n";
+    }
+
+    // Hundred Play rounds: two cards held, 100 hands drawing from their own
+    // copies of the deck and evaluated together, on every kernel the CPU has
+    const HandKernel detected = activeHandKernel();
+    const int rounds = 20000;
+    for (int id = 0; id < NumVariants; ++id) {
+        const GameVariant& variant = GameVariant::get(static_cast<VariantId>(id));
+        for (HandKernel kernel : { HandKernel::Scalar, HandKernel::Sse41, HandKernel::Avx2 }) {
+            if (!handKernelSupported(kernel)) {
+                continue;
+            }
+            setHandKernel(kernel);
+            Deck deck(variant.rules.deckSize);
+            CounterRng roundRng(3);
+            MultiHand hands;
+            std::array<Card, 5> base;
+            std::uint64_t roundChecksum = 0;
+            auto roundStart = std::chrono::steady_clock::now();
+            for (int round = 0; round < rounds; ++round) {
+                deck.reset();
+                for (Card& card : base) {
+                    card = deck.draw(roundRng);
+                }
+                Deck remaining = deck;
+                hands.draw(base, 0x3, remaining, roundRng, MaxHands);
+                hands.evaluate(variant);
+                roundChecksum += static_cast<int>(hands.getPrize(round % MaxHands));
+            }
+            double roundSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - roundStart).count();
+
+            auto evaluateStart = std::chrono::steady_clock::now();
+            for (int round = 0; round < rounds; ++round) {
+                hands.evaluate(variant);
+                roundChecksum += static_cast<int>(hands.getPrize(round % MaxHands));
+            }
+            double evaluateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - evaluateStart).count();
+
+            std::cout << MaxHands << " hands, " << std::left << std::setw(17) << (std::string(variant.title) + ",")
+                      << std::setw(7) << handKernelName(kernel) << std::right << std::setprecision(2)
+                      << roundSeconds * 1e6 / rounds << " us per round, "
+                      << evaluateSeconds * 1e6 / rounds << " us of it evaluating (checksum " << roundChecksum << ")\n";
+        }
+    }
+    setHandKernel(detected);
+}
+
+// Chi-square of the card counts at each dealt position against a uniform
+// 1/52; a biased shuffle shows up as a tiny p-value at some position.
+void runShuffleTest(const Options& options) {
+    constexpr int Positions = 10;
+    using Counts = std::array<std::array<std::uint64_t, NumCards>, Positions>;
+    std::vector<Counts> counts(options.threads);
+    std::vector<std::thread> threads;
+
+    for (unsigned t = 0; t < options.threads; ++t) {
+        std::uint64_t share = options.shuffleTest / options.threads + (t < options.shuffleTest % options.threads ? 1 : 0);
+        threads.emplace_back([&options, &counts, share, t]() {
+            Counts local = {};
+            Deck deck;
+            CounterRng rng(options.seed, t);
+            for (std::uint64_t i = 0; i < share; ++i) {
+                deck.reset();
+                for (int position = 0; position < Positions; ++position) {
+                    ++local[position][deck.draw(rng)];
+                }
+            }
+            counts[t] = local;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const double degrees = NumCards - 1;
+    double expected = static_cast<double>(options.shuffleTest) / NumCards;
+    double lowestP = 1.0;
+    std::cout << "Shuffle uniformity over " << options.shuffleTest << " deals (chi-square, 51 dof)\n";
+    for (int position = 0; position < Positions; ++position) {
+        double chiSquare = 0.0;
+        for (int card = 0; card < NumCards; ++card) {
+            std::uint64_t observed = 0;
+            for (const Counts& c : counts) {
+                observed += c[position][card];
+            }
+            double delta = observed - expected;
+            chiSquare += delta * delta / expected;
+        }
+        // Wilson-Hilferty approximation of the upper tail
+        double z = (std::cbrt(chiSquare / degrees) - (1.0 - 2.0 / (9.0 * degrees))) / std::sqrt(2.0 / (9.0 * degrees));
+        double p = 0.5 * std::erfc(z / std::sqrt(2.0));
+        lowestP = std::min(lowestP, p);
+        std::cout << "  " << (position < 5 ? "deal " : "draw ") << position % 5 + 1 << ": chi2 "
+                  << std::fixed << std::setprecision(2) << std::setw(8) << chiSquare
+                  << "  p " << std::setprecision(4) << p << "\n";
+    }
+    // Ten positions are tested, so scale the threshold (Bonferroni).
+    bool passed = lowestP > 0.001 / Positions;
+    std::cout << (passed ? "PASS" : "FAIL") << " (lowest p " << lowestP << ")\n";
+}
+
+// Ranks a hand the slow way: ranks sorted by how often they occur, then by
+// rank, and checked for a flush and a straight. The result orders hands like
+// the evaluator, but higher is better: the category, then the ranks that
+// break ties, a nibble each.
+std::uint32_t naiveRank(const Card* cards, HandCategory& category) {
+    int counts[NumRanks] = {};
+    bool flush = true;
+    for (int i = 0; i < 5; ++i) {
+        ++counts[cardRank(cards[i])];
+        flush = flush && cardSuit(cards[i]) == cardSuit(cards[0]);
+    }
+    std::vector<std::pair<int, int>> groups;      // (count, rank)
+    for (int rank = NumRanks - 1; rank >= 0; --rank) {
+        if (counts[rank]) {
+            groups.emplace_back(counts[rank], rank);
+        }
+    }
+    std::stable_sort(groups.begin(), groups.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    int straightHigh = -1;
+    if (groups.size() == 5) {
+        if (groups[0].second - groups[4].second == 4) {
+            straightHigh = groups[0].second;
+        } else if (groups[0].second == 12 && groups[1].second == 3) {
+            straightHigh = 3;      // the wheel, A-2-3-4-5, is five high
+        }
+    }
+
+    if (straightHigh >= 0) {
+        category = flush ? HandCategory::StraightFlush : HandCategory::Straight;
+    } else if (flush) {
+        category = HandCategory::Flush;
+    } else if (groups[0].first == 4) {
+        category = HandCategory::FourOfAKind;
+    } else if (groups[0].first == 3) {
+        category = groups[1].first == 2 ? HandCategory::FullHouse : HandCategory::ThreeOfAKind;
+    } else if (groups[0].first == 2) {
+        category = groups[1].first == 2 ? HandCategory::TwoPair : HandCategory::OnePair;
+    } else {
+        category = HandCategory::HighCard;
+    }
+
+    std::uint32_t key = static_cast<std::uint32_t>(HandCategory::HighCard) - static_cast<std::uint32_t>(category);
+    if (straightHigh >= 0) {
+        return key << 20 | static_cast<std::uint32_t>(straightHigh) << 16;
+    }
+    for (int i = 0; i < 5; ++i) {
+        key = key << 4 | (i < static_cast<int>(groups.size()) ? static_cast<std::uint32_t>(groups[i].second) : 0);
+    }
+    return key;
+}
+
+std::string handName(const Card* cards) {
+    std::string name = cardName(cards[0]);
+    for (int i = 1; i < 5; ++i) {
+        name += " " + cardName(cards[i]);
+    }
+    return name;
+}
+
+// Ranks every 5-card hand with the evaluator and with naiveRank. Hands the
+// naive ranker calls equal must get the same evaluator rank, and the distinct
+// hands, strongest first, must be ranked 1 to 7462 in order.
+bool runEvaluatorCheck() {
+    std::map<std::uint32_t, std::uint16_t> rankOfKey;
+    std::uint64_t hands = 0;
+    std::uint64_t failures = 0;
+    auto fail = [&failures](const std::string& message) {
+        if (++failures <= 10) {
+            std::cout << "  " << message << "\n";
+        }
+    };
+
+    Card cards[5];
+    for (cards[0] = 0; cards[0] < NumCards; ++cards[0]) {
+        for (cards[1] = cards[0] + 1; cards[1] < NumCards; ++cards[1]) {
+            for (cards[2] = cards[1] + 1; cards[2] < NumCards; ++cards[2]) {
+                for (cards[3] = cards[2] + 1; cards[3] < NumCards; ++cards[3]) {
+                    for (cards[4] = cards[3] + 1; cards[4] < NumCards; ++cards[4]) {
+                        ++hands;
+                        HandCategory category;
+                        std::uint32_t key = naiveRank(cards, category);
+                        std::uint16_t rank = HandEvaluator::evaluate(cards);
+                        auto entry = rankOfKey.emplace(key, rank);
+                        if (entry.first->second != rank) {
+                            fail(handName(cards) + " ranked " + std::to_string(rank) + ", an equal hand "
+                                 + std::to_string(entry.first->second));
+                        }
+                        if (HandEvaluator::category(rank) != category) {
+                            fail(handName(cards) + " in category " + std::to_string(static_cast<int>(HandEvaluator::category(rank)))
+                                 + ", should be " + std::to_string(static_cast<int>(category)));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (rankOfKey.size() != HandTables::NumHandRanks) {
+        fail(std::to_string(rankOfKey.size()) + " distinct hands, should be " + std::to_string(HandTables::NumHandRanks));
+    }
+    std::uint16_t expected = 1;
+    for (auto entry = rankOfKey.rbegin(); entry != rankOfKey.rend(); ++entry, ++expected) {
+        if (entry->second != expected) {
+            fail("the hand ranked " + std::to_string(entry->second) + " should be " + std::to_string(expected));
+        }
+    }
+
+    std::cout << "HandEvaluator checked on all " << hands << " hands against a naive ranker: "
+              << rankOfKey.size() << " distinct ranks\n";
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << " (" << failures << " mismatches)\n";
+    return failures == 0;
+}
+
+void printReport(const Options& options, const ThreadStats& total, double seconds) {
+    double hands = static_cast<double>(total.hands);
+    double rounds = static_cast<double>(total.rounds);
+    double meanWin = total.won / rounds;
+    double varianceWin = total.wonSquared / rounds - meanWin * meanWin;
+    // Per credit wagered, so results compare across bet sizes. The hands of
+    // a round share their held cards, so the error comes from whole rounds.
+    double roundBet = static_cast<double>(options.bet) * options.multi;
+    double rtp = meanWin / roundBet;
+    double deviation = std::sqrt(varianceWin) / roundBet;
+    double standardError = deviation / std::sqrt(rounds);
+
+    std::cout << std::fixed;
+    std::cout << "Game:              " << options.variant->title << "\n";
+    std::cout << "Hands played:      " << total.hands << " on " << options.threads << " threads in "
+              << std::setprecision(2) << seconds << " s ("
+              << std::setprecision(1) << hands / seconds / 1e6 << " M hands/s)\n";
+    std::cout << "Credits wagered:   " << total.wagered << "\n";
+    std::cout << "Credits won:       " << total.won << "\n";
+    std::cout << std::setprecision(4);
+    std::cout << "Return to player:  " << rtp * 100.0 << " %\n";
+    std::cout << "  95% interval:    " << (rtp - 1.96 * standardError) * 100.0 << " % .. "
+              << (rtp + 1.96 * standardError) * 100.0 << " %\n";
+    std::cout << "  99% interval:    " << (rtp - 2.576 * standardError) * 100.0 << " % .. "
+              << (rtp + 2.576 * standardError) * 100.0 << " %\n";
+    std::cout << (options.multi == 1 ? "Variance per hand: " : "Variance per round: ") << deviation * deviation << " (std dev " << deviation << ")\n\n";
+
+    std::cout << std::left << std::setw(18) << "Prize" << std::right << std::setw(8) << "Pays"
+              << std::setw(14) << "Frequency" << std::setw(16) << "One in" << std::setw(12) << "RTP share\n";
+    const VariantRules& rules = options.variant->rules;
+    for (int ladderRow = rules.ladderRows - 1; ladderRow >= -1; --ladderRow) {
+        Prize prize = ladderRow < 0 ? Prize::None : rules.ladder[ladderRow];
+        int row = static_cast<int>(prize);
+        double frequency = total.hits[row] / hands;
+        double share = frequency * options.paytable.payout(prize, options.bet) / options.bet;
+        std::cout << std::left << std::setw(18) << (row == 0 ? "nothing" : PrizeTable::name(prize)) << std::right
+                  << std::setw(8) << options.paytable.payout(prize, options.bet)
+                  << std::setw(13) << std::setprecision(6) << frequency * 100.0 << "%"
+                  << std::setw(16) << std::setprecision(1) << (total.hits[row] ? 1.0 / frequency : 0.0)
+                  << std::setw(11) << std::setprecision(4) << share * 100.0 << "%\n";
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "[Error] " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (options.bench) {
+        runBenchmark();
+        return 0;
+    }
+    if (options.shuffleTest > 0) {
+        runShuffleTest(options);
+        return 0;
+    }
+    if (options.verifyEvaluator) {
+        return runEvaluatorCheck() ? 0 : 1;
+    }
+
+    // The optimal strategy splits --threads between the threads playing
+    // hands and the pool solving their holds, so the two never ask for
+    // more cores than were given
+    unsigned simThreads = options.threads;
+    std::unique_ptr<WorkStealingPool> pool;
+    if (options.strategy == Strategy::Optimal) {
+        simThreads = std::max(1u, options.threads / 2);
+        pool = std::make_unique<WorkStealingPool>(std::max(1u, options.threads - simThreads));
+    }
+
+    std::vector<ThreadStats> stats(simThreads);
+    std::vector<std::unique_ptr<HoldAdvisor>> advisors(simThreads);
+    std::vector<std::thread> threads;
+    std::atomic<std::uint64_t> progress(0);
+    std::atomic<bool> finished(false);
+
+    // Whole rounds, enough of them for at least --hands hands
+    std::uint64_t rounds = (options.hands + options.multi - 1) / options.multi;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < simThreads; ++t) {
+        std::uint64_t share = rounds / simThreads + (t < rounds % simThreads ? 1 : 0);
+        if (pool) {
+            advisors[t] = std::make_unique<HoldAdvisor>(*pool, *options.variant, options.paytable);
+        }
+        threads.emplace_back(simulate, std::cref(options), share, t, advisors[t].get(),
+                             std::ref(stats[t]), std::ref(progress));
+    }
+
+    std::thread reporter([&]() {
+        auto lastReport = std::chrono::steady_clock::now();
+        while (!finished) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            if (std::chrono::steady_clock::now() - lastReport > std::chrono::seconds(5)) {
+                lastReport = std::chrono::steady_clock::now();
+                std::cerr << "  " << progress.load(std::memory_order_relaxed) << " / " << options.hands << " hands\n";
+            }
+        }
+    });
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    finished = true;
+    reporter.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ThreadStats total;
+    for (const ThreadStats& s : stats) {
+        total.rounds += s.rounds;
+        total.hands += s.hands;
+        total.wagered += s.wagered;
+        total.won += s.won;
+        total.wonSquared += s.wonSquared;
+        for (int row = 0; row < NumPrizes; ++row) {
+            total.hits[row] += s.hits[row];
+        }
+    }
+
+    printReport(options, total, seconds);
+    return 0;
+}